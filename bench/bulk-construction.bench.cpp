@@ -0,0 +1,70 @@
+#include "utils/bench-utils.h"
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <utility>
+#include <vector>
+
+int main(int argc, char** argv)
+{
+    const std::size_t size = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 2'000'000;
+
+    // random parents with smaller indices, so the table is a valid tree in no particular child order
+    std::mt19937 rng(42);
+    std::vector<std::size_t> parents(size, general_tree<std::uint64_t>::no_index);
+    std::vector<std::pair<std::size_t, std::size_t>> edges;
+    edges.reserve(size);
+    for (std::size_t i = 1; i < size; i++)
+    {
+        parents[i] = std::uniform_int_distribution<std::size_t>(i / 2, i - 1)(rng);
+        edges.emplace_back(parents[i], i);
+    }
+    std::vector<std::uint64_t> values(size);
+    for (std::size_t i = 0; i < size; i++)
+        values[i] = i;
+
+    std::printf("%zu nodes\n", size);
+    std::printf("%-36s %12s %16s\n", "operation", "time (s)", "nodes/s");
+    const auto report = [&](const char* name, double seconds) {
+        std::printf("%-36s %12.4f %16.0f\n", name, seconds, size / seconds);
+    };
+
+    std::size_t sink = 0;
+
+    // the baseline: one insertion per row, appending after the last child found by walking the siblings
+    report("insert_left_child / child(n - 1)", measure_seconds([&] {
+               general_tree<std::uint64_t> tree(values[0]);
+               std::vector<general_tree<std::uint64_t>::node> nodes = {tree.root()};
+               std::vector<std::size_t> child_count(size, 0);
+               nodes.reserve(size);
+               for (std::size_t i = 1; i < size; i++)
+               {
+                   const auto parent = nodes[parents[i]];
+                   const std::size_t count = child_count[parents[i]]++;
+                   nodes.push_back(
+                       count == 0 ? tree.insert_left_child(parent, values[i])
+                                  : tree.insert_right_sibling(parent.child(count - 1), values[i])
+                   );
+               }
+               sink += tree.size();
+           }));
+
+    report("from_parent_array", measure_seconds([&] {
+               sink += general_tree<std::uint64_t>::from_parent_array(values, parents).size();
+           }));
+    report("from_edges", measure_seconds([&] {
+               sink += general_tree<std::uint64_t>::from_edges(values, edges).size();
+           }));
+
+    for (std::size_t threads : thread_counts())
+    {
+        char name[64];
+        std::snprintf(name, sizeof(name), "from_parent_array, %zu threads", threads);
+        report(name, measure_seconds([&] {
+                   sink += general_tree<std::uint64_t>::from_parent_array(values, parents, {threads}).size();
+               }));
+    }
+
+    return sink == 0 ? 1 : 0;
+}
@@ -0,0 +1,60 @@
+#include "utils/bench-utils.h"
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+using concurrent_tree = general_tree<std::uint64_t>::concurrent_tree;
+
+// alternates an insertion and a deletion under a node picked among the first ones
+static void write_once(concurrent_tree& ct, general_tree<std::uint64_t>::node target, std::size_t i)
+{
+    if (i % 2 == 0)
+        ct.emplace_left_child(target, i);
+    else
+        ct.delete_left_child(target);
+}
+
+int main(int argc, char** argv)
+{
+    const std::size_t size = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 2'000'000;
+    const std::string path = (std::filesystem::temp_directory_path() / "general-tree-bench.checkpoint").string();
+
+    const auto source = build_wide_tree(size);
+    concurrent_tree ct{general_tree<std::uint64_t>(source)};
+    const auto target = ct.read().root().left_child();
+    std::printf("%zu nodes\n", size);
+    std::printf("%-36s %12s %16s\n", "phase", "time (s)", "writes/s");
+
+    const std::size_t baseline_writes = 1'000'000;
+    const double baseline_time = measure_seconds([&] {
+        for (std::size_t i = 0; i < baseline_writes; i++)
+            write_once(ct, target, i);
+    });
+    std::printf("%-36s %12.4f %16.0f\n", "writes without checkpoint", baseline_time, baseline_writes / baseline_time);
+
+    // writers keep going until the background checkpoint is complete
+    std::size_t writes = 0;
+    const double checkpoint_time = measure_seconds([&] {
+        ct.checkpoint_async(path);
+        while (ct.checkpoint_running())
+            write_once(ct, target, writes++);
+        ct.wait_for_checkpoint();
+    });
+    std::printf("%-36s %12.4f %16.0f\n", "writes during checkpoint_async", checkpoint_time, writes / checkpoint_time);
+
+    // stop-the-world alternative: writers wait for a deep copy of the same tree, which is then saved
+    general_tree<std::uint64_t> copy;
+    const double pause_time = measure_seconds([&] { copy = source; });
+    const double save_time = measure_seconds([&] {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        copy.save(file);
+    });
+    std::printf("%-36s %12.4f %16s\n", "deep copy (writers paused)", pause_time, "0");
+    std::printf("%-36s %12.4f %16s\n", "save of the copy", save_time, "-");
+
+    std::filesystem::remove(path);
+    return 0;
+}
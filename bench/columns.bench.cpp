@@ -0,0 +1,53 @@
+#include "utils/bench-utils.h"
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <vector>
+
+int main(int argc, char** argv)
+{
+    const std::size_t size = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 2'000'000;
+    const auto tree = build_random_tree(size);
+
+    std::vector<std::size_t> parent_index(size);
+    std::vector<std::size_t> depth(size);
+    std::vector<std::size_t> subtree_size(size);
+    std::vector<std::size_t> first_child(size);
+    std::vector<std::uint64_t> values(size);
+
+    std::printf("%zu nodes\n", size);
+    std::printf("%-36s %12s %16s\n", "operation", "time (s)", "nodes/s");
+    const auto report = [&](const char* name, double seconds) {
+        std::printf("%-36s %12.4f %16.0f\n", name, seconds, size / seconds);
+    };
+
+    report("export_columns (all columns)", measure_seconds([&] {
+               tree.export_columns({parent_index, depth, subtree_size, first_child, values});
+           }));
+
+    // same aggregate, once chasing pointers and once over the columns
+    std::uint64_t sink = 0;
+    report("sum of values, preorder iterator", measure_seconds([&] {
+               for (std::uint64_t value : tree)
+                   sink += value;
+           }));
+    report("sum of values, columns", measure_seconds([&] {
+               for (std::size_t i = 0; i < size; i++)
+                   sink += values[i];
+           }));
+
+    report("import_columns", measure_seconds([&] {
+               auto imported = general_tree<std::uint64_t>::import_columns(parent_index, values);
+               sink += imported.size();
+           }));
+
+    std::stringstream binary;
+    tree.save(binary);
+    report("load (binary stream in memory)", measure_seconds([&] {
+               auto loaded = general_tree<std::uint64_t>::load(binary);
+               sink += loaded.size();
+           }));
+
+    return sink == 0 ? 1 : 0;
+}
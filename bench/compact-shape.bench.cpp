@@ -0,0 +1,60 @@
+#include "utils/bench-utils.h"
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+
+using tree_type = general_tree<std::uint32_t>;
+
+// stores no value, so the stream holds the shape alone
+struct shape_only_codec
+{
+    void encode(tree_type::binary_writer&, std::uint32_t) const {}
+
+    std::uint32_t decode(tree_type::binary_reader&) const
+    {
+        return 0;
+    }
+};
+
+template <typename Codec, typename Save>
+static void report(const char* name, const tree_type& tree, Codec codec, Save save)
+{
+    std::stringstream stream;
+    save(stream, codec);
+    const std::string bytes = stream.str();
+
+    std::size_t loaded_size = 0;
+    const double seconds = measure_seconds([&] {
+        std::stringstream input(bytes);
+        loaded_size = tree_type::load(input, codec).size();
+    });
+    std::printf(
+        "%-36s %12.3f %12.4f %16.0f\n", name, static_cast<double>(bytes.size()) / tree.size(), seconds,
+        loaded_size / seconds
+    );
+}
+
+static void run(const char* shape, const tree_type& tree)
+{
+    std::printf("\n%s, %zu nodes\n", shape, tree.size());
+    std::printf("%-36s %12s %12s %16s\n", "format", "bytes/node", "load (s)", "nodes/s");
+
+    const auto naive = [&](std::ostream& stream, auto codec) { tree.save(stream, codec); };
+    const auto compact = [&](std::ostream& stream, auto codec) { tree.save_compact(stream, codec); };
+    report("child counts, shape only", tree, shape_only_codec(), naive);
+    report("compact, shape only", tree, shape_only_codec(), compact);
+    report("child counts, uint32 values", tree, tree_type::default_codec(), naive);
+    report("compact, uint32 values", tree, tree_type::default_codec(), compact);
+}
+
+int main(int argc, char** argv)
+{
+    const std::size_t size = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 2'000'000;
+    run("wide (fan-out 4)", build_wide_tree<std::uint32_t>(size, 4));
+    run("wide (fan-out 200)", build_wide_tree<std::uint32_t>(size, 200));
+    run("deep (1 leaf per spine node)", build_deep_tree<std::uint32_t>(size, 1));
+    run("random", build_random_tree<std::uint32_t>(size));
+    return 0;
+}
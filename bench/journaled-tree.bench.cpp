@@ -0,0 +1,70 @@
+#include "utils/bench-utils.h"
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+
+using journaled_tree = general_tree<std::uint64_t>::journaled_tree<>;
+
+int main(int argc, char** argv)
+{
+    const std::size_t operations = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1'000'000;
+    const auto directory = std::filesystem::temp_directory_path();
+    const std::string checkpoint_path = (directory / "general-tree-bench.checkpoint").string();
+    const std::string log_path = (directory / "general-tree-bench.log").string();
+    std::filesystem::remove(checkpoint_path);
+    std::filesystem::remove(log_path);
+
+    // insertions under random recent nodes; every 16 operations the newest node, a leaf, is deleted instead
+    std::size_t expected_size = 0;
+    const double append_time = measure_seconds([&] {
+        journaled_tree jt(checkpoint_path, log_path);
+        std::mt19937 rng(42);
+        std::vector<general_tree<std::uint64_t>::node> nodes = {jt.emplace_root(0)};
+        for (std::size_t i = 1; i < operations; i++)
+        {
+            if (i % 16 == 0 && nodes.size() > 1)
+            {
+                jt.delete_left_child(nodes.back().parent());
+                nodes.pop_back();
+                continue;
+            }
+
+            std::uniform_int_distribution<std::size_t> pick(nodes.size() / 2, nodes.size() - 1);
+            nodes.push_back(jt.emplace_left_child(nodes[pick(rng)], i));
+        }
+        jt.sync();
+        expected_size = jt.size();
+    });
+
+    const double log_mb = std::filesystem::file_size(log_path) / 1e6;
+    std::printf("%zu operations, log %.1f MB (%.1f bytes/record)\n", operations, log_mb, log_mb * 1e6 / operations);
+    std::printf("%-34s %12s %16s\n", "phase", "time (s)", "records/s");
+    std::printf("%-34s %12.4f %16.0f\n", "append", append_time, operations / append_time);
+
+    std::size_t recovered_size = 0;
+    const double replay_time = measure_seconds([&] {
+        journaled_tree jt(checkpoint_path, log_path);
+        recovered_size = jt.size();
+    });
+    std::printf("%-34s %12.4f %16.0f\n", "recovery (log replay)", replay_time, operations / replay_time);
+
+    const double checkpoint_time = measure_seconds([&] {
+        journaled_tree jt(checkpoint_path, log_path);
+        jt.checkpoint();
+    });
+    std::printf("%-34s %12.4f %16s\n", "recovery + checkpoint", checkpoint_time, "-");
+
+    const double load_time = measure_seconds([&] {
+        journaled_tree jt(checkpoint_path, log_path);
+        recovered_size += jt.size();
+    });
+    std::printf("%-34s %12.4f %16s\n", "recovery (checkpoint only)", load_time, "-");
+
+    std::filesystem::remove(checkpoint_path);
+    std::filesystem::remove(log_path);
+    return recovered_size == 2 * expected_size ? 0 : 1;
+}
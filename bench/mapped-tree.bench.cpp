@@ -0,0 +1,64 @@
+#include "general-tree-mapped.h"
+#include "utils/bench-utils.h"
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+int main(int argc, char** argv)
+{
+    const std::size_t size = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 2'000'000;
+    const auto directory = std::filesystem::temp_directory_path();
+    const std::string binary_path = (directory / "general-tree-bench.bin").string();
+    const std::string mapped_path = (directory / "general-tree-bench.mapped").string();
+
+    {
+        auto tree = build_wide_tree(size);
+        std::ofstream binary(binary_path, std::ios::binary | std::ios::trunc);
+        tree.save(binary);
+        mapped_tree<std::uint64_t>::write(tree, mapped_path);
+    }
+
+    std::printf("%zu nodes, binary %.1f MB, mapped %.1f MB\n", size,
+                std::filesystem::file_size(binary_path) / 1e6, std::filesystem::file_size(mapped_path) / 1e6);
+    std::printf("%-32s %12s\n", "operation", "time (s)");
+
+    std::uint64_t sink = 0;
+    const double load_time = measure_seconds([&] {
+        std::ifstream binary(binary_path, std::ios::binary);
+        auto tree = general_tree<std::uint64_t>::load(binary);
+        sink += tree.size();
+    });
+    std::printf("%-32s %12.6f\n", "load (full deserialization)", load_time);
+
+    const double open_time = measure_seconds([&] {
+        mapped_tree<std::uint64_t> mapped(mapped_path);
+        sink += mapped.size();
+    });
+    std::printf("%-32s %12.6f\n", "mapped open", open_time);
+
+    // navigating the whole tree touches every page once
+    const double walk_time = measure_seconds([&] {
+        mapped_tree<std::uint64_t> mapped(mapped_path);
+        auto current = mapped.root();
+        while (!current.is_null())
+        {
+            sink += current.data();
+            if (current.has_left_child())
+            {
+                current = current.left_child();
+                continue;
+            }
+            while (!current.is_root() && !current.has_right_sibling())
+                current = current.parent();
+            current = current.is_root() ? mapped_tree<std::uint64_t>::node() : current.right_sibling();
+        }
+    });
+    std::printf("%-32s %12.6f\n", "mapped open + full walk", walk_time);
+
+    std::filesystem::remove(binary_path);
+    std::filesystem::remove(mapped_path);
+    return sink == 0 ? 1 : 0;
+}
@@ -0,0 +1,56 @@
+#include "utils/bench-utils.h"
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+// CPU-heavy per-node work, similar to hashing or validation
+static std::uint64_t work(std::uint64_t value)
+{
+    for (int i = 0; i < 200; i++)
+        value = value * 6364136223846793005ULL + 1442695040888963407ULL;
+    return value;
+}
+
+template <typename Tree>
+static void run_scaling(const char* name, const Tree& tree)
+{
+    std::printf("%s (%zu nodes)\n", name, tree.root().descendants_count() + 1);
+    std::printf("%8s %14s %14s %10s\n", "threads", "for_each (s)", "reduce (s)", "speedup");
+
+    double baseline = 0;
+    for (std::size_t threads : thread_counts())
+    {
+        std::atomic<std::uint64_t> sink = 0;
+        const double for_each_time = measure_seconds([&] {
+            tree.parallel_for_each(tree.root(), [&](auto n) { sink.fetch_xor(work(n.data()), std::memory_order_relaxed); }, threads);
+        });
+
+        std::uint64_t reduced = 0;
+        const double reduce_time = measure_seconds([&] {
+            reduced = tree.parallel_reduce(
+                tree.root(), std::uint64_t(0), [](auto n) { return work(n.data()); },
+                [](std::uint64_t a, std::uint64_t b) { return a ^ b; }, threads
+            );
+        });
+
+        if (threads == 1)
+            baseline = for_each_time;
+
+        std::printf("%8zu %14.4f %14.4f %9.2fx\n", threads, for_each_time, reduce_time, baseline / for_each_time);
+        if (reduced != sink.load())
+            std::printf("  mismatch between for_each and reduce results\n");
+    }
+    std::printf("\n");
+}
+
+int main(int argc, char** argv)
+{
+    const std::size_t size = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 2'000'000;
+
+    run_scaling("wide tree", build_wide_tree(size));
+    run_scaling("deep tree", build_deep_tree(size));
+    run_scaling("random tree", build_random_tree(size));
+    return 0;
+}
@@ -0,0 +1,58 @@
+#include "utils/bench-utils.h"
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+// CPU-heavy per-node work, similar to propagating and validating a value
+static std::uint64_t work(std::uint64_t value)
+{
+    for (int i = 0; i < 200; i++)
+        value = value * 6364136223846793005ULL + 1442695040888963407ULL;
+    return value;
+}
+
+template <typename Tree>
+static void run_scaling(const char* name, Tree& tree)
+{
+    std::printf("%s (%zu nodes)\n", name, tree.root().descendants_count() + 1);
+    std::printf("%8s %16s %14s %10s\n", "threads", "level_order (s)", "for_each (s)", "speedup");
+
+    double baseline = 0;
+    for (std::size_t threads : thread_counts())
+    {
+        // every node combines the value of its parent, so the order between levels matters
+        const double level_time = measure_seconds([&] {
+            tree.parallel_level_order(
+                tree.root(),
+                [](auto n) {
+                    if (!n.is_root())
+                        n.data() = work(n.parent().data());
+                },
+                threads
+            );
+        });
+
+        std::atomic<std::uint64_t> sink = 0;
+        const double for_each_time = measure_seconds([&] {
+            tree.parallel_for_each(tree.root(), [&](auto n) { sink.fetch_xor(work(n.data()), std::memory_order_relaxed); }, threads);
+        });
+
+        if (threads == 1)
+            baseline = level_time;
+
+        std::printf("%8zu %16.4f %14.4f %9.2fx\n", threads, level_time, for_each_time, baseline / level_time);
+    }
+    std::printf("\n");
+}
+
+int main(int argc, char** argv)
+{
+    const std::size_t size = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 2'000'000;
+
+    auto wide = build_wide_tree(size);
+    run_scaling("wide tree", wide);
+    auto deep = build_deep_tree(size);
+    run_scaling("deep tree", deep);
+    return 0;
+}
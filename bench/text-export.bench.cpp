@@ -0,0 +1,84 @@
+#include "utils/bench-utils.h"
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <ostream>
+#include <streambuf>
+#include <string>
+
+// discards the output and counts its bytes
+class counting_buffer : public std::streambuf
+{
+public:
+    std::size_t m_count = 0;
+
+protected:
+    int_type overflow(int_type c) override
+    {
+        ++m_count;
+        return traits_type::not_eof(c);
+    }
+
+    std::streamsize xsputn(const char*, std::streamsize count) override
+    {
+        m_count += static_cast<std::size_t>(count);
+        return count;
+    }
+};
+
+template <typename Write>
+static void report(const char* name, Write write)
+{
+    counting_buffer buffer;
+    std::ostream stream(&buffer);
+    const double seconds = measure_seconds([&] { write(stream); });
+    std::printf("%-34s %12.1f %12.4f %12.1f\n", name, buffer.m_count / 1e6, seconds, buffer.m_count / 1e6 / seconds);
+}
+
+template <typename Tree>
+static void run(const char* name, const Tree& tree)
+{
+    std::printf("%s (%zu nodes)\n", name, tree.size());
+    std::printf("%-34s %12s %12s %12s\n", "exporter", "MB", "time (s)", "MB/s");
+
+    report("write_ascii", [&](std::ostream& stream) { tree.write_ascii(stream); });
+    report("write_dot", [&](std::ostream& stream) { tree.write_dot(stream); });
+
+    // baseline: the same drawing through formatted stream insertion, keeping the prefix in a string
+    report("ostream << (same drawing)", [&](std::ostream& stream) {
+        std::string prefix;
+        auto current = tree.root();
+        stream << current.data() << '\n';
+        if (current.is_leaf())
+            return;
+        current = current.left_child();
+        while (!current.is_root())
+        {
+            stream << prefix << (current.has_right_sibling() ? "\xe2\x94\x9c\xe2\x94\x80\xe2\x94\x80 " : "\xe2\x94\x94\xe2\x94\x80\xe2\x94\x80 ")
+                   << current.data() << '\n';
+            if (!current.is_leaf())
+            {
+                prefix += current.has_right_sibling() ? "\xe2\x94\x82   " : "    ";
+                current = current.left_child();
+                continue;
+            }
+            while (!current.is_root() && !current.has_right_sibling())
+            {
+                current = current.parent();
+                if (!current.is_root())
+                    prefix.resize(prefix.size() - (current.has_right_sibling() ? 6 : 4));
+            }
+            if (!current.is_root())
+                current = current.right_sibling();
+        }
+    });
+    std::printf("\n");
+}
+
+int main(int argc, char** argv)
+{
+    const std::size_t size = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1'000'000;
+    run("wide tree", build_wide_tree(size));
+    run("random tree", build_random_tree(size));
+    return 0;
+}
@@ -0,0 +1,79 @@
+#include "utils/bench-utils.h"
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+using tree_type = general_tree<std::uint64_t>;
+
+// - changes the value of `edits` random nodes and adds as many leaves
+static tree_type edited_copy(const tree_type& tree, std::size_t edits)
+{
+    tree_type copy(tree);
+    std::vector<tree_type::node> nodes = {copy.root()};
+    for (std::size_t i = 0; i < nodes.size(); i++)
+    {
+        for (auto child : tree_type::children(nodes[i]))
+            nodes.push_back(child);
+    }
+
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<std::size_t> pick(0, nodes.size() - 1);
+    for (std::size_t i = 0; i < edits; i++)
+    {
+        nodes[pick(rng)].data() += 1;
+        copy.insert_left_child(nodes[pick(rng)], i);
+    }
+    return copy;
+}
+
+// - root with `fanout` leaf children, the first `changed` of them with a new value
+static tree_type wide_tree(std::size_t fanout, std::size_t changed)
+{
+    tree_type tree(0);
+    tree_type::node last;
+    for (std::size_t i = 0; i < fanout; i++)
+    {
+        const std::uint64_t value = i < changed ? fanout + i : i;
+        last = last.is_null() ? tree.insert_left_child(tree.root(), value) : tree.insert_right_sibling(last, value);
+    }
+    return tree;
+}
+
+static void report(const char* label, std::size_t edits, const tree_type& tree, const tree_type& target)
+{
+    tree_type::edit_script script;
+    const double diff_seconds = measure_seconds([&] { script = tree_type::diff(tree, target); });
+
+    tree_type patched(tree);
+    const double apply_seconds = measure_seconds([&] { patched.apply(script); });
+    const double copy_seconds = measure_seconds([&] { tree_type copy(target); });
+    if (!(patched == target))
+        std::exit(1);
+
+    std::printf(
+        "%-20s %10zu %12zu %12.4f %12.6f %12.4f\n", label, edits, script.size(), diff_seconds, apply_seconds,
+        copy_seconds
+    );
+}
+
+int main(int argc, char** argv)
+{
+    const std::size_t size = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1'000'000;
+    const tree_type tree = build_random_tree(size);
+
+    std::printf("%zu nodes\n", size);
+    std::printf(
+        "%-20s %10s %12s %12s %12s %12s\n", "tree", "edits", "operations", "diff (s)", "apply (s)", "copy (s)"
+    );
+    for (std::size_t edits : {1, 10, 100, 1000, 10000})
+        report("random", edits, tree, edited_copy(tree, edits));
+
+    // a single sibling list: the children are paired by value through a hash, never by scanning the list
+    const tree_type wide = wide_tree(size, 0);
+    for (std::size_t changed : {std::size_t(1), size / 100, size / 10, size})
+        report("wide (one parent)", changed, wide, wide_tree(size, changed));
+
+    return 0;
+}
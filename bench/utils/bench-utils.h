@@ -0,0 +1,103 @@
+#pragma once
+#include "general-tree.h"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <thread>
+#include <vector>
+
+// Wide tree: every node gets up to `fanout` children, level by level (like seed_tree in the tests)
+template <typename T = std::uint64_t>
+general_tree<T> build_wide_tree(std::size_t size, std::size_t fanout = 4)
+{
+    general_tree<T> tree;
+    if (size == 0)
+        return tree;
+
+    std::size_t counter = 0;
+    tree.emplace_root(T(counter++));
+    std::vector<typename general_tree<T>::node> parents = {tree.root()};
+
+    while (counter < size)
+    {
+        std::vector<typename general_tree<T>::node> next_parents;
+        for (auto parent : parents)
+        {
+            typename general_tree<T>::node last;
+            for (std::size_t i = 0; i < fanout && counter < size; i++)
+            {
+                last = last.is_null() ? tree.emplace_left_child(parent, T(counter++))
+                                      : tree.emplace_right_sibling(last, T(counter++));
+                next_parents.push_back(last);
+            }
+        }
+        parents.swap(next_parents);
+    }
+
+    return tree;
+}
+
+// Deep tree: a long spine where every spine node also has `leaves` leaf children
+template <typename T = std::uint64_t>
+general_tree<T> build_deep_tree(std::size_t size, std::size_t leaves = 1)
+{
+    general_tree<T> tree;
+    if (size == 0)
+        return tree;
+
+    std::size_t counter = 0;
+    auto spine = tree.emplace_root(T(counter++));
+    while (counter < size)
+    {
+        auto next = tree.emplace_left_child(spine, T(counter++));
+        for (std::size_t i = 0; i < leaves && counter < size; i++)
+            tree.emplace_right_sibling(next, T(counter++));
+        spine = next;
+    }
+
+    return tree;
+}
+
+// Unbalanced tree: children counts drawn at random, so subtree sizes differ a lot
+template <typename T = std::uint64_t>
+general_tree<T> build_random_tree(std::size_t size, std::uint32_t seed = 42)
+{
+    general_tree<T> tree;
+    if (size == 0)
+        return tree;
+
+    std::mt19937 rng(seed);
+    std::size_t counter = 0;
+    std::vector<typename general_tree<T>::node> nodes = {tree.emplace_root(T(counter++))};
+    nodes.reserve(size);
+
+    while (counter < size)
+    {
+        // biased towards recent nodes to create deep, uneven branches
+        std::uniform_int_distribution<std::size_t> pick(nodes.size() / 2, nodes.size() - 1);
+        nodes.push_back(tree.emplace_left_child(nodes[pick(rng)], T(counter++)));
+    }
+
+    return tree;
+}
+
+// 1, 2, 4, ... up to the number of hardware threads (always included)
+inline std::vector<std::size_t> thread_counts()
+{
+    const std::size_t max_threads = std::thread::hardware_concurrency() == 0 ? 1 : std::thread::hardware_concurrency();
+    std::vector<std::size_t> counts;
+    for (std::size_t threads = 1; threads < max_threads; threads *= 2)
+        counts.push_back(threads);
+    counts.push_back(max_threads);
+    return counts;
+}
+
+template <typename Function>
+double measure_seconds(Function&& fn)
+{
+    const auto start = std::chrono::steady_clock::now();
+    fn();
+    const auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end - start).count();
+}
@@ -0,0 +1,525 @@
+#pragma once
+
+#include "general-tree.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @brief Read-only tree backed by a memory-mapped file.
+ * @details The file stores the nodes in preorder as three contiguous columns: the index of the parent, the size of
+ * the subtree and the value. Opening a file only maps it and validates its header, so it costs O(1) whatever the
+ * size of the tree; pages are loaded by the operating system when they are first touched. Every navigation step is
+ * O(1): the first child of node i is i + 1 and its right sibling is i + subtree_size(i). Every step also checks, in
+ * O(1), the column entries it relies on: the parent of node i must come before it and its subtree must end within
+ * the tree. A corrupted column then makes navigation throw std::runtime_error rather than read outside the mapping
+ * or loop. Values are stored as raw bytes in host byte order, so T must be trivially copyable and files are only
+ * portable between machines with the same byte order and type layout.
+ */
+template <typename T>
+class mapped_tree
+{
+    static_assert(std::is_trivially_copyable_v<T>, "mapped_tree requires a trivially copyable value type");
+
+private:
+    static constexpr std::uint64_t no_index = ~std::uint64_t(0);
+    static constexpr std::uint32_t file_version = 1;
+    static constexpr std::uint32_t byte_order_mark = 0x01020304;
+    static constexpr char file_magic[4] = {'G', 'T', 'R', 'M'};
+
+    struct file_header
+    {
+        char m_magic[4];
+        std::uint32_t m_version;
+        std::uint32_t m_byte_order;
+        std::uint32_t m_value_size;
+        std::uint64_t m_size;
+        std::uint64_t m_parents_offset;
+        std::uint64_t m_subtree_sizes_offset;
+        std::uint64_t m_values_offset;
+        std::uint64_t m_file_size;
+    };
+
+    const std::byte* m_base = nullptr;
+    std::size_t m_length = 0;
+    std::uint64_t m_size = 0;
+    const std::uint64_t* m_parents = nullptr;
+    const std::uint64_t* m_subtree_sizes = nullptr;
+    const T* m_values = nullptr;
+
+    static std::uint64_t align_up(std::uint64_t offset, std::uint64_t alignment) noexcept
+    {
+        return (offset + alignment - 1) / alignment * alignment;
+    }
+
+    // - computes the offsets of the columns of a tree of the given size
+    static file_header make_header(std::uint64_t size) noexcept
+    {
+        file_header header{};
+        std::memcpy(header.m_magic, file_magic, sizeof(file_magic));
+        header.m_version = file_version;
+        header.m_byte_order = byte_order_mark;
+        header.m_value_size = sizeof(T);
+        header.m_size = size;
+        header.m_parents_offset = align_up(sizeof(file_header), 64);
+        header.m_subtree_sizes_offset = header.m_parents_offset + size * sizeof(std::uint64_t);
+        header.m_values_offset = align_up(
+            header.m_subtree_sizes_offset + size * sizeof(std::uint64_t),
+            std::max<std::uint64_t>(alignof(T), alignof(std::uint64_t))
+        );
+        header.m_file_size = header.m_values_offset + size * sizeof(T);
+        return header;
+    }
+
+    static void write_padding(std::ostream& stream, std::uint64_t from, std::uint64_t to)
+    {
+        static constexpr char zeros[64] = {};
+        while (from < to)
+        {
+            const std::uint64_t chunk = std::min<std::uint64_t>(to - from, sizeof(zeros));
+            stream.write(zeros, static_cast<std::streamsize>(chunk));
+            from += chunk;
+        }
+    }
+
+    void map_file(const std::string& path)
+    {
+#if defined(_WIN32)
+        HANDLE file = CreateFileA(
+            path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr
+        );
+        if (file == INVALID_HANDLE_VALUE)
+            throw std::runtime_error("Cannot open " + path);
+
+        LARGE_INTEGER file_size;
+        if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart < static_cast<LONGLONG>(sizeof(file_header)))
+        {
+            CloseHandle(file);
+            throw std::runtime_error("Not a mapped_tree file: " + path);
+        }
+
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        CloseHandle(file);
+        if (mapping == nullptr)
+            throw std::runtime_error("Cannot map " + path);
+
+        // the view keeps the mapping alive
+        void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        CloseHandle(mapping);
+        if (view == nullptr)
+            throw std::runtime_error("Cannot map " + path);
+
+        m_base = static_cast<const std::byte*>(view);
+        m_length = static_cast<std::size_t>(file_size.QuadPart);
+#else
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            throw std::runtime_error("Cannot open " + path);
+
+        struct stat file_stat;
+        if (::fstat(fd, &file_stat) != 0 || file_stat.st_size < static_cast<off_t>(sizeof(file_header)))
+        {
+            ::close(fd);
+            throw std::runtime_error("Not a mapped_tree file: " + path);
+        }
+
+        // the mapping stays valid once the descriptor is closed
+        void* view = ::mmap(nullptr, static_cast<std::size_t>(file_stat.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (view == MAP_FAILED)
+            throw std::runtime_error("Cannot map " + path);
+
+        m_base = static_cast<const std::byte*>(view);
+        m_length = static_cast<std::size_t>(file_stat.st_size);
+#endif
+    }
+
+    // - the parent of node i, no_index for the root; every other node has a parent index below its own
+    // - throws std::runtime_error otherwise, which also rules out cycles and indices outside the column
+    std::uint64_t parent_of(std::uint64_t i) const
+    {
+        const std::uint64_t parent = m_parents[i];
+        if (parent == no_index ? i != 0 : parent >= i)
+            throw std::runtime_error("Corrupted mapped_tree file");
+        return parent;
+    }
+
+    // - the size of the subtree of node i, between 1 and the number of nodes from i to the end
+    // - throws std::runtime_error otherwise, so that sibling steps always move forward and stay in the tree
+    std::uint64_t subtree_size_of(std::uint64_t i) const
+    {
+        const std::uint64_t size = m_subtree_sizes[i];
+        if (size == 0 || size > m_size - i)
+            throw std::runtime_error("Corrupted mapped_tree file");
+        return size;
+    }
+
+    void unmap() noexcept
+    {
+        if (m_base == nullptr)
+            return;
+#if defined(_WIN32)
+        UnmapViewOfFile(m_base);
+#else
+        ::munmap(const_cast<std::byte*>(m_base), m_length);
+#endif
+        m_base = nullptr;
+    }
+
+public:
+    /**
+     * @brief Handle to a node of a mapped tree. Mirrors the navigation interface of general_tree::node.
+     */
+    class node
+    {
+    private:
+        friend class mapped_tree;
+
+        const mapped_tree* m_tree = nullptr;
+        std::uint64_t m_index = no_index;
+
+        node(const mapped_tree* tree, std::uint64_t index) noexcept : m_tree(tree), m_index(index) {}
+
+    public:
+        node() noexcept = default;
+
+        bool operator==(const node& other) const noexcept
+        {
+            return m_index == other.m_index && (m_index == no_index || m_tree == other.m_tree);
+        }
+
+        /**
+         * @brief Returns the position of the node in preorder.
+         */
+        [[nodiscard]] std::uint64_t index() const noexcept
+        {
+            return m_index;
+        }
+
+        /**
+         * @brief Retrieves the left child of the current node, or a null node if it has none.
+         * @throws std::runtime_error If the file is corrupted.
+         */
+        [[nodiscard]] node left_child() const
+        {
+            return has_left_child() ? node(m_tree, m_index + 1) : node();
+        }
+
+        /**
+         * @brief Retrieves the parent of the current node, or a null node if it is the root.
+         * @throws std::runtime_error If the file is corrupted.
+         */
+        [[nodiscard]] node parent() const
+        {
+            const std::uint64_t parent = m_tree->parent_of(m_index);
+            return parent == no_index ? node() : node(m_tree, parent);
+        }
+
+        /**
+         * @brief Retrieves the right sibling of the current node, or a null node if it has none.
+         * @throws std::runtime_error If the file is corrupted.
+         */
+        [[nodiscard]] node right_sibling() const
+        {
+            return has_right_sibling() ? node(m_tree, m_index + m_tree->subtree_size_of(m_index)) : node();
+        }
+
+        /**
+         * @brief Accesses the data stored in the node.
+         * @throws std::invalid_argument If the node is null.
+         */
+        [[nodiscard]] const T& data() const
+        {
+            if (m_index == no_index)
+                throw std::invalid_argument("Cannot get data from null node");
+            return m_tree->m_values[m_index];
+        }
+
+        /**
+         * @throws std::runtime_error If the file is corrupted.
+         */
+        bool is_root() const
+        {
+            return m_tree->parent_of(m_index) == no_index;
+        }
+
+        /**
+         * @throws std::runtime_error If the file is corrupted.
+         */
+        bool is_leaf() const
+        {
+            return m_tree->subtree_size_of(m_index) == 1;
+        }
+
+        /**
+         * @throws std::runtime_error If the file is corrupted.
+         */
+        bool has_left_child() const
+        {
+            return m_tree->subtree_size_of(m_index) > 1;
+        }
+
+        /**
+         * @throws std::runtime_error If the file is corrupted.
+         */
+        bool has_right_sibling() const
+        {
+            const std::uint64_t next = m_index + m_tree->subtree_size_of(m_index);
+            return !is_root() && next < m_tree->m_size && m_tree->parent_of(next) == m_tree->parent_of(m_index);
+        }
+
+        bool is_null() const noexcept
+        {
+            return m_index == no_index;
+        }
+
+        /**
+         * @brief Retrieves the child at the given index, or a null node if the index is out of range.
+         * @throws std::invalid_argument If the current node is null.
+         * @throws std::runtime_error If the file is corrupted.
+         */
+        [[nodiscard]] node child(std::size_t index) const
+        {
+            if (m_index == no_index)
+                throw std::invalid_argument("Cannot get child of null node");
+
+            node result = left_child();
+            for (std::size_t i = 0; i < index && !result.is_null(); i++)
+                result = result.right_sibling();
+            return result;
+        }
+
+        /**
+         * @brief Counts the children of the current node.
+         * @throws std::invalid_argument If the current node is null.
+         * @throws std::runtime_error If the file is corrupted.
+         */
+        [[nodiscard]] std::size_t children_count() const
+        {
+            if (m_index == no_index)
+                throw std::invalid_argument("Cannot count children of null node");
+
+            std::size_t count = 0;
+            for (node child = left_child(); !child.is_null(); child = child.right_sibling())
+                ++count;
+            return count;
+        }
+
+        /**
+         * @brief Computes the depth of the current node.
+         * @throws std::invalid_argument If the current node is null.
+         * @throws std::runtime_error If the file is corrupted.
+         */
+        [[nodiscard]] std::size_t depth() const
+        {
+            if (m_index == no_index)
+                throw std::invalid_argument("Cannot get depth of null node");
+
+            std::size_t depth = 0;
+            for (std::uint64_t i = m_tree->parent_of(m_index); i != no_index; i = m_tree->parent_of(i))
+                ++depth;
+            return depth;
+        }
+
+        /**
+         * @brief Returns the number of descendants of the current node, in O(1).
+         * @throws std::invalid_argument If the current node is null.
+         * @throws std::runtime_error If the file is corrupted.
+         */
+        [[nodiscard]] std::size_t descendants_count() const
+        {
+            if (m_index == no_index)
+                throw std::invalid_argument("Cannot get descendants count of null node");
+            return static_cast<std::size_t>(m_tree->subtree_size_of(m_index) - 1);
+        }
+    };
+
+    /**
+     * @brief Writes the tree in the mapped layout.
+     * @details The parent and subtree size columns are computed in one stackless preorder pass and the values are
+     * streamed in a second one.
+     * @throws std::runtime_error If the stream fails.
+     */
+    static void write(const general_tree<T>& tree, std::ostream& stream)
+    {
+        std::vector<std::uint64_t> parents;
+        std::vector<std::uint64_t> subtree_sizes;
+        parents.reserve(tree.size());
+        subtree_sizes.reserve(tree.size());
+
+        // indices of the nodes on the path from the root to the current node
+        std::vector<std::uint64_t> path;
+        auto current = tree.root();
+        while (!current.is_null())
+        {
+            const std::uint64_t index = parents.size();
+            parents.push_back(path.empty() ? no_index : path.back());
+            subtree_sizes.push_back(1);
+
+            if (current.has_left_child())
+            {
+                path.push_back(index);
+                current = current.left_child();
+                continue;
+            }
+
+            while (!current.is_root() && !current.has_right_sibling())
+            {
+                current = current.parent();
+                subtree_sizes[path.back()] = parents.size() - path.back();
+                path.pop_back();
+            }
+            current = current.is_root() ? typename general_tree<T>::node() : current.right_sibling();
+        }
+
+        const file_header header = make_header(parents.size());
+        stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        write_padding(stream, sizeof(header), header.m_parents_offset);
+        stream.write(
+            reinterpret_cast<const char*>(parents.data()),
+            static_cast<std::streamsize>(parents.size() * sizeof(std::uint64_t))
+        );
+        stream.write(
+            reinterpret_cast<const char*>(subtree_sizes.data()),
+            static_cast<std::streamsize>(subtree_sizes.size() * sizeof(std::uint64_t))
+        );
+        write_padding(stream, header.m_subtree_sizes_offset + parents.size() * sizeof(std::uint64_t), header.m_values_offset);
+
+        for (const T& value : tree)
+            stream.write(reinterpret_cast<const char*>(std::addressof(value)), sizeof(T));
+
+        if (!stream.flush())
+            throw std::runtime_error("Failed to write to stream");
+    }
+
+    /**
+     * @brief Writes the tree in the mapped layout to the file at the given path, replacing it.
+     * @throws std::runtime_error If the file cannot be written.
+     */
+    static void write(const general_tree<T>& tree, const std::string& path)
+    {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file)
+            throw std::runtime_error("Cannot open " + path);
+        write(tree, file);
+    }
+
+    /**
+     * @brief Maps the file at the given path. Only the header is read.
+     * @throws std::runtime_error If the file cannot be mapped, is not a mapped_tree file, or was written for another
+     * value type or byte order.
+     */
+    explicit mapped_tree(const std::string& path)
+    {
+        map_file(path);
+
+        file_header header;
+        std::memcpy(&header, m_base, sizeof(header));
+
+        // every node takes a parent index, a subtree size and a value, so a larger size cannot fit in the file (and
+        // could overflow the offsets computed by make_header)
+        const std::uint64_t max_size = (m_length - sizeof(file_header)) / (2 * sizeof(std::uint64_t) + sizeof(T));
+        bool valid = std::memcmp(header.m_magic, file_magic, sizeof(file_magic)) == 0 &&
+                     header.m_version == file_version && header.m_byte_order == byte_order_mark &&
+                     header.m_value_size == sizeof(T) && header.m_size <= max_size;
+        if (valid)
+        {
+            const file_header expected = make_header(header.m_size);
+            valid = header.m_parents_offset == expected.m_parents_offset &&
+                    header.m_subtree_sizes_offset == expected.m_subtree_sizes_offset &&
+                    header.m_values_offset == expected.m_values_offset &&
+                    header.m_file_size == expected.m_file_size && expected.m_file_size <= m_length;
+        }
+        if (!valid)
+        {
+            unmap();
+            throw std::runtime_error("Not a mapped_tree file for this value type: " + path);
+        }
+
+        m_size = header.m_size;
+        m_parents = reinterpret_cast<const std::uint64_t*>(m_base + header.m_parents_offset);
+        m_subtree_sizes = reinterpret_cast<const std::uint64_t*>(m_base + header.m_subtree_sizes_offset);
+        m_values = reinterpret_cast<const T*>(m_base + header.m_values_offset);
+    }
+
+    mapped_tree(mapped_tree&& other) noexcept
+        : m_base(std::exchange(other.m_base, nullptr)), m_length(std::exchange(other.m_length, 0)),
+          m_size(std::exchange(other.m_size, 0)), m_parents(other.m_parents), m_subtree_sizes(other.m_subtree_sizes),
+          m_values(other.m_values)
+    {
+    }
+
+    mapped_tree& operator=(mapped_tree&& other) noexcept
+    {
+        if (this != &other)
+        {
+            unmap();
+            m_base = std::exchange(other.m_base, nullptr);
+            m_length = std::exchange(other.m_length, 0);
+            m_size = std::exchange(other.m_size, 0);
+            m_parents = other.m_parents;
+            m_subtree_sizes = other.m_subtree_sizes;
+            m_values = other.m_values;
+        }
+        return *this;
+    }
+
+    mapped_tree(const mapped_tree&) = delete;
+    mapped_tree& operator=(const mapped_tree&) = delete;
+
+    ~mapped_tree()
+    {
+        unmap();
+    }
+
+    /**
+     * @brief Returns the root node, or a null node if the tree is empty.
+     */
+    [[nodiscard]] node root() const noexcept
+    {
+        return m_size == 0 ? node() : node(this, 0);
+    }
+
+    /**
+     * @brief Returns the number of nodes, in O(1).
+     */
+    [[nodiscard]] std::size_t size() const noexcept
+    {
+        return static_cast<std::size_t>(m_size);
+    }
+
+    bool empty() const noexcept
+    {
+        return m_size == 0;
+    }
+
+    /**
+     * @brief Returns the values of every node, in preorder, as a contiguous range.
+     */
+    [[nodiscard]] std::span<const T> values() const noexcept
+    {
+        return std::span<const T>(m_values, static_cast<std::size_t>(m_size));
+    }
+};
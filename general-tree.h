@@ -1,8 +1,42 @@
 ﻿#pragma once
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <barrier>
+#include <charconv>
+#include <chrono>
+#include <concepts>
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <istream>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <ostream>
 #include <queue>
+#include <ranges>
+#include <span>
+#include <sstream>
 #include <stdexcept>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
 #include <utility>
+#include <vector>
 
 template <typename T>
 class general_tree
@@ -17,6 +51,20 @@ public:
     };
 
 private:
+    // trees of other value types build isomorphic copies from the nodes of this one
+    template <typename>
+    friend class general_tree;
+
+    enum class view_type
+    {
+        children,
+        ancestors,
+        siblings,
+        leaves,
+        level,
+        bounded_preorder
+    };
+
     struct private_node
     {
         T m_data;
@@ -29,6 +77,151 @@ private:
             : m_right_sibling(nullptr), m_left_child(nullptr), m_parent(nullptr), m_data(std::forward<Args>(args)...)
         {
         }
+
+        static void* operator new(std::size_t)
+        {
+            return node_pool::allocate();
+        }
+
+        static void operator delete(void* ptr) noexcept
+        {
+            node_pool::deallocate(ptr);
+        }
+    };
+
+    // Memory of the nodes of every tree of this type. Nodes are carved from slabs and recycled through free lists:
+    // each thread allocates from and frees into its own list without locking, so the builders that create nodes from
+    // several threads do not contend. A list longer than two batches hands a batch over to a shared depot, where the
+    // threads that run out refill from before carving a new slab, so nodes freed on one thread (e.g. by the background
+    // reclaimer) are reused by the others. Slabs are never released: the memory of freed nodes goes to later nodes of
+    // the same type, not back to the system.
+    class node_pool
+    {
+    private:
+        struct free_node
+        {
+            free_node* m_next;
+        };
+
+        // first node of a batch in the depot
+        struct free_batch
+        {
+            free_node m_head;
+            free_batch* m_next_batch;
+            std::size_t m_count;
+        };
+
+        static_assert(sizeof(private_node) >= sizeof(free_batch));
+
+        static constexpr std::size_t batch_size = std::max<std::size_t>(16, 16384 / sizeof(private_node));
+
+        struct depot
+        {
+            std::mutex m_mutex;
+            free_batch* m_batches = nullptr;
+        };
+
+        struct thread_cache
+        {
+            free_node* m_head = nullptr;
+            std::size_t m_count = 0;
+            // set once the thread exits, later frees go straight to the depot
+            bool m_closed = false;
+        };
+
+        // hands the nodes of an exiting thread over to the depot
+        struct thread_cache_owner
+        {
+            thread_cache* m_cache;
+
+            ~thread_cache_owner()
+            {
+                give_back(m_cache->m_head, m_cache->m_count);
+                *m_cache = {nullptr, 0, true};
+            }
+        };
+
+        static depot& shared_depot() noexcept
+        {
+            // never destroyed, nodes of trees with static storage duration can be freed at any point of the exit
+            static depot* instance = new depot;
+            return *instance;
+        }
+
+        static thread_cache& local_cache() noexcept
+        {
+            // trivially destructible, so it can still be read after the owner ran
+            thread_local thread_cache cache;
+            thread_local thread_cache_owner owner{&cache};
+            return cache;
+        }
+
+        static void give_back(free_node* head, std::size_t count) noexcept
+        {
+            if (head == nullptr)
+                return;
+
+            free_node* next = head->m_next;
+            free_batch* batch = ::new (static_cast<void*>(head)) free_batch{{next}, nullptr, count};
+            depot& shared = shared_depot();
+            std::lock_guard<std::mutex> lock(shared.m_mutex);
+            batch->m_next_batch = std::exchange(shared.m_batches, batch);
+        }
+
+        static void refill(thread_cache& cache)
+        {
+            {
+                depot& shared = shared_depot();
+                std::lock_guard<std::mutex> lock(shared.m_mutex);
+                if (free_batch* batch = shared.m_batches)
+                {
+                    shared.m_batches = batch->m_next_batch;
+                    cache.m_count = batch->m_count;
+                    free_node* next = batch->m_head.m_next;
+                    cache.m_head = ::new (static_cast<void*>(batch)) free_node{next};
+                    return;
+                }
+            }
+
+            auto* slab = static_cast<std::byte*>(
+                ::operator new(batch_size * sizeof(private_node), std::align_val_t(alignof(private_node)))
+            );
+            for (std::size_t i = batch_size; i-- > 0;)
+                cache.m_head = ::new (static_cast<void*>(slab + i * sizeof(private_node))) free_node{cache.m_head};
+            cache.m_count = batch_size;
+        }
+
+    public:
+        static void* allocate()
+        {
+            thread_cache& cache = local_cache();
+            if (cache.m_head == nullptr)
+                refill(cache);
+
+            --cache.m_count;
+            return std::exchange(cache.m_head, cache.m_head->m_next);
+        }
+
+        static void deallocate(void* ptr) noexcept
+        {
+            thread_cache& cache = local_cache();
+            if (cache.m_closed)
+            {
+                give_back(::new (ptr) free_node{nullptr}, 1);
+                return;
+            }
+
+            cache.m_head = ::new (ptr) free_node{cache.m_head};
+            if (++cache.m_count < 2 * batch_size)
+                return;
+
+            // the nodes freed last are the likeliest to be in cache, the older half goes to the depot
+            free_node* last_kept = cache.m_head;
+            for (std::size_t i = 1; i < batch_size; i++)
+                last_kept = last_kept->m_next;
+            give_back(std::exchange(last_kept->m_next, nullptr), cache.m_count - batch_size);
+            cache.m_count = batch_size;
+        }
     };
 
     private_node* get_initial_node_for_iteration(iteration_type it_type) const
@@ -145,6 +338,7 @@ private:
     };
 
     private_node* m_root;
+    std::size_t m_size;
 
     // - handles null node
     // - sets the pointers to nullptr
@@ -168,12 +362,31 @@ private:
             aux->m_right_sibling = pnode->m_right_sibling;
         }
 
+        destroy_subtree(pnode);
+    }
+
+    // - handles null node
+    // - does not unlink the node from its parent or siblings
+    // - updates the size of the tree
+    void destroy_subtree(private_node* pnode)
+    {
+        m_size -= destroy_nodes(pnode);
+    }
+
+    // - handles null node
+    // - returns the number of deleted nodes
+    static std::size_t destroy_nodes(private_node* pnode)
+    {
+        if (pnode == nullptr)
+            return 0;
+
         // Breadth First Algorithm
         // Save the children in the queue and delete the parent
 
         std::queue<private_node*> queue;
         queue.push(pnode);
 
+        std::size_t count = 0;
         private_node* current = nullptr;
         while (!queue.empty())
         {
@@ -184,543 +397,6470 @@ private:
                 queue.push(child);
 
             delete current;
+            ++count;
         }
+
+        return count;
     }
 
-    void deep_copy(node n)
+    // Single thread shared by every tree of this type that frees detached subtrees asynchronously. It is started on
+    // first use and drains its queue before the program exits.
+    class background_reclaimer
     {
-        // Breadth First Algorithm
-        // Copy children of each node
-        if (n.m_node == nullptr)
-            return;
-
-        private_node* copy_root = new private_node(n.m_node->m_data);
-        m_root = copy_root;
+    private:
+        std::mutex m_mutex;
+        std::condition_variable m_work_available;
+        std::condition_variable m_idle;
+        std::vector<private_node*> m_pending;
+        bool m_busy = false;
+        bool m_stop = false;
+        std::thread m_thread;
 
-        // keeps track of nodes whose children still need to be copied
-        std::queue<std::pair<private_node*, private_node*>> org_copy_relation_queue;
-        org_copy_relation_queue.push({n.m_node, copy_root});
+        background_reclaimer() : m_thread([this] { reclaim_loop(); }) {}
 
-        while (!org_copy_relation_queue.empty())
+        void reclaim_loop()
         {
-            private_node* original_node = org_copy_relation_queue.front().first;
-            private_node* copied_node = org_copy_relation_queue.front().second;
-            org_copy_relation_queue.pop();
-
-            private_node* child_original = original_node->m_left_child;
-            private_node* prev_copied_child = nullptr;
-
-            // children copy algorithm
-            while (child_original != nullptr)
+            std::vector<private_node*> batch;
+            std::unique_lock<std::mutex> lock(m_mutex);
+            while (true)
             {
-                private_node* child_copy = new private_node(child_original->m_data);
-                child_copy->m_parent = copied_node;
+                m_work_available.wait(lock, [this] { return m_stop || !m_pending.empty(); });
+                if (m_pending.empty())
+                    return;
 
-                // if it is the first copied child, it goes as left child
-                if (prev_copied_child == nullptr)
-                    copied_node->m_left_child = child_copy;
-                else
-                    prev_copied_child->m_right_sibling = child_copy;
+                batch.swap(m_pending);
+                m_busy = true;
+                lock.unlock();
 
-                org_copy_relation_queue.push({child_original, child_copy});
+                for (private_node* root : batch)
+                    destroy_nodes(root);
+                batch.clear();
 
-                prev_copied_child = child_copy;
-                child_original = child_original->m_right_sibling;
+                lock.lock();
+                m_busy = false;
+                if (m_pending.empty())
+                    m_idle.notify_all();
             }
         }
-    }
-
-public:
-    using iterator = general_tree_iterator<false>;
-    using const_iterator = general_tree_iterator<true>;
-
-    /**
-     * @brief Public node interface
-     */
-    class node
-    {
-    private:
-        private_node* m_node;
-        friend class general_tree;
 
     public:
-        node(private_node* node = nullptr) noexcept : m_node(node) {}
+        background_reclaimer(const background_reclaimer&) = delete;
+        background_reclaimer& operator=(const background_reclaimer&) = delete;
 
-        bool operator==(const node& other) const noexcept
+        ~background_reclaimer()
         {
-            return m_node == other.m_node;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_stop = true;
+            }
+            m_work_available.notify_one();
+            m_thread.join();
         }
 
-        /**
-         * @brief Retrieves the left child of the current node.
-         * @return The left child node, or a null node if the current node has no left child.
-         */
-        [[nodiscard]] node left_child() const noexcept
+        static background_reclaimer& instance()
         {
-            return m_node->m_left_child;
+            static background_reclaimer reclaimer;
+            return reclaimer;
         }
 
-        /**
-         * @brief Retrieves the parent of the current node.
-         * @return The parent node, or a null node if the current node has no parent.
-         */
-        [[nodiscard]] node parent() const noexcept
+        void enqueue(private_node* root)
         {
-            return m_node->m_parent;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_pending.push_back(root);
+            }
+            m_work_available.notify_one();
         }
 
-        /**
-         * @brief Retrieves the right sibling of the current node.
-         * @return The right sibling node, or a null node if the current node has no right sibling.
-         */
-        [[nodiscard]] node right_sibling() const noexcept
+        void wait_idle()
         {
-            return m_node->m_right_sibling;
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_idle.wait(lock, [this] { return m_pending.empty() && !m_busy; });
         }
+    };
 
-        /**
-         * @brief Accesses the data stored in the given node.
-         * @return const T& Reference to the data stored in the node.
-         * @throws std::invalid_argument If the given node is null.
-         */
-        [[nodiscard]] const T& data() const
+    // Threads shared by every parallel algorithm of this type. They are started on first use, kept for the rest of
+    // the program and sleep on a condition variable between jobs. A job gets as many threads as it asks for: new ones
+    // are started when every thread is busy, so a job never waits for another one to finish, even when it is started
+    // from a worker of that job.
+    class worker_threads
+    {
+    private:
+        struct job
         {
-            if (!m_node)
-                throw std::invalid_argument("Cannot get data from null node");
-            return m_node->m_data;
-        }
+            const std::function<void(std::size_t)>* m_function;
+            std::size_t m_next_worker = 1;
+            std::size_t m_end_worker = 1;
+            // helpers given a worker index that have not returned yet
+            std::size_t m_running = 0;
+            std::exception_ptr m_exception;
+        };
 
-        /**
-         * @brief Accesses the data stored in the given node.
-         * @return T& Reference to the data stored in the node.
-         * @throws std::invalid_argument If the given node is null.
-         */
-        [[nodiscard]] T& data()
-        {
-            return const_cast<T&>(static_cast<const general_tree<T>::node&>(*this).data());
-        }
+        std::mutex m_mutex;
+        std::condition_variable m_work_available;
+        std::condition_variable m_job_done;
+        std::deque<job*> m_jobs;
+        std::vector<std::thread> m_threads;
+        // threads not running a job, including the ones about to pick a worker index
+        std::size_t m_free = 0;
+        // worker indices posted but not picked yet
+        std::size_t m_unclaimed = 0;
+        bool m_stop = false;
 
-        /*
-         * @brief Checks if the node is the root of the tree.
-         * @return true if the node is the root, false otherwise.
-         */
-        bool is_root() const noexcept
-        {
-            return m_node->m_parent == nullptr;
-        }
+        worker_threads() = default;
 
-        /**
-         * @brief Checks if the node is a leaf in the tree.
-         * @return true if the node is a leaf, false otherwise.
-         */
-        bool is_leaf() const noexcept
+        void worker_loop()
         {
-            return m_node->m_left_child == nullptr;
-        }
+            std::unique_lock<std::mutex> lock(m_mutex);
+            while (true)
+            {
+                m_work_available.wait(lock, [this] { return m_stop || !m_jobs.empty(); });
+                if (m_jobs.empty())
+                    return;
 
-        /**
-         * @brief Checks if the node has a right sibling.
-         * @return true if the node has a right sibling, false otherwise.
-         */
-        bool has_right_sibling() const noexcept
-        {
-            return m_node->m_right_sibling != nullptr;
+                job* current = m_jobs.front();
+                const std::size_t worker = current->m_next_worker++;
+                if (current->m_next_worker == current->m_end_worker)
+                    m_jobs.pop_front();
+                --m_unclaimed;
+                --m_free;
+                lock.unlock();
+
+                std::exception_ptr exception;
+                try
+                {
+                    (*current->m_function)(worker);
+                }
+                catch (...)
+                {
+                    exception = std::current_exception();
+                }
+
+                lock.lock();
+                if (exception && !current->m_exception)
+                    current->m_exception = exception;
+                ++m_free;
+                if (--current->m_running == 0)
+                    m_job_done.notify_all();
+            }
         }
 
-        /**
-         * @brief Checks if the node has a left child.
-         * @return true if the node has a left child, false otherwise.
-         */
-        bool has_left_child() const noexcept
+    public:
+        worker_threads(const worker_threads&) = delete;
+        worker_threads& operator=(const worker_threads&) = delete;
+
+        ~worker_threads()
         {
-            return m_node->m_left_child != nullptr;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_stop = true;
+            }
+            m_work_available.notify_all();
+            for (std::thread& thread : m_threads)
+                thread.join();
         }
 
-        /**
-         * @brief Checks if the node is null.
-         * @return true if the node is null, false otherwise.
-         */
-        bool is_null() const noexcept
+        static worker_threads& instance()
         {
-            return m_node == nullptr;
+            static worker_threads threads;
+            return threads;
         }
 
-        /**
-         * @brief Retrieves the child node at the specified index.
-         * @param index The zero-based index of the child to retrieve.
-         * @return The child node at the specified index, or a null node if the index is out of range.
-         * @throws std::invalid_argument If the current node is null.
-         */
-        [[nodiscard]] node child(std::size_t index) const
+        // - calls fn(1), ..., fn(helpers) on pool threads and fn(0) on the calling thread, and waits for all of them
+        // - if some threads cannot be started, on_missing(count) is called before fn(0) and the highest indices are
+        //   never used
+        // - rethrows the first exception thrown by fn once every call returned
+        void run(
+            std::size_t helpers, const std::function<void(std::size_t)>& fn,
+            const std::function<void(std::size_t)>& on_missing = nullptr
+        )
         {
-            if (m_node == nullptr)
-                throw std::invalid_argument("Cannot get child of null node");
+            job current;
+            current.m_function = &fn;
+            std::size_t granted = 0;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                try
+                {
+                    while (m_free < m_unclaimed + helpers)
+                    {
+                        m_threads.emplace_back([this] { worker_loop(); });
+                        ++m_free;
+                    }
+                }
+                catch (...)
+                {
+                    // the job runs on the threads available
+                }
 
-            node child = m_node->m_left_child;
+                granted = std::min(helpers, m_free - m_unclaimed);
+                if (granted > 0)
+                {
+                    current.m_end_worker = granted + 1;
+                    current.m_running = granted;
+                    m_unclaimed += granted;
+                    m_jobs.push_back(&current);
+                }
+            }
+            if (granted == 1)
+                m_work_available.notify_one();
+            else if (granted > 1)
+                m_work_available.notify_all();
 
-            for (std::size_t i = 0; i < index; i++)
+            std::exception_ptr exception;
+            try
             {
-                if (child.m_node == nullptr)
-                    return nullptr;
-                child = child.m_node->m_right_sibling;
+                if (granted < helpers && on_missing)
+                    on_missing(helpers - granted);
+                fn(0);
+            }
+            catch (...)
+            {
+                exception = std::current_exception();
             }
 
-            return child;
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_job_done.wait(lock, [&current] { return current.m_running == 0; });
+            if (!exception)
+                exception = current.m_exception;
+            if (exception)
+                std::rethrow_exception(exception);
         }
+    };
 
-        /**
-         * @brief Counts the number of children of the current node.
-         * @return The total number of children of the current node.
-         * @throws std::invalid_argument If the current node is null.
-         */
-        [[nodiscard]] std::size_t children_count() const
-        {
-            if (m_node == nullptr)
-                throw std::invalid_argument("Cannot count children of null node");
+    void deep_copy(node n)
+    {
+        auto copy = [](const T& value) -> const T& { return value; };
+        build_isomorphic(n.m_node, copy);
+    }
 
-            std::size_t count = 0;
-            for (const private_node* child = m_node->m_left_child; child != nullptr; child = child->m_right_sibling)
-                ++count;
+    // - copies the subtree rooted at source, without its right siblings, into an empty tree
+    // - every new node is constructed from make(value of the source node)
+    // - leaves the tree empty if make or a constructor throws
+    template <typename Source, typename Make>
+    void build_isomorphic(const Source* source, Make& make)
+    {
+        // Breadth First Algorithm
+        // Copy children of each node
+        if (source == nullptr)
+            return;
 
-            return count;
-        }
+        m_root = new private_node(make(source->m_data));
+        m_size = 1;
 
-        /**
-         * @brief Computes the depth of the current node in the tree.
-         * @throws std::invalid_argument if the node is null.
-         * @return std::size_t The depth of the node.
-         */
-        [[nodiscard]] std::size_t depth() const
+        try
         {
-            if (m_node == nullptr)
-                throw std::invalid_argument("Cannot get depth of null node");
-
-            private_node* aux = m_node;
-            std::size_t depth = 0;
+            // keeps track of nodes whose children still need to be copied
+            std::queue<std::pair<const Source*, private_node*>> org_copy_relation_queue;
+            org_copy_relation_queue.push({source, m_root});
 
-            while (aux->m_parent != nullptr)
+            while (!org_copy_relation_queue.empty())
             {
-                ++depth;
-                aux = aux->m_parent;
-            }
+                const Source* original_node = org_copy_relation_queue.front().first;
+                private_node* copied_node = org_copy_relation_queue.front().second;
+                org_copy_relation_queue.pop();
 
-            return depth;
-        }
+                const Source* child_original = original_node->m_left_child;
+                private_node* prev_copied_child = nullptr;
 
-        /**
-         * @brief Computes the total number of descendants of the current node.
-         * @return The total number of descendants of the current node.
-         * @throws std::invalid_argument If the current node is null.
-         */
-        [[nodiscard]] std::size_t descendants_count() const
-        {
-            if (m_node == nullptr)
-                throw std::invalid_argument("Cannot get descendants count of null node");
+                // children copy algorithm
+                while (child_original != nullptr)
+                {
+                    private_node* child_copy = new private_node(make(child_original->m_data));
+                    child_copy->m_parent = copied_node;
+                    ++m_size;
 
-            std::size_t count = 0;
-            std::queue<private_node*> q;
-            q.push(m_node);
+                    // if it is the first copied child, it goes as left child
+                    if (prev_copied_child == nullptr)
+                        copied_node->m_left_child = child_copy;
+                    else
+                        prev_copied_child->m_right_sibling = child_copy;
 
-            while (!q.empty())
-            {
-                private_node* current_node = q.front();
-                q.pop();
+                    org_copy_relation_queue.push({child_original, child_copy});
 
-                for (private_node* left_child = current_node->m_left_child; left_child != nullptr;
-                     left_child = left_child->m_right_sibling)
-                {
-                    q.push(left_child);
-                    ++count;
+                    prev_copied_child = child_copy;
+                    child_original = child_original->m_right_sibling;
                 }
             }
-
-            return count;
         }
-    };
-
-    general_tree() noexcept : m_root(nullptr) {}
-
-    general_tree(general_tree<T>&& rhs) noexcept : m_root(std::exchange(rhs.m_root, nullptr)) {}
+        catch (...)
+        {
+            destroy_nodes(std::exchange(m_root, nullptr));
+            m_size = 0;
+            throw;
+        }
+    }
 
-    general_tree(const general_tree<T>& other) : general_tree<T>()
+    // - on_enter is optional
+    // - returns false if the children of the node must be skipped
+    template <typename Visitor>
+    static bool dispatch_on_enter(Visitor& visitor, node n)
     {
-        deep_copy(other.root());
+        if constexpr (requires { { visitor.on_enter(n) } -> std::convertible_to<bool>; })
+            return static_cast<bool>(visitor.on_enter(n));
+        else if constexpr (requires { visitor.on_enter(n); })
+        {
+            visitor.on_enter(n);
+            return true;
+        }
+        else
+            return true;
     }
 
-    template <typename U, typename = std::enable_if_t<std::is_convertible_v<U, T>>>
-    general_tree(U&& root_value) : general_tree()
+    // - on_leave is optional
+    template <typename Visitor>
+    static void dispatch_on_leave(Visitor& visitor, node n)
     {
-        m_root = new private_node(std::forward<U>(root_value));
+        if constexpr (requires { visitor.on_leave(n); })
+            visitor.on_leave(n);
     }
 
-    general_tree& operator=(const general_tree<T>& other)
+    static std::size_t resolve_thread_count(std::size_t thread_count) noexcept
     {
-        if (this != &other)
-        {
-            clear();
-            deep_copy(other.root());
-        }
-        return *this;
+        if (thread_count == 0)
+            thread_count = std::thread::hardware_concurrency();
+        return thread_count == 0 ? 1 : thread_count;
     }
 
-    general_tree& operator=(general_tree&& other) noexcept
+    // - calls fn(begin, end) on chunks of [0, count) from thread_count threads, the calling thread included
+    // - rethrows the first exception thrown by fn once every thread has stopped
+    template <typename Function>
+    static void parallel_chunks(std::size_t count, std::size_t thread_count, Function& fn)
     {
-        if (this != &other)
+        if (thread_count == 1 || count < 1024)
         {
-            clear();
-            m_root = other.m_root;
-            other.m_root = nullptr;
+            fn(std::size_t(0), count);
+            return;
         }
-        return *this;
+
+        const std::size_t chunk = std::max<std::size_t>(1024, count / (thread_count * 8));
+        std::atomic<std::size_t> cursor = 0;
+        std::atomic<bool> cancelled = false;
+        std::mutex exception_mutex;
+        std::exception_ptr exception;
+
+        auto worker_loop = [&]() {
+            while (!cancelled.load(std::memory_order_relaxed))
+            {
+                const std::size_t begin = cursor.fetch_add(chunk, std::memory_order_relaxed);
+                if (begin >= count)
+                    return;
+                try
+                {
+                    fn(begin, std::min(begin + chunk, count));
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> lock(exception_mutex);
+                    if (!exception)
+                        exception = std::current_exception();
+                    cancelled.store(true, std::memory_order_relaxed);
+                }
+            }
+        };
+
+        // when fewer threads are available, the ones running (at least the calling thread) process every chunk
+        worker_threads::instance().run(thread_count - 1, [&worker_loop](std::size_t) { worker_loop(); });
+
+        if (exception)
+            std::rethrow_exception(exception);
     }
 
-    bool operator==(const general_tree<T>& other) const
+    // Runs tasks on a fixed set of workers. Every worker owns a deque: it pops its own tasks from the back and steals
+    // from the front of the other deques, where the oldest (and usually largest) subtrees are. Bodies split their work
+    // through the context when other workers are idle.
+    template <typename Task>
+    class work_stealing_pool
     {
-        if (m_root == other.m_root)
+    private:
+        struct worker_queue
+        {
+            std::mutex m_mutex;
+            std::deque<Task> m_tasks;
+        };
+
+        std::unique_ptr<worker_queue[]> m_queues;
+        std::size_t m_worker_count;
+        // tasks spawned but not finished yet
+        std::atomic<std::size_t> m_pending{0};
+        std::atomic<std::size_t> m_idle{0};
+        // bumped when a task is pushed and when the last task finished, idle workers wait for it to change
+        std::atomic<std::uint32_t> m_signal{0};
+        std::atomic<bool> m_cancelled{false};
+        std::mutex m_exception_mutex;
+        std::exception_ptr m_exception;
+
+        bool pop_local(std::size_t worker, Task& task)
+        {
+            worker_queue& queue = m_queues[worker];
+            std::lock_guard<std::mutex> lock(queue.m_mutex);
+            if (queue.m_tasks.empty())
+                return false;
+            task = std::move(queue.m_tasks.back());
+            queue.m_tasks.pop_back();
             return true;
+        }
 
-        if (m_root == nullptr || other.m_root == nullptr)
+        bool steal(std::size_t worker, Task& task)
+        {
+            for (std::size_t i = 1; i < m_worker_count; i++)
+            {
+                worker_queue& victim = m_queues[(worker + i) % m_worker_count];
+                std::lock_guard<std::mutex> lock(victim.m_mutex);
+                if (!victim.m_tasks.empty())
+                {
+                    task = std::move(victim.m_tasks.front());
+                    victim.m_tasks.pop_front();
+                    return true;
+                }
+            }
             return false;
+        }
 
-        if (m_root->m_data != other.m_root->m_data)
-            return false;
+        void push(std::size_t worker, Task task)
+        {
+            m_pending.fetch_add(1, std::memory_order_relaxed);
+            {
+                worker_queue& queue = m_queues[worker];
+                std::lock_guard<std::mutex> lock(queue.m_mutex);
+                queue.m_tasks.push_back(std::move(task));
+            }
 
-        // Breadth First Algorithm
-        // Compare the children of the equal nodes
+            m_signal.fetch_add(1);
+            if (m_idle.load() > 0)
+                m_signal.notify_one();
+        }
 
-        std::queue<std::pair<private_node*, private_node*>> equal_nodes;
-        equal_nodes.push({m_root, other.m_root});
+        void finish_task()
+        {
+            if (m_pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            {
+                m_signal.fetch_add(1);
+                m_signal.notify_all();
+            }
+        }
 
-        while (!equal_nodes.empty())
+    public:
+        class context
         {
-            private_node* tree1_node = equal_nodes.front().first;
-            private_node* tree2_node = equal_nodes.front().second;
-            equal_nodes.pop();
+        private:
+            work_stealing_pool* m_pool;
+            std::size_t m_worker;
 
-            // compare every child of both nodes
-            private_node* tree1_node_current_child = tree1_node->m_left_child;
-            private_node* tree2_node_current_child = tree2_node->m_left_child;
-            while (tree1_node_current_child != nullptr && tree2_node_current_child != nullptr)
+        public:
+            context(work_stealing_pool* pool, std::size_t worker) noexcept : m_pool(pool), m_worker(worker) {}
+
+            // true if handing work over would keep another worker busy
+            [[nodiscard]] bool should_split() const noexcept
             {
-                if (tree1_node_current_child->m_data != tree2_node_current_child->m_data)
-                    return false;
+                return m_pool->m_idle.load(std::memory_order_relaxed) > 0;
+            }
 
-                equal_nodes.push({tree1_node_current_child, tree2_node_current_child});
+            void spawn(Task task)
+            {
+                m_pool->push(m_worker, std::move(task));
+            }
 
-                tree2_node_current_child = tree2_node_current_child->m_right_sibling;
-                tree1_node_current_child = tree1_node_current_child->m_right_sibling;
+            [[nodiscard]] bool cancelled() const noexcept
+            {
+                return m_pool->m_cancelled.load(std::memory_order_relaxed);
             }
 
-            // a node contains more children than the other
-            if (tree1_node_current_child != nullptr || tree2_node_current_child != nullptr)
-                return false;
+            void cancel() noexcept
+            {
+                m_pool->m_cancelled.store(true, std::memory_order_relaxed);
+            }
+
+            [[nodiscard]] std::size_t worker() const noexcept
+            {
+                return m_worker;
+            }
+        };
+
+        explicit work_stealing_pool(std::size_t worker_count)
+            : m_queues(std::make_unique<worker_queue[]>(worker_count)), m_worker_count(worker_count)
+        {
         }
 
-        return true;
-    }
+        [[nodiscard]] std::size_t worker_count() const noexcept
+        {
+            return m_worker_count;
+        }
 
-    /**
-     * @brief Creates and emplaces the root node of the tree with the given arguments.
-     * @tparam Args Variadic template parameters representing the types of arguments to be forwarded to the root node
-     * constructor.
-     * @param args Arguments to forward to the root node constructor.
-     * @return node A handle to the newly created root node.
-     * @throws std::runtime_error If a root node already exists.
-     */
-    template <typename... Args>
-    node emplace_root(Args&&... args)
-    {
-        if (m_root != nullptr)
-            throw std::runtime_error("Root already exists");
-        m_root = new private_node(std::forward<Args>(args)...);
-        return m_root;
-    }
+        // - the calling thread is worker 0
+        // - rethrows the first exception thrown by a body after every worker stopped
+        template <typename Body>
+        void run(std::vector<Task> initial_tasks, Body& body)
+        {
+            for (Task& task : initial_tasks)
+                push(0, std::move(task));
 
-    /**
-     * @brief Creates the root node of the tree
-     * @param data The value to store in the root node.
-     * @return node A handle to the newly created root node.
-     * @throws std::runtime_error If a root node already exists.
-     */
-    template <typename U, typename = std::enable_if_t<std::is_convertible_v<U, T>>>
-    node create_root(U&& data)
+            auto worker_loop = [this, &body](std::size_t worker) {
+                context ctx(this, worker);
+                bool idle = false;
+                Task task;
+
+                while (true)
+                {
+                    // read before looking at the queues, so a task pushed afterwards wakes the wait below
+                    const std::uint32_t signal = m_signal.load();
+                    if (pop_local(worker, task) || steal(worker, task))
+                    {
+                        if (idle)
+                        {
+                            m_idle.fetch_sub(1);
+                            idle = false;
+                        }
+
+                        if (!ctx.cancelled())
+                        {
+                            try
+                            {
+                                body(task, ctx);
+                            }
+                            catch (...)
+                            {
+                                std::lock_guard<std::mutex> lock(m_exception_mutex);
+                                if (!m_exception)
+                                    m_exception = std::current_exception();
+                                ctx.cancel();
+                            }
+                        }
+
+                        finish_task();
+                        continue;
+                    }
+
+                    if (m_pending.load(std::memory_order_acquire) == 0)
+                        break;
+
+                    if (!idle)
+                    {
+                        // pushers only notify when a worker is idle, so look at the queues again before waiting
+                        m_idle.fetch_add(1);
+                        idle = true;
+                        continue;
+                    }
+                    m_signal.wait(signal);
+                }
+
+                if (idle)
+                    m_idle.fetch_sub(1);
+            };
+
+            // when fewer threads are available, the ones running (at least the calling thread) finish every task
+            worker_threads::instance().run(m_worker_count - 1, worker_loop);
+
+            if (m_exception)
+                std::rethrow_exception(m_exception);
+        }
+    };
+
+    // Depth-first processing of a task on a pool worker. expand(task, stack, ctx) handles one task and pushes the tasks
+    // of its children on the local stack. When other workers are idle, the oldest pending tasks of the stack (usually
+    // the largest subtrees) are handed over to the pool.
+    template <typename Task, typename Expand>
+    static void parallel_subtree_walk(Task subtree, typename work_stealing_pool<Task>::context& ctx, Expand& expand)
     {
-        return emplace_root(std::forward<U>(data));
+        std::vector<Task> stack;
+        stack.push_back(std::move(subtree));
+
+        while (!stack.empty() && !ctx.cancelled())
+        {
+            if (stack.size() > 1 && ctx.should_split())
+            {
+                const std::size_t half = stack.size() / 2;
+                for (std::size_t i = 0; i < half; i++)
+                    ctx.spawn(std::move(stack[i]));
+                stack.erase(stack.begin(), stack.begin() + half);
+            }
+
+            Task current = std::move(stack.back());
+            stack.pop_back();
+            expand(current, stack, ctx);
+        }
     }
 
-    /**
-     * @brief Creates and emplaces a new left child node for the given destination node.
-     * @tparam Args Variadic template parameters for the new node constructor.
-     * @param destiny The node to which the new left child will be attached.
-     * @param args Arguments to forward to the new node's constructor.
-     * @return node A handle to the newly created left child node.
-     * @throws std::invalid_argument If the destination node is null.
-     */
-    template <typename... Args>
-    node emplace_left_child(node destiny, Args&&... args)
+    // - nodes are visited in an unspecified order
+    template <typename Visit>
+    static void parallel_visit(private_node* start, std::size_t thread_count, Visit& visit)
     {
-        if (destiny.m_node == nullptr)
-            throw std::invalid_argument("Cannot insert left child to null node");
-
-        private_node* new_node = new private_node(std::forward<Args>(args)...);
-        new_node->m_right_sibling = destiny.m_node->m_left_child;
-        new_node->m_parent = destiny.m_node;
+        using pool_type = work_stealing_pool<private_node*>;
+        auto expand = [&visit](private_node* current, std::vector<private_node*>& stack, typename pool_type::context& ctx) {
+            for (private_node* child = current->m_left_child; child != nullptr; child = child->m_right_sibling)
+                stack.push_back(child);
+            visit(current, ctx);
+        };
+        auto body = [&expand](private_node* subtree, typename pool_type::context& ctx) {
+            parallel_subtree_walk(subtree, ctx, expand);
+        };
 
-        destiny.m_node->m_left_child = new_node;
-        return new_node;
+        pool_type pool(thread_count);
+        pool.run({start}, body);
     }
 
-    /**
-     * @brief Inserts a new left child node for the given destination node, with the provided value.
-     * @param destiny The node to which the left child will be inserted.
-     * @param new_node_value The value to store in the newly created left child node.
-     * @return node A handle to the newly created left child node.
-     * @throws std::invalid_argument If the destination node is null.
-     */
-    template <typename U, typename = std::enable_if_t<std::is_convertible_v<U, T>>>
-    node insert_left_child(node destiny, U&& new_node_value)
+    // - copies the subtree rooted at source, without its right siblings, into an empty tree
+    // - leaves the tree empty if a copy constructor throws
+    // - the caller sets the size of the tree
+    void parallel_deep_copy(const private_node* source, std::size_t thread_count)
     {
-        return emplace_left_child(destiny, std::forward<U>(new_node_value));
+        auto copy = [](const T& value) -> const T& { return value; };
+        parallel_build_isomorphic(source, thread_count, copy);
     }
 
-    /**
-     * @brief Inserts an entire subtree as the left child of the given destination node.
-     * @param destiny The node to which the tree will be inserted as a left child.
-     * @param tree The tree to insert as a left child. After insertion, this tree will be empty.
-     * @return node A handle to the newly inserted left child node, or a null node if the tree is empty.
-     * @throws std::invalid_argument If the destination node is null or if attempting to insert the tree as a child of
-     * its own root.
-     */
-    node insert_left_child(node destiny, general_tree<T>& tree)
+    // - same as parallel_deep_copy, every new node is constructed from make(value of the source node)
+    // - make is called from several threads at once
+    template <typename Source, typename Make>
+    void parallel_build_isomorphic(const Source* source, std::size_t thread_count, Make& make)
     {
-        if (!destiny.m_node)
-            throw std::invalid_argument("Cannot insert left child to null node");
+        if (source == nullptr)
+            return;
 
-        if (destiny.m_node == tree.m_root)
-            throw std::invalid_argument("Cannot insert a tree as its own child");
+        // (original, copy) pairs whose children still need to be copied
+        using task_type = std::pair<const Source*, private_node*>;
+        using pool_type = work_stealing_pool<task_type>;
 
-        if (tree.m_root)
+        auto expand = [&make](task_type& task, std::vector<task_type>& stack, typename pool_type::context&) {
+            private_node* prev_copied_child = nullptr;
+            for (const Source* child = task.first->m_left_child; child != nullptr; child = child->m_right_sibling)
+            {
+                private_node* child_copy = new private_node(make(child->m_data));
+                child_copy->m_parent = task.second;
+
+                // linked right away, so a partial copy can always be destroyed
+                if (prev_copied_child == nullptr)
+                    task.second->m_left_child = child_copy;
+                else
+                    prev_copied_child->m_right_sibling = child_copy;
+
+                stack.push_back({child, child_copy});
+                prev_copied_child = child_copy;
+            }
+        };
+        auto body = [&expand](task_type& task, typename pool_type::context& ctx) {
+            parallel_subtree_walk(task, ctx, expand);
+        };
+
+        m_root = new private_node(make(source->m_data));
+        try
         {
-            tree.m_root->m_parent = destiny.m_node;
-            tree.m_root->m_right_sibling = destiny.m_node->m_left_child;
-            destiny.m_node->m_left_child = tree.m_root;
-            tree.m_root = nullptr;
-            return destiny.m_node->m_left_child;
+            pool_type pool(thread_count);
+            pool.run({{source, m_root}}, body);
+        }
+        catch (...)
+        {
+            destroy_subtree(std::exchange(m_root, nullptr));
+            m_size = 0;
+            throw;
         }
-
-        return node(nullptr);
     }
 
+public:
+    using iterator = general_tree_iterator<false>;
+    using const_iterator = general_tree_iterator<true>;
+
     /**
-     * @brief Inserts an entire subtree as the right sibling of the given destination node.
-     * @param destiny The node to which the tree will be inserted as a right sibling.
-     * @param tree The tree to insert as a right sibling. After insertion, this tree will be empty.
-     * @return node A handle to the newly inserted right sibling node, or a null node if the tree is empty.
-     * @throws std::invalid_argument If the destination node is null, is the root (cannot have siblings),
-     *                               or if attempting to insert the tree as its own sibling.
+     * @brief Public node interface
      */
-    node insert_right_sibling(node destiny, general_tree<T>& tree)
+    class node
     {
-        if (destiny.m_node == nullptr)
-            throw std::invalid_argument("Cannot insert right sibling to null node");
-
-        if (destiny.m_node->m_parent == nullptr)
-            throw std::invalid_argument("Cannot insert right sibling to root");
+    private:
+        private_node* m_node;
+        friend class general_tree;
 
-        if (destiny.m_node == tree.m_root)
-            throw std::invalid_argument("Cannot insert a tree as its own sibling");
+    public:
+        node(private_node* node = nullptr) noexcept : m_node(node) {}
 
-        if (tree.m_root)
+        bool operator==(const node& other) const noexcept
         {
-            tree.m_root->m_parent = destiny.m_node->m_parent;
-            tree.m_root->m_right_sibling = destiny.m_node->m_right_sibling;
-            destiny.m_node->m_right_sibling = tree.m_root;
-            tree.m_root = nullptr;
-            return destiny.m_node->m_right_sibling;
+            return m_node == other.m_node;
         }
 
-        return node(nullptr);
-    }
+        /**
+         * @brief Retrieves the left child of the current node.
+         * @return The left child node, or a null node if the current node has no left child.
+         */
+        [[nodiscard]] node left_child() const noexcept
+        {
+            return m_node->m_left_child;
+        }
 
+        /**
+         * @brief Retrieves the parent of the current node.
+         * @return The parent node, or a null node if the current node has no parent.
+         */
+        [[nodiscard]] node parent() const noexcept
+        {
+            return m_node->m_parent;
+        }
+
+        /**
+         * @brief Retrieves the right sibling of the current node.
+         * @return The right sibling node, or a null node if the current node has no right sibling.
+         */
+        [[nodiscard]] node right_sibling() const noexcept
+        {
+            return m_node->m_right_sibling;
+        }
+
+        /**
+         * @brief Accesses the data stored in the given node.
+         * @return const T& Reference to the data stored in the node.
+         * @throws std::invalid_argument If the given node is null.
+         */
+        [[nodiscard]] const T& data() const
+        {
+            if (!m_node)
+                throw std::invalid_argument("Cannot get data from null node");
+            return m_node->m_data;
+        }
+
+        /**
+         * @brief Accesses the data stored in the given node.
+         * @return T& Reference to the data stored in the node.
+         * @throws std::invalid_argument If the given node is null.
+         */
+        [[nodiscard]] T& data()
+        {
+            return const_cast<T&>(static_cast<const general_tree<T>::node&>(*this).data());
+        }
+
+        /*
+         * @brief Checks if the node is the root of the tree.
+         * @return true if the node is the root, false otherwise.
+         */
+        bool is_root() const noexcept
+        {
+            return m_node->m_parent == nullptr;
+        }
+
+        /**
+         * @brief Checks if the node is a leaf in the tree.
+         * @return true if the node is a leaf, false otherwise.
+         */
+        bool is_leaf() const noexcept
+        {
+            return m_node->m_left_child == nullptr;
+        }
+
+        /**
+         * @brief Checks if the node has a right sibling.
+         * @return true if the node has a right sibling, false otherwise.
+         */
+        bool has_right_sibling() const noexcept
+        {
+            return m_node->m_right_sibling != nullptr;
+        }
+
+        /**
+         * @brief Checks if the node has a left child.
+         * @return true if the node has a left child, false otherwise.
+         */
+        bool has_left_child() const noexcept
+        {
+            return m_node->m_left_child != nullptr;
+        }
+
+        /**
+         * @brief Checks if the node is null.
+         * @return true if the node is null, false otherwise.
+         */
+        bool is_null() const noexcept
+        {
+            return m_node == nullptr;
+        }
+
+        /**
+         * @brief Retrieves the child node at the specified index.
+         * @param index The zero-based index of the child to retrieve.
+         * @return The child node at the specified index, or a null node if the index is out of range.
+         * @throws std::invalid_argument If the current node is null.
+         */
+        [[nodiscard]] node child(std::size_t index) const
+        {
+            if (m_node == nullptr)
+                throw std::invalid_argument("Cannot get child of null node");
+
+            node child = m_node->m_left_child;
+
+            for (std::size_t i = 0; i < index; i++)
+            {
+                if (child.m_node == nullptr)
+                    return nullptr;
+                child = child.m_node->m_right_sibling;
+            }
+
+            return child;
+        }
+
+        /**
+         * @brief Counts the number of children of the current node.
+         * @return The total number of children of the current node.
+         * @throws std::invalid_argument If the current node is null.
+         */
+        [[nodiscard]] std::size_t children_count() const
+        {
+            if (m_node == nullptr)
+                throw std::invalid_argument("Cannot count children of null node");
+
+            std::size_t count = 0;
+            for (const private_node* child = m_node->m_left_child; child != nullptr; child = child->m_right_sibling)
+                ++count;
+
+            return count;
+        }
+
+        /**
+         * @brief Computes the depth of the current node in the tree.
+         * @throws std::invalid_argument if the node is null.
+         * @return std::size_t The depth of the node.
+         */
+        [[nodiscard]] std::size_t depth() const
+        {
+            if (m_node == nullptr)
+                throw std::invalid_argument("Cannot get depth of null node");
+
+            private_node* aux = m_node;
+            std::size_t depth = 0;
+
+            while (aux->m_parent != nullptr)
+            {
+                ++depth;
+                aux = aux->m_parent;
+            }
+
+            return depth;
+        }
+
+        /**
+         * @brief Computes the total number of descendants of the current node.
+         * @return The total number of descendants of the current node.
+         * @throws std::invalid_argument If the current node is null.
+         */
+        [[nodiscard]] std::size_t descendants_count() const
+        {
+            if (m_node == nullptr)
+                throw std::invalid_argument("Cannot get descendants count of null node");
+
+            std::size_t count = 0;
+            std::queue<private_node*> q;
+            q.push(m_node);
+
+            while (!q.empty())
+            {
+                private_node* current_node = q.front();
+                q.pop();
+
+                for (private_node* left_child = current_node->m_left_child; left_child != nullptr;
+                     left_child = left_child->m_right_sibling)
+                {
+                    q.push(left_child);
+                    ++count;
+                }
+            }
+
+            return count;
+        }
+    };
+
+    /**
+     * @brief Lazy, allocation-free range of node handles.
+     * @details Views only hold node pointers, so they are cheap to copy and compose with the standard range adaptors.
+     * The structure of the tree must not be modified while a view is being iterated.
+     */
+    template <view_type type>
+    class general_tree_view : public std::ranges::view_interface<general_tree_view<type>>
+    {
+    private:
+        private_node* m_origin = nullptr;
+        std::size_t m_target_depth = 0;
+
+    public:
+        class iterator
+        {
+        public:
+            using iterator_concept = std::forward_iterator_tag;
+            using iterator_category = std::input_iterator_tag;
+            using value_type = node;
+            using difference_type = std::ptrdiff_t;
+            using reference = node;
+
+        private:
+            friend class general_tree_view;
+
+            private_node* m_ptr = nullptr;
+            private_node* m_origin = nullptr;
+            std::size_t m_depth = 0;
+            std::size_t m_target_depth = 0;
+
+            // preorder step that never leaves the subtree of the origin
+            void preorder_step(bool descend)
+            {
+                if (descend && m_ptr->m_left_child != nullptr)
+                {
+                    m_ptr = m_ptr->m_left_child;
+                    ++m_depth;
+                    return;
+                }
+
+                while (m_ptr != m_origin && m_ptr->m_right_sibling == nullptr)
+                {
+                    m_ptr = m_ptr->m_parent;
+                    --m_depth;
+                }
+
+                m_ptr = (m_ptr == m_origin) ? nullptr : m_ptr->m_right_sibling;
+            }
+
+            // moves forward (current node included) until a node the view yields is found
+            void settle()
+            {
+                switch (type)
+                {
+                case view_type::siblings:
+                    if (m_ptr == m_origin)
+                        m_ptr = m_ptr->m_right_sibling;
+                    break;
+                case view_type::leaves:
+                    while (m_ptr != nullptr && m_ptr->m_left_child != nullptr)
+                        preorder_step(true);
+                    break;
+                case view_type::level:
+                    // subtrees are never entered below the target depth
+                    while (m_ptr != nullptr && m_depth != m_target_depth)
+                        preorder_step(m_depth < m_target_depth);
+                    break;
+                default:
+                    break;
+                }
+            }
+
+            void move_to_the_next_node()
+            {
+                switch (type)
+                {
+                case view_type::children:
+                case view_type::siblings:
+                    m_ptr = m_ptr->m_right_sibling;
+                    break;
+                case view_type::ancestors:
+                    m_ptr = m_ptr->m_parent;
+                    break;
+                case view_type::leaves:
+                    preorder_step(true);
+                    break;
+                case view_type::level:
+                    preorder_step(false);
+                    break;
+                case view_type::bounded_preorder:
+                    // pruning a subtree at the limit is O(1)
+                    preorder_step(m_depth < m_target_depth);
+                    break;
+                }
+                settle();
+            }
+
+            iterator(private_node* ptr, private_node* origin, std::size_t target_depth)
+                : m_ptr(ptr), m_origin(origin), m_target_depth(target_depth)
+            {
+                if (m_ptr != nullptr)
+                    settle();
+            }
+
+        public:
+            iterator() = default;
+
+            iterator& operator++()
+            {
+                move_to_the_next_node();
+                return *this;
+            }
+
+            iterator operator++(int)
+            {
+                auto aux = *this;
+                move_to_the_next_node();
+                return aux;
+            }
+
+            [[nodiscard]] node operator*() const
+            {
+                return m_ptr;
+            }
+
+            [[nodiscard]] bool operator==(const iterator& other) const
+            {
+                return m_ptr == other.m_ptr;
+            }
+        };
+
+        general_tree_view() = default;
+
+        general_tree_view(private_node* origin, std::size_t target_depth = 0)
+            : m_origin(origin), m_target_depth(target_depth)
+        {
+        }
+
+        [[nodiscard]] iterator begin() const
+        {
+            switch (type)
+            {
+            case view_type::children:
+                return iterator(m_origin->m_left_child, m_origin, m_target_depth);
+            case view_type::ancestors:
+                return iterator(m_origin->m_parent, m_origin, m_target_depth);
+            case view_type::siblings:
+                return iterator(
+                    m_origin->m_parent != nullptr ? m_origin->m_parent->m_left_child : nullptr, m_origin, m_target_depth
+                );
+            default:
+                return iterator(m_origin, m_origin, m_target_depth);
+            }
+        }
+
+        [[nodiscard]] iterator end() const
+        {
+            return iterator();
+        }
+    };
+
+    using children_view = general_tree_view<view_type::children>;
+    using ancestors_view = general_tree_view<view_type::ancestors>;
+    using siblings_view = general_tree_view<view_type::siblings>;
+    using leaves_view = general_tree_view<view_type::leaves>;
+    using level_view = general_tree_view<view_type::level>;
+    using bounded_preorder_view = general_tree_view<view_type::bounded_preorder>;
+
+    /**
+     * @brief Level-order range that stops descending at a maximum depth.
+     * @details The view owns the frontier buffers, so it is an input range: it can be iterated once per call to
+     * begin(). Each node is visited once and the children of nodes at the maximum depth are never touched.
+     */
+    class bounded_level_order_view : public std::ranges::view_interface<bounded_level_order_view>
+    {
+    private:
+        private_node* m_origin = nullptr;
+        std::size_t m_max_depth = 0;
+        std::vector<private_node*> m_current_level;
+        std::vector<private_node*> m_next_level;
+        std::size_t m_position = 0;
+        std::size_t m_depth = 0;
+
+        void move_to_the_next_node()
+        {
+            private_node* visited = m_current_level[m_position];
+            if (m_depth < m_max_depth)
+            {
+                for (private_node* child = visited->m_left_child; child != nullptr; child = child->m_right_sibling)
+                    m_next_level.push_back(child);
+            }
+
+            if (++m_position == m_current_level.size())
+            {
+                // swap frontiers, buffers keep their capacity
+                m_current_level.swap(m_next_level);
+                m_next_level.clear();
+                m_position = 0;
+                ++m_depth;
+            }
+        }
+
+    public:
+        class iterator
+        {
+        public:
+            using iterator_concept = std::input_iterator_tag;
+            using value_type = node;
+            using difference_type = std::ptrdiff_t;
+
+        private:
+            bounded_level_order_view* m_view = nullptr;
+
+        public:
+            iterator() = default;
+
+            explicit iterator(bounded_level_order_view* view) : m_view(view) {}
+
+            iterator& operator++()
+            {
+                m_view->move_to_the_next_node();
+                return *this;
+            }
+
+            void operator++(int)
+            {
+                m_view->move_to_the_next_node();
+            }
+
+            [[nodiscard]] node operator*() const
+            {
+                return m_view->m_current_level[m_view->m_position];
+            }
+
+            /**
+             * @brief Returns the depth of the current node, relative to the root of the traversal.
+             */
+            [[nodiscard]] std::size_t depth() const noexcept
+            {
+                return m_view->m_depth;
+            }
+
+            [[nodiscard]] bool operator==(std::default_sentinel_t) const noexcept
+            {
+                return m_view->m_position >= m_view->m_current_level.size();
+            }
+        };
+
+        bounded_level_order_view() = default;
+
+        bounded_level_order_view(private_node* origin, std::size_t max_depth) : m_origin(origin), m_max_depth(max_depth)
+        {
+        }
+
+        [[nodiscard]] iterator begin()
+        {
+            m_current_level.assign(1, m_origin);
+            m_next_level.clear();
+            m_position = 0;
+            m_depth = 0;
+            return iterator(this);
+        }
+
+        [[nodiscard]] std::default_sentinel_t end() const noexcept
+        {
+            return std::default_sentinel;
+        }
+    };
+
+    /**
+     * @brief Returns a view over the children of the given node, from left to right.
+     * @throws std::invalid_argument If the node is null.
+     */
+    [[nodiscard]] static children_view children(node n)
+    {
+        if (n.m_node == nullptr)
+            throw std::invalid_argument("Cannot get children of null node");
+        return children_view(n.m_node);
+    }
+
+    /**
+     * @brief Returns a view over the ancestors of the given node, from its parent up to the root.
+     * @throws std::invalid_argument If the node is null.
+     */
+    [[nodiscard]] static ancestors_view ancestors(node n)
+    {
+        if (n.m_node == nullptr)
+            throw std::invalid_argument("Cannot get ancestors of null node");
+        return ancestors_view(n.m_node);
+    }
+
+    /**
+     * @brief Returns a view over the other children of the parent of the given node, from left to right.
+     * @details The node itself is not included. The root has no siblings.
+     * @throws std::invalid_argument If the node is null.
+     */
+    [[nodiscard]] static siblings_view siblings(node n)
+    {
+        if (n.m_node == nullptr)
+            throw std::invalid_argument("Cannot get siblings of null node");
+        return siblings_view(n.m_node);
+    }
+
+    /**
+     * @brief Returns a view over the leaves of the subtree rooted at the given node, in preorder.
+     * @throws std::invalid_argument If the node is null.
+     */
+    [[nodiscard]] static leaves_view leaves(node subtree)
+    {
+        if (subtree.m_node == nullptr)
+            throw std::invalid_argument("Cannot get leaves of null node");
+        return leaves_view(subtree.m_node);
+    }
+
+    /**
+     * @brief Returns a preorder view of the subtree that does not descend below the given depth.
+     * @details Depths are relative to the subtree root; the children of nodes at max_depth are skipped in O(1), so the
+     * cost is proportional to the number of nodes yielded.
+     * @throws std::invalid_argument If the node is null.
+     */
+    [[nodiscard]] static bounded_preorder_view bounded_preorder(node subtree, std::size_t max_depth)
+    {
+        if (subtree.m_node == nullptr)
+            throw std::invalid_argument("Cannot traverse null node");
+        return bounded_preorder_view(subtree.m_node, max_depth);
+    }
+
+    /**
+     * @brief Returns a level-order view of the subtree that does not descend below the given depth.
+     * @details Depths are relative to the subtree root. Nodes are yielded level by level, from left to right.
+     * @throws std::invalid_argument If the node is null.
+     */
+    [[nodiscard]] static bounded_level_order_view bounded_level_order(node subtree, std::size_t max_depth)
+    {
+        if (subtree.m_node == nullptr)
+            throw std::invalid_argument("Cannot traverse null node");
+        return bounded_level_order_view(subtree.m_node, max_depth);
+    }
+
+    /**
+     * @brief Returns a view over the nodes of the subtree at the given depth, relative to the subtree root.
+     * @details Nodes are yielded from left to right. Nodes below the requested depth are never visited.
+     * @throws std::invalid_argument If the node is null.
+     */
+    [[nodiscard]] static level_view nodes_at_depth(node subtree, std::size_t depth)
+    {
+        if (subtree.m_node == nullptr)
+            throw std::invalid_argument("Cannot get nodes at depth of null node");
+        return level_view(subtree.m_node, depth);
+    }
+
+    /**
+     * @brief Coroutine that yields node handles on demand.
+     * @details The walk runs until the next node is produced and is then suspended, so it can be resumed later (e.g.
+     * on the next event-loop tick) through next(), or consumed as an input range. Coroutine frames are recycled by a
+     * per-thread pool, so creating walks repeatedly does not reach the global allocator once the pool is warm. The
+     * structure of the tree must not be modified while a walk is suspended inside it.
+     */
+    class generator
+    {
+    private:
+        // per-thread free lists of coroutine frames, one list per 64-byte size class
+        class frame_pool
+        {
+        private:
+            static constexpr std::size_t granularity = 64;
+            static constexpr std::size_t size_classes = 16;
+
+            struct free_block
+            {
+                free_block* m_next;
+            };
+
+            std::array<free_block*, size_classes> m_free_lists{};
+
+            static frame_pool& instance() noexcept
+            {
+                thread_local frame_pool pool;
+                return pool;
+            }
+
+            static std::size_t size_class(std::size_t size) noexcept
+            {
+                return (size + granularity - 1) / granularity - 1;
+            }
+
+        public:
+            frame_pool() = default;
+            frame_pool(const frame_pool&) = delete;
+            frame_pool& operator=(const frame_pool&) = delete;
+
+            ~frame_pool()
+            {
+                for (std::size_t i = 0; i < size_classes; i++)
+                {
+                    while (m_free_lists[i] != nullptr)
+                        ::operator delete(std::exchange(m_free_lists[i], m_free_lists[i]->m_next));
+                }
+            }
+
+            static void* allocate(std::size_t size)
+            {
+                const std::size_t index = size_class(size);
+                if (index >= size_classes)
+                    return ::operator new(size);
+
+                free_block*& head = instance().m_free_lists[index];
+                if (head != nullptr)
+                    return std::exchange(head, head->m_next);
+
+                return ::operator new((index + 1) * granularity);
+            }
+
+            static void deallocate(void* ptr, std::size_t size) noexcept
+            {
+                const std::size_t index = size_class(size);
+                if (index >= size_classes)
+                {
+                    ::operator delete(ptr);
+                    return;
+                }
+
+                free_block*& head = instance().m_free_lists[index];
+                head = ::new (ptr) free_block{head};
+            }
+        };
+
+    public:
+        struct promise_type
+        {
+            private_node* m_current = nullptr;
+            std::exception_ptr m_exception;
+
+            generator get_return_object() noexcept
+            {
+                return generator(std::coroutine_handle<promise_type>::from_promise(*this));
+            }
+
+            std::suspend_always initial_suspend() const noexcept
+            {
+                return {};
+            }
+
+            std::suspend_always final_suspend() const noexcept
+            {
+                return {};
+            }
+
+            std::suspend_always yield_value(node n) noexcept
+            {
+                m_current = n.m_node;
+                return {};
+            }
+
+            void return_void() const noexcept {}
+
+            void unhandled_exception() noexcept
+            {
+                m_exception = std::current_exception();
+            }
+
+            static void* operator new(std::size_t size)
+            {
+                return frame_pool::allocate(size);
+            }
+
+            static void operator delete(void* ptr, std::size_t size) noexcept
+            {
+                frame_pool::deallocate(ptr, size);
+            }
+        };
+
+        class iterator
+        {
+        public:
+            using iterator_concept = std::input_iterator_tag;
+            using value_type = node;
+            using difference_type = std::ptrdiff_t;
+
+        private:
+            generator* m_generator = nullptr;
+
+        public:
+            iterator() = default;
+
+            explicit iterator(generator* gen) : m_generator(gen) {}
+
+            iterator& operator++()
+            {
+                m_generator->next();
+                return *this;
+            }
+
+            void operator++(int)
+            {
+                m_generator->next();
+            }
+
+            [[nodiscard]] node operator*() const
+            {
+                return m_generator->current();
+            }
+
+            [[nodiscard]] bool operator==(std::default_sentinel_t) const noexcept
+            {
+                return m_generator->done();
+            }
+        };
+
+    private:
+        std::coroutine_handle<promise_type> m_handle;
+        bool m_started = false;
+
+        explicit generator(std::coroutine_handle<promise_type> handle) noexcept : m_handle(handle) {}
+
+    public:
+        generator(generator&& other) noexcept
+            : m_handle(std::exchange(other.m_handle, nullptr)), m_started(other.m_started)
+        {
+        }
+
+        generator& operator=(generator&& other) noexcept
+        {
+            if (this != &other)
+            {
+                if (m_handle)
+                    m_handle.destroy();
+                m_handle = std::exchange(other.m_handle, nullptr);
+                m_started = other.m_started;
+            }
+            return *this;
+        }
+
+        ~generator()
+        {
+            if (m_handle)
+                m_handle.destroy();
+        }
+
+        /**
+         * @brief Resumes the walk until the next node is produced.
+         * @return true if a node was produced, false if the walk is over.
+         */
+        bool next()
+        {
+            m_started = true;
+            if (m_handle.done())
+                return false;
+
+            m_handle.resume();
+            if (m_handle.promise().m_exception)
+                std::rethrow_exception(std::exchange(m_handle.promise().m_exception, nullptr));
+
+            return !m_handle.done();
+        }
+
+        /**
+         * @brief Returns the last node produced by the walk.
+         */
+        [[nodiscard]] node current() const noexcept
+        {
+            return m_handle.promise().m_current;
+        }
+
+        /**
+         * @brief Checks whether the walk is over.
+         */
+        [[nodiscard]] bool done() const noexcept
+        {
+            return m_handle.done();
+        }
+
+        /**
+         * @brief Starts the walk if it was not started yet; otherwise continues from the current node.
+         */
+        [[nodiscard]] iterator begin()
+        {
+            if (!m_started)
+                next();
+            return iterator(this);
+        }
+
+        [[nodiscard]] std::default_sentinel_t end() const noexcept
+        {
+            return std::default_sentinel;
+        }
+    };
+
+private:
+    static generator preorder_walk(private_node* start)
+    {
+        private_node* current = start;
+        while (current != nullptr)
+        {
+            co_yield current;
+
+            if (current->m_left_child != nullptr)
+            {
+                current = current->m_left_child;
+                continue;
+            }
+
+            while (current != start && current->m_right_sibling == nullptr)
+                current = current->m_parent;
+            current = (current == start) ? nullptr : current->m_right_sibling;
+        }
+    }
+
+    static generator postorder_walk(private_node* start)
+    {
+        private_node* current = start;
+        while (current->m_left_child != nullptr)
+            current = current->m_left_child;
+
+        while (true)
+        {
+            co_yield current;
+
+            if (current == start)
+                co_return;
+
+            if (current->m_right_sibling != nullptr)
+            {
+                current = current->m_right_sibling;
+                while (current->m_left_child != nullptr)
+                    current = current->m_left_child;
+            }
+            else
+                current = current->m_parent;
+        }
+    }
+
+    template <typename Predicate>
+    static generator filter_walk_impl(private_node* start, Predicate pred)
+    {
+        private_node* current = start;
+        while (current != nullptr)
+        {
+            const bool accepted = pred(node(current));
+            if (accepted)
+                co_yield current;
+
+            if (accepted && current->m_left_child != nullptr)
+            {
+                current = current->m_left_child;
+                continue;
+            }
+
+            while (current != start && current->m_right_sibling == nullptr)
+                current = current->m_parent;
+            current = (current == start) ? nullptr : current->m_right_sibling;
+        }
+    }
+
+public:
+    /**
+     * @brief Returns a resumable preorder walk of the subtree rooted at the given node.
+     * @throws std::invalid_argument If the node is null.
+     */
+    [[nodiscard]] static generator preorder(node subtree)
+    {
+        if (subtree.m_node == nullptr)
+            throw std::invalid_argument("Cannot walk null node");
+        return preorder_walk(subtree.m_node);
+    }
+
+    /**
+     * @brief Returns a resumable postorder walk of the subtree rooted at the given node.
+     * @throws std::invalid_argument If the node is null.
+     */
+    [[nodiscard]] static generator postorder(node subtree)
+    {
+        if (subtree.m_node == nullptr)
+            throw std::invalid_argument("Cannot walk null node");
+        return postorder_walk(subtree.m_node);
+    }
+
+    /**
+     * @brief Returns a resumable preorder walk that only yields the nodes accepted by the predicate.
+     * @details Nodes rejected by the predicate are skipped together with their descendants. Exceptions thrown by the
+     * predicate are rethrown by the call that resumed the walk.
+     * @param subtree The root of the walk.
+     * @param pred Callable taking a node and returning a value convertible to bool. It is stored in the walk.
+     * @throws std::invalid_argument If the node is null.
+     */
+    template <typename Predicate>
+    [[nodiscard]] static generator filter_walk(node subtree, Predicate pred)
+    {
+        if (subtree.m_node == nullptr)
+            throw std::invalid_argument("Cannot walk null node");
+        return filter_walk_impl(subtree.m_node, std::move(pred));
+    }
+
+    /**
+     * @brief Stateful position in a tree for fast local navigation and in-place edits.
+     * @details The cursor remembers the path from the root to the current node together with the left siblings of
+     * every node on that path, so up(), next_sibling() and prev_sibling() are O(1) amortized, down(i) is O(i) and
+     * depth() and index() are O(1). Structural changes must go through the cursor while it is in use; modifying the
+     * tree through other handles invalidates it.
+     */
+    class tree_cursor
+    {
+    private:
+        friend class general_tree;
+
+        general_tree* m_tree;
+        private_node* m_current;
+        // left siblings of every node on the path, level by level
+        std::vector<private_node*> m_left_siblings;
+        // position in m_left_siblings where each level below the root starts
+        std::vector<std::size_t> m_level_begin;
+
+        tree_cursor(general_tree* tree, private_node* current) : m_tree(tree), m_current(current) {}
+
+        std::size_t current_level_begin() const noexcept
+        {
+            return m_level_begin.empty() ? 0 : m_level_begin.back();
+        }
+
+    public:
+        /**
+         * @brief Returns the node the cursor points to, or a null node if the cursor is empty.
+         */
+        [[nodiscard]] node current() const noexcept
+        {
+            return m_current;
+        }
+
+        /**
+         * @brief Checks whether the cursor points to no node.
+         */
+        [[nodiscard]] bool is_null() const noexcept
+        {
+            return m_current == nullptr;
+        }
+
+        /**
+         * @brief Returns the depth of the current node.
+         */
+        [[nodiscard]] std::size_t depth() const noexcept
+        {
+            return m_level_begin.size();
+        }
+
+        /**
+         * @brief Returns the zero-based position of the current node among its siblings.
+         */
+        [[nodiscard]] std::size_t index() const noexcept
+        {
+            return m_left_siblings.size() - current_level_begin();
+        }
+
+        /**
+         * @brief Moves the cursor to the child at the given index.
+         * @return true if the cursor moved, false if the child does not exist (the cursor is left unchanged).
+         */
+        bool down(std::size_t index = 0)
+        {
+            if (m_current == nullptr)
+                return false;
+
+            private_node* target = m_current->m_left_child;
+            for (std::size_t i = 0; i < index && target != nullptr; i++)
+                target = target->m_right_sibling;
+
+            if (target == nullptr)
+                return false;
+
+            m_level_begin.push_back(m_left_siblings.size());
+            for (private_node* aux = m_current->m_left_child; aux != target; aux = aux->m_right_sibling)
+                m_left_siblings.push_back(aux);
+
+            m_current = target;
+            return true;
+        }
+
+        /**
+         * @brief Moves the cursor to the parent of the current node.
+         * @return true if the cursor moved, false if the current node is the root.
+         */
+        bool up()
+        {
+            if (m_current == nullptr || m_level_begin.empty())
+                return false;
+
+            m_left_siblings.resize(m_level_begin.back());
+            m_level_begin.pop_back();
+            m_current = m_current->m_parent;
+            return true;
+        }
+
+        /**
+         * @brief Moves the cursor to the right sibling of the current node.
+         * @return true if the cursor moved, false if there is no right sibling.
+         */
+        bool next_sibling()
+        {
+            if (m_current == nullptr || m_current->m_right_sibling == nullptr)
+                return false;
+
+            m_left_siblings.push_back(m_current);
+            m_current = m_current->m_right_sibling;
+            return true;
+        }
+
+        /**
+         * @brief Moves the cursor to the left sibling of the current node.
+         * @return true if the cursor moved, false if the current node is the first child.
+         */
+        bool prev_sibling()
+        {
+            if (m_current == nullptr || index() == 0)
+                return false;
+
+            m_current = m_left_siblings.back();
+            m_left_siblings.pop_back();
+            return true;
+        }
+
+        /**
+         * @brief Creates and emplaces a new left child for the current node. The cursor does not move.
+         * @return node A handle to the newly created node.
+         * @throws std::invalid_argument If the cursor is null.
+         */
+        template <typename... Args>
+        node emplace_left_child(Args&&... args)
+        {
+            return m_tree->emplace_left_child(m_current, std::forward<Args>(args)...);
+        }
+
+        /**
+         * @brief Creates and emplaces a new right sibling for the current node. The cursor does not move.
+         * @return node A handle to the newly created node.
+         * @throws std::invalid_argument If the cursor is null or points to the root.
+         */
+        template <typename... Args>
+        node emplace_right_sibling(Args&&... args)
+        {
+            return m_tree->emplace_right_sibling(m_current, std::forward<Args>(args)...);
+        }
+
+        /**
+         * @brief Deletes the current node and all its descendants.
+         * @details The cursor moves to the right sibling if there is one, otherwise to the left sibling, otherwise to
+         * the parent. Erasing the root leaves the tree empty and the cursor null.
+         * @throws std::invalid_argument If the cursor is null.
+         */
+        void erase()
+        {
+            if (m_current == nullptr)
+                throw std::invalid_argument("Cannot erase null cursor");
+
+            private_node* target = m_current;
+            private_node* next = target->m_right_sibling;
+
+            // unlink, the predecessor is already known
+            if (m_level_begin.empty())
+                m_tree->m_root = nullptr;
+            else if (index() == 0)
+                target->m_parent->m_left_child = next;
+            else
+                m_left_siblings.back()->m_right_sibling = next;
+
+            if (next != nullptr)
+                m_current = next;
+            else if (m_level_begin.empty())
+                m_current = nullptr;
+            else if (index() > 0)
+            {
+                m_current = m_left_siblings.back();
+                m_left_siblings.pop_back();
+            }
+            else
+            {
+                m_left_siblings.resize(m_level_begin.back());
+                m_level_begin.pop_back();
+                m_current = target->m_parent;
+            }
+
+            m_tree->destroy_subtree(target);
+        }
+    };
+
+    /**
+     * @brief Returns a cursor positioned at the root of the tree, or a null cursor if the tree is empty.
+     */
+    [[nodiscard]] tree_cursor cursor() noexcept
+    {
+        return tree_cursor(this, m_root);
+    }
+
+    /**
+     * @brief Returns a cursor positioned at the given node.
+     * @details The path to the node is rebuilt once, in O(depth * siblings); navigation afterwards is local.
+     * @throws std::invalid_argument If the node is null.
+     */
+    [[nodiscard]] tree_cursor cursor(node n)
+    {
+        if (n.m_node == nullptr)
+            throw std::invalid_argument("Cannot create cursor from null node");
+
+        std::vector<private_node*> path;
+        for (private_node* aux = n.m_node; aux->m_parent != nullptr; aux = aux->m_parent)
+            path.push_back(aux);
+
+        tree_cursor result(this, n.m_node);
+        for (auto it = path.rbegin(); it != path.rend(); ++it)
+        {
+            result.m_level_begin.push_back(result.m_left_siblings.size());
+            for (private_node* aux = (*it)->m_parent->m_left_child; aux != *it; aux = aux->m_right_sibling)
+                result.m_left_siblings.push_back(aux);
+        }
+
+        return result;
+    }
+
+    /**
+     * @brief Policy selecting the multithreaded overloads.
+     * @details thread_count includes the calling thread; 0 means std::thread::hardware_concurrency().
+     */
+    struct parallel_policy
+    {
+        std::size_t thread_count = 0;
+    };
+
+    static constexpr parallel_policy par{};
+
+    general_tree() noexcept : m_root(nullptr), m_size(0) {}
+
+    general_tree(general_tree<T>&& rhs) noexcept
+        : m_root(std::exchange(rhs.m_root, nullptr)), m_size(std::exchange(rhs.m_size, 0))
+    {
+    }
+
+    general_tree(const general_tree<T>& other) : general_tree<T>()
+    {
+        deep_copy(other.root());
+    }
+
+    /**
+     * @brief Copies the given tree, copying independent subtrees concurrently.
+     * @details The result is structurally identical to the one of the copy constructor. T's copy constructor must be
+     * safe to call from several threads at once.
+     * @param other The tree to copy.
+     * @param policy The number of threads to use.
+     * @throws Rethrows the first exception thrown by a copy constructor; no node is leaked.
+     */
+    general_tree(const general_tree<T>& other, parallel_policy policy) : general_tree<T>()
+    {
+        parallel_deep_copy(other.m_root, resolve_thread_count(policy.thread_count));
+        m_size = other.m_size;
+    }
+
+    template <typename U, typename = std::enable_if_t<std::is_convertible_v<U, T>>>
+    general_tree(U&& root_value) : general_tree()
+    {
+        m_root = new private_node(std::forward<U>(root_value));
+        m_size = 1;
+    }
+
+    general_tree& operator=(const general_tree<T>& other)
+    {
+        if (this != &other)
+        {
+            clear();
+            deep_copy(other.root());
+        }
+        return *this;
+    }
+
+    general_tree& operator=(general_tree&& other) noexcept
+    {
+        if (this != &other)
+        {
+            clear();
+            m_root = std::exchange(other.m_root, nullptr);
+            m_size = std::exchange(other.m_size, 0);
+        }
+        return *this;
+    }
+
+    bool operator==(const general_tree<T>& other) const
+    {
+        if (m_root == other.m_root)
+            return true;
+
+        if (m_root == nullptr || other.m_root == nullptr)
+            return false;
+
+        // cheap rejection before any value is compared
+        if (m_size != other.m_size)
+            return false;
+
+        // Both trees are walked in preorder in lockstep. While the shapes match, the same step is taken in both
+        // trees, so no auxiliary storage is needed.
+        const private_node* tree1_node = m_root;
+        const private_node* tree2_node = other.m_root;
+        while (tree1_node != nullptr)
+        {
+            if (tree1_node->m_data != tree2_node->m_data)
+                return false;
+
+            if ((tree1_node->m_left_child == nullptr) != (tree2_node->m_left_child == nullptr) ||
+                (tree1_node->m_right_sibling == nullptr) != (tree2_node->m_right_sibling == nullptr))
+                return false;
+
+            if (tree1_node->m_left_child != nullptr)
+            {
+                tree1_node = tree1_node->m_left_child;
+                tree2_node = tree2_node->m_left_child;
+                continue;
+            }
+
+            while (tree1_node != nullptr && tree1_node->m_right_sibling == nullptr)
+            {
+                tree1_node = tree1_node->m_parent;
+                tree2_node = tree2_node->m_parent;
+            }
+
+            if (tree1_node != nullptr)
+            {
+                tree1_node = tree1_node->m_right_sibling;
+                tree2_node = tree2_node->m_right_sibling;
+            }
+        }
+
+        return true;
+    }
+
+    /**
+     * @brief Compares the trees structurally, comparing independent subtrees concurrently.
+     * @details Trees of different sizes are rejected before any value is compared. The first mismatch found by any
+     * worker cancels the others. T's operator!= must be safe to call from several threads at once.
+     * @param other The tree to compare with.
+     * @param policy The number of threads to use.
+     * @return true if both trees have the same shape and equal values, false otherwise.
+     */
+    [[nodiscard]] bool equals(const general_tree<T>& other, parallel_policy policy) const
+    {
+        if (m_root == other.m_root)
+            return true;
+
+        if (m_root == nullptr || other.m_root == nullptr || m_size != other.m_size)
+            return false;
+
+        if (m_root->m_data != other.m_root->m_data)
+            return false;
+
+        // pairs of equal nodes whose children still need to be compared
+        using task_type = std::pair<const private_node*, const private_node*>;
+        using pool_type = work_stealing_pool<task_type>;
+        std::atomic<bool> mismatch = false;
+
+        auto expand = [&mismatch](task_type& task, std::vector<task_type>& stack, typename pool_type::context& ctx) {
+            const private_node* tree1_child = task.first->m_left_child;
+            const private_node* tree2_child = task.second->m_left_child;
+            while (tree1_child != nullptr && tree2_child != nullptr)
+            {
+                if (tree1_child->m_data != tree2_child->m_data)
+                    break;
+
+                stack.push_back({tree1_child, tree2_child});
+                tree1_child = tree1_child->m_right_sibling;
+                tree2_child = tree2_child->m_right_sibling;
+            }
+
+            // different value or a node contains more children than the other
+            if (tree1_child != nullptr || tree2_child != nullptr)
+            {
+                mismatch.store(true, std::memory_order_relaxed);
+                ctx.cancel();
+            }
+        };
+        auto body = [&expand](task_type& task, typename pool_type::context& ctx) {
+            parallel_subtree_walk(task, ctx, expand);
+        };
+
+        pool_type pool(resolve_thread_count(policy.thread_count));
+        pool.run({{m_root, other.m_root}}, body);
+        return !mismatch.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Returns a copy of the tree, copying independent subtrees concurrently.
+     * @param policy The number of threads to use.
+     * @throws Rethrows the first exception thrown by a copy constructor; no node is leaked.
+     */
+    [[nodiscard]] general_tree copy(parallel_policy policy) const
+    {
+        return general_tree(*this, policy);
+    }
+
+    /**
+     * @brief Builds a tree with the same shape whose values are the result of applying fn to the values of this one.
+     * @tparam U The value type of the new tree.
+     * @param fn Callable taking a const T& and returning a value U can be constructed from. The nodes of the new
+     * tree are constructed directly from its result.
+     * @throws Rethrows the exception thrown by fn or by a constructor of U; no node is leaked.
+     */
+    template <typename U, typename Function>
+    [[nodiscard]] general_tree<U> transform(Function fn) const
+    {
+        general_tree<U> result;
+        result.build_isomorphic(m_root, fn);
+        return result;
+    }
+
+    /**
+     * @brief Builds a tree with the same shape whose values are the result of applying fn to the values of this one,
+     * transforming independent subtrees concurrently.
+     * @tparam U The value type of the new tree.
+     * @param fn Thread-safe callable taking a const T& and returning a value U can be constructed from.
+     * @param policy The number of threads to use.
+     * @throws Rethrows the first exception thrown by fn or by a constructor of U; no node is leaked.
+     */
+    template <typename U, typename Function>
+    [[nodiscard]] general_tree<U> transform(Function fn, parallel_policy policy) const
+    {
+        general_tree<U> result;
+        result.parallel_build_isomorphic(m_root, resolve_thread_count(policy.thread_count), fn);
+        result.m_size = m_size;
+        return result;
+    }
+
+    /**
+     * @brief Calls fn on the value of every node, in preorder.
+     * @param fn Callable taking a T&.
+     */
+    template <typename Function>
+    void for_each_value(Function fn)
+    {
+        for (T& value : *this)
+            fn(value);
+    }
+
+    /**
+     * @brief Calls fn on the value of every node, processing independent subtrees concurrently.
+     * @details The order in which values are visited is unspecified.
+     * @param fn Thread-safe callable taking a T&.
+     * @param policy The number of threads to use.
+     * @throws Rethrows the first exception thrown by fn, once every worker has stopped.
+     */
+    template <typename Function>
+    void for_each_value(Function fn, parallel_policy policy)
+    {
+        if (m_root == nullptr)
+            return;
+
+        auto visit = [&fn](private_node* current, auto&) { fn(current->m_data); };
+        parallel_visit(m_root, resolve_thread_count(policy.thread_count), visit);
+    }
+
+    /**
+     * @brief Creates and emplaces the root node of the tree with the given arguments.
+     * @tparam Args Variadic template parameters representing the types of arguments to be forwarded to the root node
+     * constructor.
+     * @param args Arguments to forward to the root node constructor.
+     * @return node A handle to the newly created root node.
+     * @throws std::runtime_error If a root node already exists.
+     */
+    template <typename... Args>
+    node emplace_root(Args&&... args)
+    {
+        if (m_root != nullptr)
+            throw std::runtime_error("Root already exists");
+        m_root = new private_node(std::forward<Args>(args)...);
+        m_size = 1;
+        return m_root;
+    }
+
+    /**
+     * @brief Creates the root node of the tree
+     * @param data The value to store in the root node.
+     * @return node A handle to the newly created root node.
+     * @throws std::runtime_error If a root node already exists.
+     */
+    template <typename U, typename = std::enable_if_t<std::is_convertible_v<U, T>>>
+    node create_root(U&& data)
+    {
+        return emplace_root(std::forward<U>(data));
+    }
+
+    /**
+     * @brief Creates and emplaces a new left child node for the given destination node.
+     * @tparam Args Variadic template parameters for the new node constructor.
+     * @param destiny The node to which the new left child will be attached.
+     * @param args Arguments to forward to the new node's constructor.
+     * @return node A handle to the newly created left child node.
+     * @throws std::invalid_argument If the destination node is null.
+     */
+    template <typename... Args>
+    node emplace_left_child(node destiny, Args&&... args)
+    {
+        if (destiny.m_node == nullptr)
+            throw std::invalid_argument("Cannot insert left child to null node");
+
+        private_node* new_node = new private_node(std::forward<Args>(args)...);
+        new_node->m_right_sibling = destiny.m_node->m_left_child;
+        new_node->m_parent = destiny.m_node;
+
+        destiny.m_node->m_left_child = new_node;
+        ++m_size;
+        return new_node;
+    }
+
+    /**
+     * @brief Inserts a new left child node for the given destination node, with the provided value.
+     * @param destiny The node to which the left child will be inserted.
+     * @param new_node_value The value to store in the newly created left child node.
+     * @return node A handle to the newly created left child node.
+     * @throws std::invalid_argument If the destination node is null.
+     */
+    template <typename U, typename = std::enable_if_t<std::is_convertible_v<U, T>>>
+    node insert_left_child(node destiny, U&& new_node_value)
+    {
+        return emplace_left_child(destiny, std::forward<U>(new_node_value));
+    }
+
+    /**
+     * @brief Inserts an entire subtree as the left child of the given destination node.
+     * @param destiny The node to which the tree will be inserted as a left child.
+     * @param tree The tree to insert as a left child. After insertion, this tree will be empty.
+     * @return node A handle to the newly inserted left child node, or a null node if the tree is empty.
+     * @throws std::invalid_argument If the destination node is null or if attempting to insert the tree as a child of
+     * its own root.
+     */
+    node insert_left_child(node destiny, general_tree<T>& tree)
+    {
+        if (!destiny.m_node)
+            throw std::invalid_argument("Cannot insert left child to null node");
+
+        if (destiny.m_node == tree.m_root)
+            throw std::invalid_argument("Cannot insert a tree as its own child");
+
+        if (tree.m_root)
+        {
+            tree.m_root->m_parent = destiny.m_node;
+            tree.m_root->m_right_sibling = destiny.m_node->m_left_child;
+            destiny.m_node->m_left_child = tree.m_root;
+            tree.m_root = nullptr;
+            m_size += std::exchange(tree.m_size, 0);
+            return destiny.m_node->m_left_child;
+        }
+
+        return node(nullptr);
+    }
+
+    /**
+     * @brief Inserts an entire subtree as the right sibling of the given destination node.
+     * @param destiny The node to which the tree will be inserted as a right sibling.
+     * @param tree The tree to insert as a right sibling. After insertion, this tree will be empty.
+     * @return node A handle to the newly inserted right sibling node, or a null node if the tree is empty.
+     * @throws std::invalid_argument If the destination node is null, is the root (cannot have siblings),
+     *                               or if attempting to insert the tree as its own sibling.
+     */
+    node insert_right_sibling(node destiny, general_tree<T>& tree)
+    {
+        if (destiny.m_node == nullptr)
+            throw std::invalid_argument("Cannot insert right sibling to null node");
+
+        if (destiny.m_node->m_parent == nullptr)
+            throw std::invalid_argument("Cannot insert right sibling to root");
+
+        if (destiny.m_node == tree.m_root)
+            throw std::invalid_argument("Cannot insert a tree as its own sibling");
+
+        if (tree.m_root)
+        {
+            tree.m_root->m_parent = destiny.m_node->m_parent;
+            tree.m_root->m_right_sibling = destiny.m_node->m_right_sibling;
+            destiny.m_node->m_right_sibling = tree.m_root;
+            tree.m_root = nullptr;
+            m_size += std::exchange(tree.m_size, 0);
+            return destiny.m_node->m_right_sibling;
+        }
+
+        return node(nullptr);
+    }
+
+    /**
+     * @brief Creates and emplaces a new right sibling for the given destination node.
+     * @tparam Args Variadic template parameters for the new node constructor.
+     * @param destiny The node to which the new right sibling will be attached.
+     * @param args Arguments to forward to the new node's constructor.
+     * @return node A handle to the newly created right sibling node.
+     * @throws std::invalid_argument If the destination node is null or is the root (cannot have a sibling).
+     */
+    template <typename... Args>
+    node emplace_right_sibling(node destiny, Args&&... args)
+    {
+        if (destiny.m_node == nullptr)
+            throw std::invalid_argument("Cannot insert right sibling to null node");
+
+        if (destiny.m_node->m_parent == nullptr)
+            throw std::invalid_argument("Cannot insert right sibling to root");
+
+        private_node* new_node = new private_node(std::forward<Args>(args)...);
+        new_node->m_parent = destiny.m_node->m_parent;
+        new_node->m_right_sibling = destiny.m_node->m_right_sibling;
+        destiny.m_node->m_right_sibling = new_node;
+        ++m_size;
+        return new_node;
+    }
+
+    /**
+     * @brief Inserts a new right sibling node for the given destination node, with the provided value.
+     * @param destiny The node to which the right sibling will be inserted.
+     * @param new_node_value The value to store in the newly created right sibling node.
+     * @return node A handle to the newly created right sibling node.
+     * @throws std::invalid_argument If the destination node is null or is the root (cannot have a sibling).
+     */
+    template <typename U, typename = std::enable_if_t<std::is_convertible_v<U, T>>>
+    node insert_right_sibling(node destiny, U&& new_node_value)
+    {
+        return emplace_right_sibling(destiny, std::forward<U>(new_node_value));
+    }
+
+    /**
+     * @brief Returns the root node of the tree.
+     */
+    [[nodiscard]] node root() const noexcept
+    {
+        return m_root;
+    }
+
+    /**
+     * @brief Returns the number of nodes in the tree, in O(1).
+     */
+    [[nodiscard]] std::size_t size() const noexcept
+    {
+        return m_size;
+    }
+
+    /**
+     * @brief Checks whether the tree is empty.
+     */
+    bool empty() const noexcept
+    {
+        return m_root == nullptr;
+    }
+
+    /**
+     * @brief Clears all nodes from the tree.
+     */
+    void clear()
+    {
+        delete_from_node(m_root);
+        m_root = nullptr;
+        m_size = 0;
+    }
+
+    /**
+     * @brief Clears all nodes from the tree, freeing independent subtrees concurrently.
+     * @param policy The number of threads to use.
+     */
+    void clear(parallel_policy policy)
+    {
+        private_node* root = std::exchange(m_root, nullptr);
+        m_size = 0;
+        if (root == nullptr)
+            return;
+
+        // the children are read before the node is deleted
+        auto visit = [](private_node* current, auto&) { delete current; };
+        parallel_visit(root, resolve_thread_count(policy.thread_count), visit);
+    }
+
+    /**
+     * @brief Clears the tree in O(1) and frees its nodes asynchronously on a background thread.
+     * @details The tree is empty and reusable as soon as the call returns. The destructor of T must be safe to run on
+     * another thread. Use wait_for_background_reclaim() to wait until the memory has been released.
+     */
+    void clear_in_background()
+    {
+        private_node* root = std::exchange(m_root, nullptr);
+        m_size = 0;
+        if (root != nullptr)
+            background_reclaimer::instance().enqueue(root);
+    }
+
+    /**
+     * @brief Blocks until every tree of this type cleared with clear_in_background() has been freed.
+     */
+    static void wait_for_background_reclaim()
+    {
+        background_reclaimer::instance().wait_idle();
+    }
+
+    /**
+     * @brief Handle that frees a detached tree a bounded amount of work at a time.
+     * @details Nodes are freed with link rotations on the detached nodes themselves, so no auxiliary memory is used.
+     * Every freed node and every rotation counts as one unit of work; each step() performs at most the node budget
+     * in units and/or stops once the time budget has elapsed (checked every few units), so its pause is bounded. The
+     * remaining nodes are freed by the destructor.
+     */
+    class incremental_clear
+    {
+    private:
+        friend class general_tree;
+
+        private_node* m_pending;
+        std::size_t m_remaining;
+        std::size_t m_budget;
+        std::chrono::steady_clock::duration m_time_budget;
+
+        static constexpr std::size_t clock_check_interval = 64;
+
+        incremental_clear(
+            private_node* root, std::size_t size, std::size_t budget, std::chrono::steady_clock::duration time_budget
+        ) noexcept
+            : m_pending(root), m_remaining(size), m_budget(budget), m_time_budget(time_budget)
+        {
+        }
+
+        // - performs one unit of work
+        // - returns true if a node was freed
+        bool work_unit() noexcept
+        {
+            // left = first child, right = next sibling; rotate until the current node has no child, then free it
+            private_node* current = m_pending;
+            private_node* child = current->m_left_child;
+            if (child != nullptr)
+            {
+                current->m_left_child = child->m_right_sibling;
+                child->m_right_sibling = current;
+                m_pending = child;
+                return false;
+            }
+
+            m_pending = current->m_right_sibling;
+            delete current;
+            --m_remaining;
+            return true;
+        }
+
+    public:
+        incremental_clear(incremental_clear&& other) noexcept
+            : m_pending(std::exchange(other.m_pending, nullptr)), m_remaining(std::exchange(other.m_remaining, 0)),
+              m_budget(other.m_budget), m_time_budget(other.m_time_budget)
+        {
+        }
+
+        incremental_clear& operator=(incremental_clear&& other) noexcept
+        {
+            if (this != &other)
+            {
+                finish();
+                m_pending = std::exchange(other.m_pending, nullptr);
+                m_remaining = std::exchange(other.m_remaining, 0);
+                m_budget = other.m_budget;
+                m_time_budget = other.m_time_budget;
+            }
+            return *this;
+        }
+
+        ~incremental_clear()
+        {
+            finish();
+        }
+
+        /**
+         * @brief Frees nodes until the node or time budget is exhausted.
+         * @return The number of nodes freed by this call.
+         */
+        std::size_t step() noexcept
+        {
+            const auto deadline = std::chrono::steady_clock::now() + m_time_budget;
+            const bool timed = m_time_budget != std::chrono::steady_clock::duration::zero();
+
+            std::size_t freed = 0;
+            for (std::size_t units = 0; m_pending != nullptr && units < m_budget; units++)
+            {
+                if (work_unit())
+                    ++freed;
+
+                if (timed && units % clock_check_interval == clock_check_interval - 1 &&
+                    std::chrono::steady_clock::now() >= deadline)
+                    break;
+            }
+            return freed;
+        }
+
+        /**
+         * @brief Frees every remaining node at once.
+         */
+        void finish() noexcept
+        {
+            while (m_pending != nullptr)
+                work_unit();
+        }
+
+        /**
+         * @brief Checks whether every node has been freed.
+         */
+        [[nodiscard]] bool done() const noexcept
+        {
+            return m_pending == nullptr;
+        }
+
+        /**
+         * @brief Returns the number of nodes not freed yet.
+         */
+        [[nodiscard]] std::size_t remaining() const noexcept
+        {
+            return m_remaining;
+        }
+    };
+
+    /**
+     * @brief Clears the tree in O(1) and returns a handle that frees the nodes incrementally.
+     * @param budget The maximum units of work (freed nodes or rotations) performed by each step().
+     * @return incremental_clear The handle owning the detached nodes.
+     * @throws std::invalid_argument If the budget is zero.
+     */
+    [[nodiscard]] incremental_clear clear_incremental(std::size_t budget)
+    {
+        if (budget == 0)
+            throw std::invalid_argument("Budget must be greater than zero");
+
+        incremental_clear handle(m_root, m_size, budget, std::chrono::steady_clock::duration::zero());
+        m_root = nullptr;
+        m_size = 0;
+        return handle;
+    }
+
+    /**
+     * @brief Clears the tree in O(1) and returns a handle whose step() frees nodes for at most the given duration.
+     * @param time_budget The time each step() may spend freeing nodes.
+     * @return incremental_clear The handle owning the detached nodes.
+     * @throws std::invalid_argument If the time budget is not positive.
+     */
+    template <typename Rep, typename Period>
+    [[nodiscard]] incremental_clear clear_incremental(std::chrono::duration<Rep, Period> time_budget)
+    {
+        const auto budget = std::chrono::duration_cast<std::chrono::steady_clock::duration>(time_budget);
+        if (budget <= std::chrono::steady_clock::duration::zero())
+            throw std::invalid_argument("Time budget must be positive");
+
+        incremental_clear handle(m_root, m_size, std::numeric_limits<std::size_t>::max(), budget);
+        m_root = nullptr;
+        m_size = 0;
+        return handle;
+    }
+
+    void delete_right_sibling(node n)
+    {
+        if (n.is_null())
+            throw std::invalid_argument("Can not delete right sibling of null node");
+
+        if (n.is_root())
+            throw std::invalid_argument("Can not delete right sibling of root node");
+
+        // the predecessor is known, no need to walk the sibling list
+        private_node* target = n.m_node->m_right_sibling;
+        if (target != nullptr)
+        {
+            n.m_node->m_right_sibling = target->m_right_sibling;
+            destroy_subtree(target);
+        }
+    }
+
+    void delete_left_child(node n)
+    {
+        if (n.is_null())
+            throw std::invalid_argument("Can not delete left child of null node");
+
+        delete_from_node(n.m_node->m_left_child);
+    }
+
+    /**
+     * @brief Records insertions and deletions and applies them to the tree at once.
+     * @details Arguments are validated and new nodes are constructed while recording, so commit() only relinks nodes
+     * and cannot fail: either every operation is applied or, if the batch is destroyed first, none is. Consecutive
+     * insertions under the same parent, or that extend the same run of siblings, are linked to each other while
+     * recording and spliced into the tree with a single link update. Operations are applied in the order they were
+     * recorded; handles returned by the batch can be used by later operations of the same batch. The tree must not be
+     * modified through other means while a batch is pending.
+     */
+    class mutation_batch
+    {
+    private:
+        friend class general_tree;
+
+        enum class operation_type
+        {
+            link_left_children,
+            link_right_siblings,
+            delete_left_child,
+            delete_right_sibling
+        };
+
+        struct operation
+        {
+            operation_type m_type;
+            private_node* m_target;
+            // chain of new nodes linked through m_right_sibling, for insertions
+            private_node* m_first;
+            private_node* m_last;
+        };
+
+        general_tree* m_tree;
+        std::vector<operation> m_operations;
+        std::size_t m_inserted = 0;
+
+        explicit mutation_batch(general_tree* tree) noexcept : m_tree(tree) {}
+
+        // - frees the nodes of pending insertions
+        void discard() noexcept
+        {
+            for (const operation& op : m_operations)
+            {
+                if (op.m_type != operation_type::link_left_children && op.m_type != operation_type::link_right_siblings)
+                    continue;
+                for (private_node* pnode = op.m_first; pnode != nullptr;)
+                    delete std::exchange(pnode, pnode->m_right_sibling);
+            }
+            m_operations.clear();
+            m_inserted = 0;
+        }
+
+        // - room for one more operation, so recording a new node cannot throw after it was constructed
+        void reserve_operation()
+        {
+            if (m_operations.size() == m_operations.capacity())
+                m_operations.reserve(2 * m_operations.size() + 1);
+        }
+
+        void record_insertion(operation_type type, private_node* target, private_node* new_node)
+        {
+            if (!m_operations.empty())
+            {
+                operation& last = m_operations.back();
+                const bool is_insertion =
+                    last.m_type == operation_type::link_left_children || last.m_type == operation_type::link_right_siblings;
+
+                // same position as the previous insertion: the new node goes in front of its chain
+                if (last.m_type == type && last.m_target == target)
+                {
+                    new_node->m_right_sibling = last.m_first;
+                    last.m_first = new_node;
+                    ++m_inserted;
+                    return;
+                }
+
+                // right after the last node of the previous chain: the chain grows at the end
+                if (is_insertion && type == operation_type::link_right_siblings && target == last.m_last)
+                {
+                    last.m_last->m_right_sibling = new_node;
+                    last.m_last = new_node;
+                    ++m_inserted;
+                    return;
+                }
+            }
+
+            m_operations.push_back({type, target, new_node, new_node});
+            ++m_inserted;
+        }
+
+    public:
+        mutation_batch(mutation_batch&& other) noexcept
+            : m_tree(other.m_tree), m_operations(std::move(other.m_operations)),
+              m_inserted(std::exchange(other.m_inserted, 0))
+        {
+            other.m_operations.clear();
+        }
+
+        mutation_batch(const mutation_batch&) = delete;
+        mutation_batch& operator=(const mutation_batch&) = delete;
+        mutation_batch& operator=(mutation_batch&&) = delete;
+
+        /**
+         * @brief Discards the operations that were not committed.
+         */
+        ~mutation_batch()
+        {
+            discard();
+        }
+
+        /**
+         * @brief Records the insertion of a new left child for the given node.
+         * @return node A handle to the new node, which is linked to the tree on commit().
+         * @throws std::invalid_argument If the destination node is null.
+         */
+        template <typename... Args>
+        node emplace_left_child(node destiny, Args&&... args)
+        {
+            if (destiny.m_node == nullptr)
+                throw std::invalid_argument("Cannot insert left child to null node");
+
+            reserve_operation();
+            private_node* new_node = new private_node(std::forward<Args>(args)...);
+            new_node->m_parent = destiny.m_node;
+            record_insertion(operation_type::link_left_children, destiny.m_node, new_node);
+            return new_node;
+        }
+
+        /**
+         * @brief Records the insertion of a new right sibling for the given node.
+         * @return node A handle to the new node, which is linked to the tree on commit().
+         * @throws std::invalid_argument If the destination node is null or is the root.
+         */
+        template <typename... Args>
+        node emplace_right_sibling(node destiny, Args&&... args)
+        {
+            if (destiny.m_node == nullptr)
+                throw std::invalid_argument("Cannot insert right sibling to null node");
+
+            if (destiny.m_node->m_parent == nullptr)
+                throw std::invalid_argument("Cannot insert right sibling to root");
+
+            reserve_operation();
+            private_node* new_node = new private_node(std::forward<Args>(args)...);
+            new_node->m_parent = destiny.m_node->m_parent;
+            record_insertion(operation_type::link_right_siblings, destiny.m_node, new_node);
+            return new_node;
+        }
+
+        /**
+         * @brief Records the deletion of the left child of the given node, as it will be when the operation applies.
+         * @throws std::invalid_argument If the node is null.
+         */
+        void delete_left_child(node n)
+        {
+            if (n.is_null())
+                throw std::invalid_argument("Can not delete left child of null node");
+
+            m_operations.push_back({operation_type::delete_left_child, n.m_node, nullptr, nullptr});
+        }
+
+        /**
+         * @brief Records the deletion of the right sibling of the given node, as it will be when the operation applies.
+         * @throws std::invalid_argument If the node is null or is the root.
+         */
+        void delete_right_sibling(node n)
+        {
+            if (n.is_null())
+                throw std::invalid_argument("Can not delete right sibling of null node");
+
+            if (n.is_root())
+                throw std::invalid_argument("Can not delete right sibling of root node");
+
+            m_operations.push_back({operation_type::delete_right_sibling, n.m_node, nullptr, nullptr});
+        }
+
+        /**
+         * @brief Returns the number of recorded operations after consecutive insertions were merged.
+         */
+        [[nodiscard]] std::size_t pending_operations() const noexcept
+        {
+            return m_operations.size();
+        }
+
+        /**
+         * @brief Applies every recorded operation to the tree, in order. The batch is left empty and reusable.
+         */
+        void commit() noexcept
+        {
+            m_tree->m_size += std::exchange(m_inserted, 0);
+
+            for (const operation& op : m_operations)
+            {
+                switch (op.m_type)
+                {
+                case operation_type::link_left_children:
+                    op.m_last->m_right_sibling = op.m_target->m_left_child;
+                    op.m_target->m_left_child = op.m_first;
+                    break;
+                case operation_type::link_right_siblings:
+                    op.m_last->m_right_sibling = op.m_target->m_right_sibling;
+                    op.m_target->m_right_sibling = op.m_first;
+                    break;
+                case operation_type::delete_left_child:
+                    if (private_node* target = op.m_target->m_left_child; target != nullptr)
+                    {
+                        op.m_target->m_left_child = target->m_right_sibling;
+                        m_tree->destroy_subtree(target);
+                    }
+                    break;
+                case operation_type::delete_right_sibling:
+                    if (private_node* target = op.m_target->m_right_sibling; target != nullptr)
+                    {
+                        op.m_target->m_right_sibling = target->m_right_sibling;
+                        m_tree->destroy_subtree(target);
+                    }
+                    break;
+                }
+            }
+
+            m_operations.clear();
+        }
+    };
+
+    /**
+     * @brief Returns an empty batch of operations on this tree.
+     */
+    [[nodiscard]] mutation_batch batch() noexcept
+    {
+        return mutation_batch(this);
+    }
+
+    /**
+     * @brief Visits the subtree rooted at the given node in a single depth-first pass.
+     * @details visitor.on_enter(node) is called before the children of a node are visited and visitor.on_leave(node)
+     * after them. Both callbacks are optional and resolved at compile time. If on_enter returns a value convertible to
+     * bool, returning false skips the children of that node (on_leave is still called). The walk follows the parent
+     * links, so no auxiliary storage is allocated. The visitor must not modify the structure of the tree.
+     * @tparam Visitor Type providing on_enter and/or on_leave.
+     * @param start The root of the subtree to visit. Its right siblings are not visited.
+     * @param visitor The object receiving the callbacks.
+     * @throws std::invalid_argument If the start node is null.
+     */
+    template <typename Visitor>
+    void visit(node start, Visitor&& visitor) const
+    {
+        if (start.m_node == nullptr)
+            throw std::invalid_argument("Cannot visit null node");
+
+        private_node* current = start.m_node;
+        while (true)
+        {
+            if (dispatch_on_enter(visitor, current) && current->m_left_child != nullptr)
+            {
+                current = current->m_left_child;
+                continue;
+            }
+
+            // the subtree of current is done, it goes up until it finds a right sibling or the start node
+            while (true)
+            {
+                dispatch_on_leave(visitor, current);
+                if (current == start.m_node)
+                    return;
+                if (current->m_right_sibling != nullptr)
+                {
+                    current = current->m_right_sibling;
+                    break;
+                }
+                current = current->m_parent;
+            }
+        }
+    }
+
+    /**
+     * @brief Calls fn on every node of the subtree rooted at the given node, using several threads.
+     * @details The subtree is split at subtree boundaries and balanced across the workers by work stealing: a worker
+     * hands part of its pending subtrees over whenever another one runs out of work. The order in which nodes are
+     * visited is unspecified. fn may modify the data of the nodes but not the structure of the tree.
+     * @param start The root of the subtree.
+     * @param fn Thread-safe callable taking a node.
+     * @param thread_count The number of threads to use, including the calling thread. 0 means
+     * std::thread::hardware_concurrency().
+     * @throws std::invalid_argument If the start node is null.
+     * @throws Rethrows the first exception thrown by fn, once every worker has stopped.
+     */
+    template <typename Function>
+    void parallel_for_each(node start, Function fn, std::size_t thread_count = 0) const
+    {
+        if (start.m_node == nullptr)
+            throw std::invalid_argument("Cannot iterate from null node");
+
+        auto visit = [&fn](private_node* current, auto&) { fn(node(current)); };
+        parallel_visit(start.m_node, resolve_thread_count(thread_count), visit);
+    }
+
+    /**
+     * @brief Maps every node of the subtree rooted at the given node and combines the results, using several threads.
+     * @details Each worker accumulates its own partial result starting from identity; the partial results are combined
+     * at the end. reduce must therefore be associative and commutative, and identity must be its identity element.
+     * @param start The root of the subtree.
+     * @param identity The identity element of reduce.
+     * @param map Thread-safe callable taking a node and returning a value convertible to R.
+     * @param reduce Callable combining two R values.
+     * @param thread_count The number of threads to use, including the calling thread. 0 means
+     * std::thread::hardware_concurrency().
+     * @return The combination of the mapped values of every node.
+     * @throws std::invalid_argument If the start node is null.
+     * @throws Rethrows the first exception thrown by map or reduce, once every worker has stopped.
+     */
+    template <typename R, typename Map, typename Reduce>
+    [[nodiscard]] R parallel_reduce(node start, R identity, Map map, Reduce reduce, std::size_t thread_count = 0) const
+    {
+        if (start.m_node == nullptr)
+            throw std::invalid_argument("Cannot reduce from null node");
+
+        // padded to avoid false sharing between workers
+        struct alignas(64) partial_result
+        {
+            R m_value;
+        };
+
+        const std::size_t workers = resolve_thread_count(thread_count);
+        std::vector<partial_result> partials(workers, partial_result{identity});
+
+        auto visit = [&](private_node* current, auto& ctx) {
+            R& partial = partials[ctx.worker()].m_value;
+            partial = reduce(std::move(partial), map(node(current)));
+        };
+        parallel_visit(start.m_node, workers, visit);
+
+        R result = std::move(identity);
+        for (partial_result& partial : partials)
+            result = reduce(std::move(result), std::move(partial.m_value));
+        return result;
+    }
+
+    /**
+     * @brief Calls fn on every node of the subtree rooted at the given node, level by level, using several threads.
+     * @details Every node at depth d is processed before any node at depth d + 1, so a node can read the results
+     * stored by fn in its parent. The nodes of a level are processed concurrently in an unspecified order. Levels
+     * narrower than a few hundred nodes are processed by a single thread, where a barrier would cost more than the
+     * work, so deep and narrow trees never pay for synchronization. fn may modify the data of the nodes but not the
+     * structure of the tree.
+     * @param start The root of the subtree. Its depth is 0.
+     * @param fn Thread-safe callable taking a node, or a node and its depth relative to start.
+     * @param thread_count The number of threads to use, including the calling thread. 0 means
+     * std::thread::hardware_concurrency().
+     * @throws std::invalid_argument If the start node is null.
+     * @throws Rethrows the first exception thrown by fn, once every worker has stopped.
+     */
+    template <typename Function>
+    void parallel_level_order(node start, Function fn, std::size_t thread_count = 0) const
+    {
+        if (start.m_node == nullptr)
+            throw std::invalid_argument("Cannot traverse null node");
+
+        auto process = [&fn](private_node* current, std::size_t depth, std::vector<private_node*>& next_level) {
+            if constexpr (std::invocable<Function&, node, std::size_t>)
+                fn(node(current), depth);
+            else
+                fn(node(current));
+
+            for (private_node* child = current->m_left_child; child != nullptr; child = child->m_right_sibling)
+                next_level.push_back(child);
+        };
+
+        const std::size_t workers = resolve_thread_count(thread_count);
+        const std::size_t parallel_cutoff = 64 * workers;
+
+        // frontiers are swapped after every level, so the buffers keep their capacity
+        std::vector<private_node*> current_level = {start.m_node};
+        std::vector<private_node*> next_level;
+        std::size_t depth = 0;
+
+        auto process_serially = [&]() {
+            for (private_node* current : current_level)
+                process(current, depth, next_level);
+            current_level.swap(next_level);
+            next_level.clear();
+            ++depth;
+        };
+
+        while (!current_level.empty() && (workers == 1 || current_level.size() < parallel_cutoff))
+            process_serially();
+
+        if (current_level.empty())
+            return;
+
+        // children found by each worker in the current level
+        std::vector<std::vector<private_node*>> local_next(workers);
+        std::atomic<std::size_t> cursor = 0;
+        std::atomic<bool> cancelled = false;
+        std::mutex exception_mutex;
+        std::exception_ptr exception;
+        std::size_t chunk = 0;
+        bool done = false;
+
+        auto record_exception = [&]() noexcept {
+            std::lock_guard<std::mutex> lock(exception_mutex);
+            if (!exception)
+                exception = std::current_exception();
+            cancelled.store(true, std::memory_order_relaxed);
+        };
+
+        auto prepare_level = [&]() noexcept {
+            cursor.store(0, std::memory_order_relaxed);
+            chunk = std::max<std::size_t>(16, current_level.size() / (workers * 8));
+        };
+
+        // runs on a single thread once every worker finished the level
+        auto on_level_done = [&]() noexcept {
+            std::size_t total = 0;
+            for (const std::vector<private_node*>& local : local_next)
+                total += local.size();
+
+            try
+            {
+                next_level.reserve(total);
+                for (std::vector<private_node*>& local : local_next)
+                {
+                    next_level.insert(next_level.end(), local.begin(), local.end());
+                    local.clear();
+                }
+                current_level.swap(next_level);
+                next_level.clear();
+                ++depth;
+
+                while (!current_level.empty() && current_level.size() < parallel_cutoff &&
+                       !cancelled.load(std::memory_order_relaxed))
+                    process_serially();
+            }
+            catch (...)
+            {
+                record_exception();
+            }
+
+            done = current_level.empty() || cancelled.load(std::memory_order_relaxed);
+            prepare_level();
+        };
+
+        std::barrier sync(static_cast<std::ptrdiff_t>(workers), on_level_done);
+
+        auto worker_loop = [&](std::size_t worker) {
+            std::vector<private_node*>& local = local_next[worker];
+            while (true)
+            {
+                while (!cancelled.load(std::memory_order_relaxed))
+                {
+                    const std::size_t begin = cursor.fetch_add(chunk, std::memory_order_relaxed);
+                    if (begin >= current_level.size())
+                        break;
+
+                    const std::size_t end = std::min(begin + chunk, current_level.size());
+                    try
+                    {
+                        for (std::size_t i = begin; i < end; i++)
+                            process(current_level[i], depth, local);
+                    }
+                    catch (...)
+                    {
+                        record_exception();
+                    }
+                }
+
+                sync.arrive_and_wait();
+                if (done)
+                    return;
+            }
+        };
+
+        // the missing workers leave the barrier, the running ones process every level
+        auto drop_missing = [&sync](std::size_t missing) {
+            for (std::size_t i = 0; i < missing; i++)
+                sync.arrive_and_drop();
+        };
+
+        prepare_level();
+        worker_threads::instance().run(workers - 1, worker_loop, drop_missing);
+
+        if (exception)
+            std::rethrow_exception(exception);
+    }
+
+    /**
+     * @brief Binary output used by the serializer and by value codecs.
+     * @details Bytes go straight to the buffer of the stream, without the per-call overhead of the formatted stream
+     * interface. Integers are written as LEB128 varints.
+     */
+    class binary_writer
+    {
+    private:
+        std::ostream& m_stream;
+        std::streambuf* m_buffer;
+
+    public:
+        explicit binary_writer(std::ostream& stream) : m_stream(stream), m_buffer(stream.rdbuf()) {}
+
+        binary_writer(const binary_writer&) = delete;
+        binary_writer& operator=(const binary_writer&) = delete;
+
+        /**
+         * @brief Flushes the stream.
+         * @throws std::runtime_error If the stream fails.
+         */
+        void flush()
+        {
+            if (!m_stream.flush())
+                throw std::runtime_error("Failed to write to stream");
+        }
+
+        /**
+         * @throws std::runtime_error If the stream fails.
+         */
+        void write_bytes(const void* data, std::size_t size)
+        {
+            const auto count = static_cast<std::streamsize>(size);
+            if (m_buffer->sputn(static_cast<const char*>(data), count) != count)
+                throw std::runtime_error("Failed to write to stream");
+        }
+
+        /**
+         * @throws std::runtime_error If the stream fails.
+         */
+        void write_byte(std::uint8_t byte)
+        {
+            if (m_buffer->sputc(static_cast<char>(byte)) == std::char_traits<char>::eof())
+                throw std::runtime_error("Failed to write to stream");
+        }
+
+        /**
+         * @throws std::runtime_error If the stream fails.
+         */
+        void write_varint(std::uint64_t value)
+        {
+            while (value >= 0x80)
+            {
+                write_byte(static_cast<std::uint8_t>(value | 0x80));
+                value >>= 7;
+            }
+            write_byte(static_cast<std::uint8_t>(value));
+        }
+    };
+
+    /**
+     * @brief Binary input used by the deserializer and by value codecs.
+     * @details Bytes are taken straight from the buffer of the stream, so memory use is bounded by that buffer
+     * whatever the size of the input, and nothing past the last byte consumed is read: several trees can follow each
+     * other in the same stream.
+     */
+    class binary_reader
+    {
+    private:
+        std::streambuf* m_buffer;
+
+    public:
+        explicit binary_reader(std::istream& stream) : m_buffer(stream.rdbuf()) {}
+
+        binary_reader(const binary_reader&) = delete;
+        binary_reader& operator=(const binary_reader&) = delete;
+
+        /**
+         * @throws std::runtime_error If the stream ends before size bytes were read.
+         */
+        void read_bytes(void* data, std::size_t size)
+        {
+            const auto count = static_cast<std::streamsize>(size);
+            if (m_buffer->sgetn(static_cast<char*>(data), count) != count)
+                throw std::runtime_error("Unexpected end of stream");
+        }
+
+        /**
+         * @throws std::runtime_error If the stream ends.
+         */
+        std::uint8_t read_byte()
+        {
+            const auto byte = m_buffer->sbumpc();
+            if (byte == std::char_traits<char>::eof())
+                throw std::runtime_error("Unexpected end of stream");
+            return static_cast<std::uint8_t>(byte);
+        }
+
+        /**
+         * @throws std::runtime_error If the stream ends or the varint does not fit in 64 bits.
+         */
+        std::uint64_t read_varint()
+        {
+            std::uint64_t value = 0;
+            for (unsigned shift = 0; shift < 64; shift += 7)
+            {
+                const std::uint8_t byte = read_byte();
+                value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+                if ((byte & 0x80) == 0)
+                    return value;
+            }
+            throw std::runtime_error("Malformed varint");
+        }
+    };
+
+    /**
+     * @brief Value codec used when none is given to save() and load().
+     * @details Trivially copyable values are stored as their raw bytes (host byte order); std::string values as a
+     * varint length followed by their characters. Other types need a custom codec: any object providing
+     * encode(binary_writer&, const T&) and T decode(binary_reader&).
+     */
+    struct default_codec
+    {
+        void encode(binary_writer& writer, const T& value) const
+        {
+            if constexpr (std::is_same_v<T, std::string>)
+            {
+                writer.write_varint(value.size());
+                writer.write_bytes(value.data(), value.size());
+            }
+            else
+            {
+                static_assert(std::is_trivially_copyable_v<T>, "T needs a custom codec");
+                writer.write_bytes(std::addressof(value), sizeof(T));
+            }
+        }
+
+        T decode(binary_reader& reader) const
+        {
+            if constexpr (std::is_same_v<T, std::string>)
+            {
+                std::string value(reader.read_varint(), '\0');
+                reader.read_bytes(value.data(), value.size());
+                return value;
+            }
+            else
+            {
+                static_assert(std::is_trivially_copyable_v<T>, "T needs a custom codec");
+                T value;
+                reader.read_bytes(std::addressof(value), sizeof(T));
+                return value;
+            }
+        }
+    };
+
+private:
+    static constexpr char binary_magic[4] = {'G', 'T', 'R', 'B'};
+    static constexpr std::uint8_t binary_version = 1;
+
+    enum class shape_encoding : std::uint8_t
+    {
+        // every node is stored as its child count followed by its value, in preorder
+        child_counts = 0,
+        // the shape, then the values in preorder: one bit set when a node is entered, one clear when it is left
+        balanced_parentheses = 1,
+        // the shape, then the values in preorder: the preorder child counts as (count, run length) varint pairs
+        fanout_runs = 2
+    };
+
+    static void write_binary_header(binary_writer& writer, shape_encoding encoding, std::uint64_t size)
+    {
+        writer.write_bytes(binary_magic, sizeof(binary_magic));
+        writer.write_byte(binary_version);
+        writer.write_byte(static_cast<std::uint8_t>(encoding));
+        writer.write_varint(size);
+    }
+
+    // - returns the shape encoding, the size is stored in size
+    static shape_encoding read_binary_header(binary_reader& reader, std::uint64_t& size)
+    {
+        char magic[sizeof(binary_magic)];
+        reader.read_bytes(magic, sizeof(magic));
+        if (!std::equal(std::begin(magic), std::end(magic), std::begin(binary_magic)))
+            throw std::runtime_error("Not a general_tree binary stream");
+
+        if (reader.read_byte() != binary_version)
+            throw std::runtime_error("Unsupported general_tree binary version");
+
+        const std::uint8_t encoding = reader.read_byte();
+        if (encoding > static_cast<std::uint8_t>(shape_encoding::fanout_runs))
+            throw std::runtime_error("Unsupported general_tree shape encoding");
+
+        size = reader.read_varint();
+        return static_cast<shape_encoding>(encoding);
+    }
+
+    static std::size_t varint_size(std::uint64_t value) noexcept
+    {
+        std::size_t bytes = 1;
+        for (; value >= 0x80; value >>= 7)
+            ++bytes;
+        return bytes;
+    }
+
+    // - calls fn(count, run) for every maximal run of consecutive nodes in preorder with the same child count
+    template <typename Function>
+    void for_each_fanout_run(Function fn) const
+    {
+        std::uint64_t run_count = 0;
+        std::uint64_t run = 0;
+        for (const private_node* current = m_root; current != nullptr;)
+        {
+            std::uint64_t children = 0;
+            for (const private_node* child = current->m_left_child; child != nullptr; child = child->m_right_sibling)
+                ++children;
+            if (run != 0 && children != run_count)
+            {
+                fn(run_count, run);
+                run = 0;
+            }
+            run_count = children;
+            ++run;
+
+            if (current->m_left_child != nullptr)
+            {
+                current = current->m_left_child;
+                continue;
+            }
+
+            while (current != nullptr && current->m_right_sibling == nullptr)
+                current = current->m_parent;
+            if (current != nullptr)
+                current = current->m_right_sibling;
+        }
+        if (run != 0)
+            fn(run_count, run);
+    }
+
+    void write_balanced_parentheses(binary_writer& writer) const
+    {
+        std::uint8_t byte = 0;
+        unsigned used = 0;
+        auto push = [&](bool bit) {
+            byte |= static_cast<std::uint8_t>(bit) << used;
+            if (++used == 8)
+            {
+                writer.write_byte(byte);
+                byte = 0;
+                used = 0;
+            }
+        };
+
+        for (const private_node* current = m_root; current != nullptr;)
+        {
+            push(true);
+            if (current->m_left_child != nullptr)
+            {
+                current = current->m_left_child;
+                continue;
+            }
+
+            push(false);
+            while (current != nullptr && current->m_right_sibling == nullptr)
+            {
+                current = current->m_parent;
+                if (current != nullptr)
+                    push(false);
+            }
+            if (current != nullptr)
+                current = current->m_right_sibling;
+        }
+        if (used != 0)
+            writer.write_byte(byte);
+    }
+
+    // - reads the whole shape and checks it before any node is created, then decodes the values and links the nodes
+    //   in a single pass without walking the tree
+    template <typename Codec>
+    [[nodiscard]] static general_tree load_compact(
+        binary_reader& reader, shape_encoding encoding, std::uint64_t size, Codec& codec
+    )
+    {
+        general_tree result;
+        struct open_parent
+        {
+            private_node* m_node;
+            private_node* m_last_child;
+            std::uint64_t m_remaining;
+        };
+        std::vector<open_parent> parents;
+
+        auto append = [&](private_node* new_node) {
+            if (parents.empty())
+                result.m_root = new_node;
+            else
+            {
+                open_parent& parent = parents.back();
+                new_node->m_parent = parent.m_node;
+                if (parent.m_last_child == nullptr)
+                    parent.m_node->m_left_child = new_node;
+                else
+                    parent.m_last_child->m_right_sibling = new_node;
+                parent.m_last_child = new_node;
+            }
+            ++result.m_size;
+        };
+
+        if (encoding == shape_encoding::balanced_parentheses)
+        {
+            if (size > std::numeric_limits<std::uint64_t>::max() / 2)
+                throw std::runtime_error("Malformed general_tree binary stream");
+
+            // read in chunks, so a corrupted size fails on the end of the stream rather than on allocation
+            const std::uint64_t byte_count = (size * 2 + 7) / 8;
+            std::vector<std::uint8_t> bits;
+            while (bits.size() < byte_count)
+            {
+                const std::size_t offset = bits.size();
+                const auto chunk = static_cast<std::size_t>(std::min<std::uint64_t>(byte_count - offset, 1 << 16));
+                bits.resize(offset + chunk);
+                reader.read_bytes(bits.data() + offset, chunk);
+            }
+            auto bit = [&bits](std::uint64_t i) { return (bits[i / 8] >> (i % 8)) & 1; };
+
+            std::uint64_t depth = 0;
+            std::uint64_t opened = 0;
+            for (std::uint64_t i = 0; i < size * 2; i++)
+            {
+                if (bit(i) != 0)
+                {
+                    if (depth == 0 && opened != 0)
+                        throw std::runtime_error("Malformed general_tree binary stream");
+                    ++opened;
+                    ++depth;
+                }
+                else if (depth-- == 0)
+                    throw std::runtime_error("Malformed general_tree binary stream");
+            }
+            if (depth != 0 || opened != size || (size % 4 != 0 && (bits.back() >> (size % 4 * 2)) != 0))
+                throw std::runtime_error("Malformed general_tree binary stream");
+
+            for (std::uint64_t i = 0; i < size * 2; i++)
+            {
+                if (bit(i) == 0)
+                {
+                    parents.pop_back();
+                    continue;
+                }
+                private_node* new_node = new private_node(codec.decode(reader));
+                append(new_node);
+                parents.push_back({new_node, nullptr, 0});
+            }
+            return result;
+        }
+
+        // a run of nodes is valid if every node finds an open slot, and slots are left for the next run only
+        std::vector<std::pair<std::uint64_t, std::uint64_t>> runs;
+        std::uint64_t slots = 1;
+        for (std::uint64_t remaining = size; remaining > 0;)
+        {
+            const std::uint64_t count = reader.read_varint();
+            const std::uint64_t run = reader.read_varint();
+            if (run == 0 || run > remaining || slots == 0 || slots > remaining)
+                throw std::runtime_error("Malformed general_tree binary stream");
+            remaining -= run;
+            if (count == 0 ? slots < run || (slots == run) != (remaining == 0)
+                           : slots > remaining || count - 1 > (remaining - slots) / run)
+                throw std::runtime_error("Malformed general_tree binary stream");
+            slots = slots - run + run * count;
+            runs.emplace_back(count, run);
+        }
+
+        for (const auto& [count, run] : runs)
+        {
+            for (std::uint64_t i = 0; i < run; i++)
+            {
+                private_node* new_node = new private_node(codec.decode(reader));
+                append(new_node);
+                if (!parents.empty())
+                    --parents.back().m_remaining;
+                if (count > 0)
+                    parents.push_back({new_node, nullptr, count});
+                else
+                {
+                    while (!parents.empty() && parents.back().m_remaining == 0)
+                        parents.pop_back();
+                }
+            }
+        }
+        return result;
+    }
+
+    // Links read by concurrent readers are accessed atomically: the writer publishes fully built nodes with a release
+    // store and readers follow links with acquire loads.
+    static private_node* load_link(private_node* const& link) noexcept
+    {
+        return std::atomic_ref<private_node*>(const_cast<private_node*&>(link)).load(std::memory_order_acquire);
+    }
+
+    static void store_link(private_node*& link, private_node* value) noexcept
+    {
+        std::atomic_ref<private_node*>(link).store(value, std::memory_order_release);
+    }
+
+public:
+    /**
+     * @brief Tree shared by one writer and any number of lock-free readers (RCU-style).
+     * @details Readers pin the current epoch with read() and navigate through the returned guard without taking any
+     * lock. Writers are serialized by a mutex; every structural change is published with a single atomic link update,
+     * so readers always see a well-formed tree in which each change is either fully applied or not applied at all.
+     * Nodes removed by a writer are retired instead of freed and reclaimed once no reader that could still reach them
+     * remains (epoch-based reclamation). The values of published nodes are immutable; replace() publishes a new node
+     * instead, and readers that already reached the old one keep seeing the old value. checkpoint_async() writes the
+     * tree as it is at one point in time to a file while writers go on.
+     */
+    class concurrent_tree
+    {
+    private:
+        struct retired_node
+        {
+            private_node* m_node;
+            // false if only the node itself must be freed (its children were adopted by a replacement)
+            bool m_subtree;
+        };
+
+        // padded to avoid false sharing between the two reader counters
+        struct alignas(64) reader_counter
+        {
+            std::atomic<std::size_t> m_count{0};
+        };
+
+        // value a link had before a change made while a checkpoint runs
+        struct snapshot_entry
+        {
+            private_node* const* m_link;
+            private_node* m_value;
+        };
+
+        // block of the snapshot log: filled entries are never moved, so the checkpoint reads them without locks
+        struct snapshot_chunk
+        {
+            static constexpr std::size_t capacity = 1024;
+            std::array<snapshot_entry, capacity> m_entries;
+            std::unique_ptr<snapshot_chunk> m_next;
+        };
+
+        // changed links read by the checkpoint thread from the snapshot log so far, first value of each kept
+        struct snapshot_view
+        {
+            const snapshot_chunk* m_chunk = nullptr;
+            std::size_t m_read = 0;
+            std::unordered_map<private_node* const*, private_node*> m_links;
+        };
+
+        general_tree m_tree;
+        std::atomic<std::size_t> m_size;
+        std::mutex m_writer_mutex;
+        std::atomic<std::uint64_t> m_epoch{0};
+        // readers pinned at even and odd epochs
+        mutable std::array<reader_counter, 2> m_readers;
+        // nodes retired during the last three epochs, indexed by epoch % 3
+        std::array<std::vector<retired_node>, 3> m_retired;
+
+        // log of the link changes made since the running checkpoint started, appended by the writer; the flags are
+        // guarded by the writer mutex, the checkpoint thread only reads the entries published by m_snapshot_changes
+        std::unique_ptr<snapshot_chunk> m_snapshot_log;
+        snapshot_chunk* m_snapshot_tail = nullptr;
+        bool m_snapshot_active = false;
+        bool m_snapshot_failed = false;
+        std::atomic<std::size_t> m_snapshot_changes{0};
+        // serializes starting and waiting for checkpoints, so that waiting does not block writers
+        std::mutex m_checkpoint_mutex;
+        std::thread m_checkpoint_thread;
+        std::atomic<bool> m_checkpoint_running{false};
+        std::exception_ptr m_checkpoint_error;
+
+        static void free_retired(std::vector<retired_node>& retired) noexcept
+        {
+            for (const retired_node& entry : retired)
+            {
+                if (entry.m_subtree)
+                    destroy_nodes(entry.m_node);
+                else
+                    delete entry.m_node;
+            }
+            retired.clear();
+        }
+
+        static std::size_t count_nodes(const private_node* subtree) noexcept
+        {
+            std::size_t count = 0;
+            const private_node* current = subtree;
+            while (current != nullptr)
+            {
+                ++count;
+                if (current->m_left_child != nullptr)
+                {
+                    current = current->m_left_child;
+                    continue;
+                }
+
+                while (current != subtree && current->m_right_sibling == nullptr)
+                    current = current->m_parent;
+                current = (current == subtree) ? nullptr : current->m_right_sibling;
+            }
+            return count;
+        }
+
+        // - called with the writer mutex held
+        // - moves to the next epoch if no reader is pinned two epochs back, and frees what was retired back then
+        bool try_advance() noexcept
+        {
+            const std::uint64_t epoch = m_epoch.load(std::memory_order_relaxed);
+            // readers of epoch - 1 share the counter that readers of epoch + 1 would use
+            if (m_readers[(epoch + 1) & 1].m_count.load() != 0)
+                return false;
+
+            m_epoch.store(epoch + 1);
+            free_retired(m_retired[(epoch + 2) % 3]);
+            return true;
+        }
+
+        // - called with the writer mutex held, before a node is unlinked, so that retire() cannot throw after it
+        void reserve_retired()
+        {
+            std::vector<retired_node>& retired = m_retired[m_epoch.load(std::memory_order_relaxed) % 3];
+            if (retired.size() == retired.capacity())
+                retired.reserve(std::max<std::size_t>(2 * retired.capacity(), 16));
+        }
+
+        // - called with the writer mutex held, after the node was unlinked and reserve_retired()
+        void retire(private_node* pnode, bool subtree) noexcept
+        {
+            m_retired[m_epoch.load(std::memory_order_relaxed) % 3].push_back({pnode, subtree});
+        }
+
+        // - called with the writer mutex held, for root, left child and right sibling links
+        // - while a checkpoint runs, appends the value the link had to the snapshot log before changing it
+        void publish(private_node*& link, private_node* value) noexcept
+        {
+            if (m_snapshot_active && !m_snapshot_failed)
+            {
+                const std::size_t count = m_snapshot_changes.load(std::memory_order_relaxed);
+                const std::size_t index = count % snapshot_chunk::capacity;
+                try
+                {
+                    if (count != 0 && index == 0)
+                    {
+                        m_snapshot_tail->m_next = std::make_unique<snapshot_chunk>();
+                        m_snapshot_tail = m_snapshot_tail->m_next.get();
+                    }
+                    m_snapshot_tail->m_entries[index] = {&link, link};
+                    m_snapshot_changes.store(count + 1, std::memory_order_release);
+                }
+                catch (...)
+                {
+                    // the checkpoint reports the failure, the writer goes on
+                    m_snapshot_failed = true;
+                }
+            }
+            store_link(link, value);
+        }
+
+        // - reads a link as it was when the running checkpoint started, catching up with the snapshot log first
+        private_node* snapshot_link(snapshot_view& view, private_node* const& link) const
+        {
+            // the link is read first: if it changed, its old value was logged before
+            private_node* value = load_link(link);
+            const std::size_t count = m_snapshot_changes.load(std::memory_order_acquire);
+            for (; view.m_read < count; view.m_read++)
+            {
+                const std::size_t index = view.m_read % snapshot_chunk::capacity;
+                if (index == 0 && view.m_read != 0)
+                    view.m_chunk = view.m_chunk->m_next.get();
+                const snapshot_entry& entry = view.m_chunk->m_entries[index];
+                view.m_links.try_emplace(entry.m_link, entry.m_value);
+            }
+
+            if (view.m_links.empty())
+                return value;
+            const auto it = view.m_links.find(&link);
+            return it == view.m_links.end() ? value : it->second;
+        }
+
+        // - writes the tree as it was when the checkpoint started, in the format of save()
+        // - follows no parent link, since replace() changes them
+        template <typename Codec>
+        void write_snapshot(std::ostream& stream, private_node* root, std::size_t size, Codec& codec) const
+        {
+            binary_writer writer(stream);
+            write_binary_header(writer, shape_encoding::child_counts, size);
+
+            snapshot_view view;
+            view.m_chunk = m_snapshot_log.get();
+            std::vector<private_node*> path;
+            private_node* current = root;
+            while (current != nullptr)
+            {
+                private_node* first_child = snapshot_link(view, current->m_left_child);
+                std::uint64_t children = 0;
+                for (private_node* child = first_child; child != nullptr;
+                     child = snapshot_link(view, child->m_right_sibling))
+                    ++children;
+                writer.write_varint(children);
+                codec.encode(writer, current->m_data);
+
+                if (first_child != nullptr)
+                {
+                    path.push_back(current);
+                    current = first_child;
+                    continue;
+                }
+
+                while (true)
+                {
+                    if (path.empty())
+                    {
+                        current = nullptr;
+                        break;
+                    }
+
+                    private_node* sibling = snapshot_link(view, current->m_right_sibling);
+                    if (sibling != nullptr)
+                    {
+                        current = sibling;
+                        break;
+                    }
+                    current = path.back();
+                    path.pop_back();
+                }
+            }
+
+            writer.flush();
+        }
+
+        // - called with the writer mutex held
+        // - frees the snapshot log one chunk at a time
+        void end_snapshot() noexcept
+        {
+            m_snapshot_active = false;
+            while (m_snapshot_log != nullptr)
+                m_snapshot_log = std::move(m_snapshot_log->m_next);
+            m_snapshot_tail = nullptr;
+            m_snapshot_changes.store(0, std::memory_order_relaxed);
+        }
+
+    public:
+        /**
+         * @brief Epoch pin that lets a reader navigate the tree without locks.
+         * @details Nodes reached through the guard stay valid while it lives, even if a writer removes them
+         * meanwhile. A guard must not be alive in the thread that calls reclaim().
+         */
+        class read_guard
+        {
+        private:
+            friend class concurrent_tree;
+
+            const concurrent_tree* m_owner;
+            std::size_t m_counter;
+
+            explicit read_guard(const concurrent_tree* owner) noexcept : m_owner(owner)
+            {
+                while (true)
+                {
+                    const std::uint64_t epoch = owner->m_epoch.load();
+                    m_counter = epoch & 1;
+                    owner->m_readers[m_counter].m_count.fetch_add(1);
+                    // the epoch moved on before the reader was counted, the writer may not have seen it
+                    if (owner->m_epoch.load() == epoch)
+                        return;
+                    owner->m_readers[m_counter].m_count.fetch_sub(1);
+                }
+            }
+
+        public:
+            read_guard(read_guard&& other) noexcept
+                : m_owner(std::exchange(other.m_owner, nullptr)), m_counter(other.m_counter)
+            {
+            }
+
+            read_guard(const read_guard&) = delete;
+            read_guard& operator=(const read_guard&) = delete;
+            read_guard& operator=(read_guard&&) = delete;
+
+            ~read_guard()
+            {
+                if (m_owner != nullptr)
+                    m_owner->m_readers[m_counter].m_count.fetch_sub(1, std::memory_order_release);
+            }
+
+            /**
+             * @brief Returns the root node, or a null node if the tree is empty.
+             */
+            [[nodiscard]] node root() const noexcept
+            {
+                return load_link(m_owner->m_tree.m_root);
+            }
+
+            /**
+             * @brief Returns the left child of the given node, or a null node if it has none.
+             */
+            [[nodiscard]] node left_child(node n) const noexcept
+            {
+                return load_link(n.m_node->m_left_child);
+            }
+
+            /**
+             * @brief Returns the right sibling of the given node, or a null node if it has none.
+             */
+            [[nodiscard]] node right_sibling(node n) const noexcept
+            {
+                return load_link(n.m_node->m_right_sibling);
+            }
+
+            /**
+             * @brief Returns the parent of the given node, or a null node if it is the root.
+             */
+            [[nodiscard]] node parent(node n) const noexcept
+            {
+                return load_link(n.m_node->m_parent);
+            }
+
+            /**
+             * @brief Visits the subtree rooted at the given node in a single depth-first pass.
+             * @details Same callbacks as general_tree::visit. The walk keeps the nodes it went through on a stack
+             * instead of following parent links, so it never leaves the subtree even if it is moved or replaced.
+             * @throws std::invalid_argument If the start node is null.
+             */
+            template <typename Visitor>
+            void visit(node start, Visitor&& visitor) const
+            {
+                if (start.m_node == nullptr)
+                    throw std::invalid_argument("Cannot visit null node");
+
+                std::vector<private_node*> path;
+                private_node* current = start.m_node;
+                while (true)
+                {
+                    private_node* child = load_link(current->m_left_child);
+                    if (dispatch_on_enter(visitor, current) && child != nullptr)
+                    {
+                        path.push_back(current);
+                        current = child;
+                        continue;
+                    }
+
+                    while (true)
+                    {
+                        dispatch_on_leave(visitor, current);
+                        if (path.empty())
+                            return;
+
+                        private_node* sibling = load_link(current->m_right_sibling);
+                        if (sibling != nullptr)
+                        {
+                            current = sibling;
+                            break;
+                        }
+                        current = path.back();
+                        path.pop_back();
+                    }
+                }
+            }
+        };
+
+        /**
+         * @brief Takes ownership of the nodes of the given tree.
+         */
+        explicit concurrent_tree(general_tree tree = general_tree()) noexcept
+            : m_tree(std::move(tree)), m_size(m_tree.m_size)
+        {
+        }
+
+        concurrent_tree(const concurrent_tree&) = delete;
+        concurrent_tree& operator=(const concurrent_tree&) = delete;
+
+        /**
+         * @brief Frees every node. No reader may be active.
+         */
+        ~concurrent_tree()
+        {
+            if (m_checkpoint_thread.joinable())
+                m_checkpoint_thread.join();
+            for (std::vector<retired_node>& retired : m_retired)
+                free_retired(retired);
+        }
+
+        /**
+         * @brief Pins the current epoch and returns a guard to read the tree without locks.
+         */
+        [[nodiscard]] read_guard read() const noexcept
+        {
+            return read_guard(this);
+        }
+
+        /**
+         * @brief Returns the number of nodes reachable from the root.
+         */
+        [[nodiscard]] std::size_t size() const noexcept
+        {
+            return m_size.load(std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Creates and publishes the root node.
+         * @throws std::runtime_error If a root node already exists.
+         */
+        template <typename... Args>
+        node emplace_root(Args&&... args)
+        {
+            std::lock_guard<std::mutex> lock(m_writer_mutex);
+            if (m_tree.m_root != nullptr)
+                throw std::runtime_error("Root already exists");
+
+            private_node* new_node = new private_node(std::forward<Args>(args)...);
+            publish(m_tree.m_root, new_node);
+            m_tree.m_size = 1;
+            m_size.store(1, std::memory_order_relaxed);
+            return new_node;
+        }
+
+        /**
+         * @brief Creates and publishes a new left child for the given node.
+         * @throws std::invalid_argument If the destination node is null.
+         */
+        template <typename... Args>
+        node emplace_left_child(node destiny, Args&&... args)
+        {
+            if (destiny.m_node == nullptr)
+                throw std::invalid_argument("Cannot insert left child to null node");
+
+            std::lock_guard<std::mutex> lock(m_writer_mutex);
+            private_node* new_node = new private_node(std::forward<Args>(args)...);
+            new_node->m_right_sibling = destiny.m_node->m_left_child;
+            new_node->m_parent = destiny.m_node;
+            publish(destiny.m_node->m_left_child, new_node);
+
+            m_size.store(++m_tree.m_size, std::memory_order_relaxed);
+            try_advance();
+            return new_node;
+        }
+
+        /**
+         * @brief Creates and publishes a new right sibling for the given node.
+         * @throws std::invalid_argument If the destination node is null or is the root.
+         */
+        template <typename... Args>
+        node emplace_right_sibling(node destiny, Args&&... args)
+        {
+            if (destiny.m_node == nullptr)
+                throw std::invalid_argument("Cannot insert right sibling to null node");
+
+            std::lock_guard<std::mutex> lock(m_writer_mutex);
+            if (destiny.m_node->m_parent == nullptr)
+                throw std::invalid_argument("Cannot insert right sibling to root");
+
+            private_node* new_node = new private_node(std::forward<Args>(args)...);
+            new_node->m_parent = destiny.m_node->m_parent;
+            new_node->m_right_sibling = destiny.m_node->m_right_sibling;
+            publish(destiny.m_node->m_right_sibling, new_node);
+
+            m_size.store(++m_tree.m_size, std::memory_order_relaxed);
+            try_advance();
+            return new_node;
+        }
+
+        /**
+         * @brief Publishes a copy of the given node holding a new value, in place of the node.
+         * @details The children of the node are adopted by the new node. The old node is retired.
+         * @return node A handle to the new node.
+         * @throws std::invalid_argument If the node is null.
+         */
+        template <typename... Args>
+        node replace(node target, Args&&... args)
+        {
+            if (target.m_node == nullptr)
+                throw std::invalid_argument("Cannot replace null node");
+
+            std::lock_guard<std::mutex> lock(m_writer_mutex);
+            reserve_retired();
+            private_node* old_node = target.m_node;
+            private_node* new_node = new private_node(std::forward<Args>(args)...);
+            new_node->m_left_child = old_node->m_left_child;
+            new_node->m_right_sibling = old_node->m_right_sibling;
+            new_node->m_parent = old_node->m_parent;
+
+            private_node* parent = old_node->m_parent;
+            if (parent == nullptr)
+                publish(m_tree.m_root, new_node);
+            else if (parent->m_left_child == old_node)
+                publish(parent->m_left_child, new_node);
+            else
+            {
+                private_node* aux = parent->m_left_child;
+                while (aux->m_right_sibling != old_node)
+                    aux = aux->m_right_sibling;
+                publish(aux->m_right_sibling, new_node);
+            }
+
+            for (private_node* child = new_node->m_left_child; child != nullptr; child = child->m_right_sibling)
+                store_link(child->m_parent, new_node);
+
+            retire(old_node, false);
+            try_advance();
+            return new_node;
+        }
+
+        /**
+         * @brief Unlinks the left child of the given node and its descendants. They are reclaimed later.
+         * @throws std::invalid_argument If the node is null.
+         */
+        void delete_left_child(node n)
+        {
+            if (n.is_null())
+                throw std::invalid_argument("Can not delete left child of null node");
+
+            std::lock_guard<std::mutex> lock(m_writer_mutex);
+            private_node* target = n.m_node->m_left_child;
+            if (target != nullptr)
+            {
+                reserve_retired();
+                publish(n.m_node->m_left_child, target->m_right_sibling);
+                m_size.store(m_tree.m_size -= count_nodes(target), std::memory_order_relaxed);
+                retire(target, true);
+            }
+            try_advance();
+        }
+
+        /**
+         * @brief Unlinks the right sibling of the given node and its descendants. They are reclaimed later.
+         * @throws std::invalid_argument If the node is null or is the root.
+         */
+        void delete_right_sibling(node n)
+        {
+            if (n.is_null())
+                throw std::invalid_argument("Can not delete right sibling of null node");
+
+            std::lock_guard<std::mutex> lock(m_writer_mutex);
+            if (n.m_node->m_parent == nullptr)
+                throw std::invalid_argument("Can not delete right sibling of root node");
+
+            private_node* target = n.m_node->m_right_sibling;
+            if (target != nullptr)
+            {
+                reserve_retired();
+                publish(n.m_node->m_right_sibling, target->m_right_sibling);
+                m_size.store(m_tree.m_size -= count_nodes(target), std::memory_order_relaxed);
+                retire(target, true);
+            }
+            try_advance();
+        }
+
+        /**
+         * @brief Unlinks every node. They are reclaimed later.
+         */
+        void clear()
+        {
+            std::lock_guard<std::mutex> lock(m_writer_mutex);
+            private_node* root = m_tree.m_root;
+            if (root != nullptr)
+            {
+                reserve_retired();
+                publish(m_tree.m_root, nullptr);
+                m_tree.m_size = 0;
+                m_size.store(0, std::memory_order_relaxed);
+                retire(root, true);
+            }
+            try_advance();
+        }
+
+        /**
+         * @brief Blocks until every node retired so far has been freed.
+         * @details Waits for the readers that could still reach a retired node to release their guard. Writers wait
+         * meanwhile, since the writer mutex is held.
+         * @throws std::runtime_error If a checkpoint is running: it pins an epoch until it completes, so waiting for it
+         * would hold up every writer. Call wait_for_checkpoint() first.
+         */
+        void reclaim()
+        {
+            std::lock_guard<std::mutex> lock(m_writer_mutex);
+            // a checkpoint cannot start while the writer mutex is held
+            if (m_checkpoint_running.load())
+                throw std::runtime_error("Cannot reclaim while a checkpoint is running");
+            // two epochs later nothing retired before the call can be reached
+            for (int advanced = 0; advanced < 2;)
+            {
+                if (try_advance())
+                    ++advanced;
+                else
+                    std::this_thread::yield();
+            }
+        }
+
+        /**
+         * @brief Returns the number of nodes retired but not freed yet.
+         */
+        [[nodiscard]] std::size_t retired_count()
+        {
+            std::lock_guard<std::mutex> lock(m_writer_mutex);
+            std::size_t count = 0;
+            for (const std::vector<retired_node>& retired : m_retired)
+            {
+                for (const retired_node& entry : retired)
+                    count += entry.m_subtree ? count_nodes(entry.m_node) : 1;
+            }
+            return count;
+        }
+
+        /**
+         * @brief Writes the tree as it is now to a file, in the format of save(), from a background thread.
+         * @details The snapshot is taken in O(1): writers keep going while it is written, and every link change during
+         * the checkpoint first appends the value the link had to a log. The checkpoint thread reads that log without
+         * locks, keeping the first value of each link, and uses it instead of the link. The checkpoint pins an epoch,
+         * so nodes removed meanwhile are reclaimed once it finishes, and reclaim() throws until then. The file is
+         * written next to the destination and renamed over it when complete. Only one checkpoint runs at a time.
+         * @param path The destination file, replaced when the checkpoint completes.
+         * @param codec Object providing encode(binary_writer&, const T&); called from the background thread.
+         * @throws std::runtime_error If a checkpoint is already running or the file cannot be created. Errors while
+         * writing are reported by wait_for_checkpoint().
+         */
+        template <typename Codec = default_codec>
+        void checkpoint_async(const std::string& path, Codec codec = Codec())
+        {
+            std::lock_guard<std::mutex> checkpoint_lock(m_checkpoint_mutex);
+            if (m_checkpoint_running.load())
+                throw std::runtime_error("A checkpoint is already running");
+            if (m_checkpoint_thread.joinable())
+                m_checkpoint_thread.join();
+
+            std::lock_guard<std::mutex> lock(m_writer_mutex);
+
+            const std::string temporary_path = path + ".tmp";
+            std::ofstream file(temporary_path, std::ios::binary | std::ios::trunc);
+            if (!file)
+                throw std::runtime_error("Cannot open " + temporary_path);
+
+            m_snapshot_log = std::make_unique<snapshot_chunk>();
+            m_snapshot_tail = m_snapshot_log.get();
+            m_snapshot_active = true;
+            m_snapshot_failed = false;
+
+            private_node* root = m_tree.m_root;
+            const std::size_t size = m_tree.m_size;
+            m_checkpoint_running.store(true);
+            try
+            {
+                m_checkpoint_thread = std::thread(
+                    [this, guard = read_guard(this), file = std::move(file), path, temporary_path, root, size,
+                     codec = std::move(codec)]() mutable {
+                        std::exception_ptr error;
+                        try
+                        {
+                            write_snapshot(file, root, size, codec);
+                            file.close();
+                        }
+                        catch (...)
+                        {
+                            error = std::current_exception();
+                        }
+
+                        {
+                            std::lock_guard<std::mutex> lock(m_writer_mutex);
+                            if (error == nullptr && m_snapshot_failed)
+                                error = std::make_exception_ptr(
+                                    std::runtime_error("Checkpoint could not track every change")
+                                );
+                            end_snapshot();
+                        }
+
+                        try
+                        {
+                            if (error == nullptr)
+                                std::filesystem::rename(temporary_path, path);
+                        }
+                        catch (...)
+                        {
+                            error = std::current_exception();
+                        }
+                        if (error != nullptr)
+                        {
+                            m_checkpoint_error = error;
+                            std::error_code ignored;
+                            std::filesystem::remove(temporary_path, ignored);
+                        }
+
+                        // unpin the epoch before reclaim() may be called again
+                        {
+                            read_guard released = std::move(guard);
+                        }
+                        m_checkpoint_running.store(false);
+                    }
+                );
+            }
+            catch (...)
+            {
+                end_snapshot();
+                m_checkpoint_running.store(false);
+                throw;
+            }
+        }
+
+        /**
+         * @brief Returns true while a checkpoint is being written.
+         */
+        [[nodiscard]] bool checkpoint_running() const noexcept
+        {
+            return m_checkpoint_running.load();
+        }
+
+        /**
+         * @brief Blocks until the running checkpoint, if any, is complete.
+         * @throws Rethrows the exception that made the last checkpoint fail, once.
+         */
+        void wait_for_checkpoint()
+        {
+            std::lock_guard<std::mutex> lock(m_checkpoint_mutex);
+            if (m_checkpoint_thread.joinable())
+                m_checkpoint_thread.join();
+            if (m_checkpoint_error != nullptr)
+                std::rethrow_exception(std::exchange(m_checkpoint_error, nullptr));
+        }
+    };
+
+    /**
+     * @brief Construction mode in which several threads add children to the same tree at once.
+     * @details concurrent_emplace_child() links the new node with a compare-and-swap on the first-child link of the
+     * parent, so threads can populate disjoint or shared parents without locks. Each child list is built in reverse and
+     * put back in order by seal(): children added by one thread to a parent keep their insertion order and come after
+     * the children the parent already had, while children added concurrently to the same parent by different threads
+     * are interleaved in an unspecified order. Nodes must only be added through the builder until seal() is called
+     * after every thread has finished.
+     */
+    class concurrent_builder
+    {
+    private:
+        general_tree m_tree;
+
+        // - reverses the child list of every node in one preorder walk and returns the number of nodes
+        static std::size_t reverse_child_lists(private_node* root) noexcept
+        {
+            std::size_t count = 0;
+            for (private_node* current = root; current != nullptr;)
+            {
+                ++count;
+                private_node* reversed = nullptr;
+                for (private_node* child = current->m_left_child; child != nullptr;)
+                {
+                    private_node* next = child->m_right_sibling;
+                    child->m_right_sibling = reversed;
+                    reversed = child;
+                    child = next;
+                }
+                current->m_left_child = reversed;
+                if (reversed != nullptr)
+                {
+                    current = reversed;
+                    continue;
+                }
+
+                while (current != nullptr && current->m_right_sibling == nullptr)
+                    current = current->m_parent;
+                if (current != nullptr)
+                    current = current->m_right_sibling;
+            }
+            return count;
+        }
+
+    public:
+        /**
+         * @brief Takes ownership of the nodes of the given tree, which must not be empty.
+         * @details The child lists of the tree are reversed in one pass, so that seal() restores them.
+         * @throws std::invalid_argument If the tree is empty.
+         */
+        explicit concurrent_builder(general_tree tree) : m_tree(std::move(tree))
+        {
+            if (m_tree.m_root == nullptr)
+                throw std::invalid_argument("Cannot build from empty tree");
+            reverse_child_lists(m_tree.m_root);
+        }
+
+        /**
+         * @brief Returns the root node of the tree being built.
+         */
+        [[nodiscard]] node root() const noexcept
+        {
+            return m_tree.m_root;
+        }
+
+        /**
+         * @brief Creates a node and links it as the last child of the given parent once the tree is sealed. Safe to
+         * call concurrently.
+         * @return node A handle to the newly created node.
+         * @throws std::invalid_argument If the parent node is null.
+         */
+        template <typename... Args>
+        node concurrent_emplace_child(node parent, Args&&... args)
+        {
+            if (parent.m_node == nullptr)
+                throw std::invalid_argument("Cannot insert child to null node");
+
+            private_node* new_node = new private_node(std::forward<Args>(args)...);
+            new_node->m_parent = parent.m_node;
+
+            std::atomic_ref<private_node*> first_child(parent.m_node->m_left_child);
+            private_node* head = first_child.load(std::memory_order_relaxed);
+            do
+                new_node->m_right_sibling = head;
+            while (!first_child.compare_exchange_weak(
+                head, new_node, std::memory_order_release, std::memory_order_relaxed
+            ));
+
+            return new_node;
+        }
+
+        /**
+         * @brief Returns the built tree, with its child lists put in order and its size computed in one pass. The
+         * builder is left without nodes.
+         * @details Every thread that added nodes must have finished (e.g. been joined) before the call.
+         */
+        [[nodiscard]] general_tree seal() &&
+        {
+            m_tree.m_size = reverse_child_lists(m_tree.m_root);
+            return std::move(m_tree);
+        }
+    };
+
+    /**
+     * @brief Builds a tree from a stream of start_node() / end_node() events, as produced by a parser.
+     * @details start_node() appends a node after the last child of the open node and opens it; end_node() closes it.
+     * The builder only remembers the open node and its last child, which becomes the last child of the parent when the
+     * node is closed, so every event is O(1) and no stack of parents is kept.
+     */
+    class event_builder
+    {
+    private:
+        general_tree m_tree;
+        private_node* m_open = nullptr;
+        private_node* m_last_child = nullptr;
+        std::size_t m_depth = 0;
+
+    public:
+        event_builder() noexcept = default;
+
+        /**
+         * @brief Creates a node as the next child of the open node, or as the root, and opens it.
+         * @return node A handle to the new node.
+         * @throws std::runtime_error If no node is open and the root was already built.
+         */
+        template <typename... Args>
+        node start_node(Args&&... args)
+        {
+            if (m_open == nullptr && m_tree.m_root != nullptr)
+                throw std::runtime_error("Root already exists");
+
+            private_node* new_node = new private_node(std::forward<Args>(args)...);
+            if (m_open == nullptr)
+                m_tree.m_root = new_node;
+            else
+            {
+                new_node->m_parent = m_open;
+                if (m_last_child == nullptr)
+                    m_open->m_left_child = new_node;
+                else
+                    m_last_child->m_right_sibling = new_node;
+            }
+
+            ++m_tree.m_size;
+            ++m_depth;
+            m_open = new_node;
+            m_last_child = nullptr;
+            return new_node;
+        }
+
+        /**
+         * @brief Closes the open node; its parent becomes the open node.
+         * @throws std::runtime_error If no node is open.
+         */
+        void end_node()
+        {
+            if (m_open == nullptr)
+                throw std::runtime_error("No node is open");
+
+            m_last_child = m_open;
+            m_open = m_open->m_parent;
+            --m_depth;
+        }
+
+        /**
+         * @brief Same as start_node() immediately followed by end_node().
+         */
+        template <typename... Args>
+        node add_leaf(Args&&... args)
+        {
+            node leaf = start_node(std::forward<Args>(args)...);
+            end_node();
+            return leaf;
+        }
+
+        /**
+         * @brief Returns the number of open nodes.
+         */
+        [[nodiscard]] std::size_t depth() const noexcept
+        {
+            return m_depth;
+        }
+
+        /**
+         * @brief Returns the number of nodes built so far.
+         */
+        [[nodiscard]] std::size_t size() const noexcept
+        {
+            return m_tree.m_size;
+        }
+
+        /**
+         * @brief Returns the built tree. The builder is left without nodes.
+         * @throws std::runtime_error If a node is still open.
+         */
+        [[nodiscard]] general_tree seal() &&
+        {
+            if (m_open != nullptr)
+                throw std::runtime_error("A node is still open");
+            m_last_child = nullptr;
+            return std::move(m_tree);
+        }
+    };
+
+    /**
+     * @brief Incremental parser that builds a tree from an s-expression fed in chunks of any size.
+     * @details A node is written as its value alone if it is a leaf, or as a list holding its value followed by its
+     * children: (root leaf (inner child) leaf). Values are bare atoms, delimited by whitespace, parentheses and double
+     * quotes, or double-quoted strings in which a backslash escapes the next character. Each atom is turned into a
+     * value by convert(std::string_view) and the tree is built with an event_builder as atoms and parentheses are
+     * read: only the atom being read is buffered, never the document.
+     */
+    template <typename Convert>
+    class sexpr_parser
+    {
+    private:
+        enum class lexer_state
+        {
+            between_atoms,
+            bare_atom,
+            quoted_atom,
+            quoted_escape
+        };
+
+        event_builder m_builder;
+        Convert m_convert;
+        std::string m_atom;
+        lexer_state m_state = lexer_state::between_atoms;
+        // an opening parenthesis was read, the next atom is the value of the list
+        bool m_expect_head = false;
+        bool m_complete = false;
+        std::uint64_t m_offset = 0;
+
+        [[noreturn]] void fail(const char* reason) const
+        {
+            throw std::runtime_error(
+                std::string("Malformed s-expression at offset ") + std::to_string(m_offset) + ": " + reason
+            );
+        }
+
+        void on_atom()
+        {
+            if (m_complete)
+                fail("content after the tree");
+
+            m_builder.start_node(m_convert(std::string_view(m_atom)));
+            if (m_expect_head)
+                m_expect_head = false;
+            else
+                m_builder.end_node();
+
+            m_complete = m_builder.depth() == 0;
+            m_atom.clear();
+        }
+
+        void on_open()
+        {
+            if (m_complete)
+                fail("content after the tree");
+            if (m_expect_head)
+                fail("a list must start with an atom");
+            m_expect_head = true;
+        }
+
+        void on_close()
+        {
+            if (m_expect_head)
+                fail("empty list");
+            if (m_builder.depth() == 0)
+                fail("unbalanced closing parenthesis");
+
+            m_builder.end_node();
+            m_complete = m_builder.depth() == 0;
+        }
+
+        static bool is_delimiter(char c) noexcept
+        {
+            return c == '(' || c == ')' || c == '"' || c == ' ' || c == '\t' || c == '\n' || c == '\r' ||
+                   c == '\f' || c == '\v';
+        }
+
+    public:
+        explicit sexpr_parser(Convert convert = Convert()) : m_convert(std::move(convert)) {}
+
+        /**
+         * @brief Parses the next chunk of the document. Atoms may be split across chunks.
+         * @throws std::runtime_error If the document is malformed. Rethrows the exceptions thrown by convert.
+         */
+        void feed(std::string_view chunk)
+        {
+            const char* current = chunk.data();
+            const char* const end = current + chunk.size();
+            while (current != end)
+            {
+                if (m_state == lexer_state::bare_atom)
+                {
+                    // copy the rest of the atom at once
+                    const char* atom_end = std::find_if(current, end, is_delimiter);
+                    m_atom.append(current, atom_end);
+                    m_offset += static_cast<std::uint64_t>(atom_end - current);
+                    current = atom_end;
+                    if (current == end)
+                        return;
+                    m_state = lexer_state::between_atoms;
+                    on_atom();
+                    continue;
+                }
+
+                const char c = *current++;
+                if (m_state == lexer_state::quoted_atom)
+                {
+                    if (c == '\\')
+                        m_state = lexer_state::quoted_escape;
+                    else if (c == '"')
+                    {
+                        m_state = lexer_state::between_atoms;
+                        on_atom();
+                    }
+                    else
+                        m_atom.push_back(c);
+                }
+                else if (m_state == lexer_state::quoted_escape)
+                {
+                    m_atom.push_back(c);
+                    m_state = lexer_state::quoted_atom;
+                }
+                else if (c == '(')
+                    on_open();
+                else if (c == ')')
+                    on_close();
+                else if (c == '"')
+                    m_state = lexer_state::quoted_atom;
+                else if (!is_delimiter(c))
+                {
+                    m_atom.push_back(c);
+                    m_state = lexer_state::bare_atom;
+                }
+                ++m_offset;
+            }
+        }
+
+        /**
+         * @brief Ends the document and returns the tree.
+         * @throws std::runtime_error If the document is incomplete. Rethrows the exceptions thrown by convert.
+         */
+        [[nodiscard]] general_tree finish() &&
+        {
+            if (m_state == lexer_state::bare_atom)
+            {
+                m_state = lexer_state::between_atoms;
+                on_atom();
+            }
+            if (m_state != lexer_state::between_atoms)
+                fail("unterminated string");
+            if (!m_complete)
+                fail("unexpected end of input");
+
+            return std::move(m_builder).seal();
+        }
+    };
+
+    /**
+     * @brief Parses an s-expression from the stream in fixed-size chunks. See sexpr_parser for the syntax.
+     * @param convert Callable turning an atom (std::string_view) into a value.
+     * @throws std::runtime_error If the document is malformed. Rethrows the exceptions thrown by convert.
+     */
+    template <typename Convert>
+    [[nodiscard]] static general_tree parse_sexpr(std::istream& stream, Convert convert)
+    {
+        sexpr_parser<Convert> parser(std::move(convert));
+        std::array<char, 64 * 1024> chunk;
+        std::streambuf* buffer = stream.rdbuf();
+        while (true)
+        {
+            const std::streamsize count = buffer->sgetn(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+            if (count <= 0)
+                break;
+            parser.feed(std::string_view(chunk.data(), static_cast<std::size_t>(count)));
+        }
+        return std::move(parser).finish();
+    }
+
+public:
+    /**
+     * @brief Writes the tree to the stream in the binary format.
+     * @details The tree is written in a single stackless preorder pass: the child count of every node followed by its
+     * encoded value. Nothing but the stream buffer is used.
+     * @param stream The destination stream, opened in binary mode.
+     * @param codec Object providing encode(binary_writer&, const T&).
+     * @throws std::runtime_error If the stream fails. Rethrows the exceptions thrown by the codec.
+     */
+    template <typename Codec = default_codec>
+    void save(std::ostream& stream, Codec codec = Codec()) const
+    {
+        binary_writer writer(stream);
+        write_binary_header(writer, shape_encoding::child_counts, m_size);
+
+        for (const private_node* current = m_root; current != nullptr;)
+        {
+            std::uint64_t children = 0;
+            for (const private_node* child = current->m_left_child; child != nullptr; child = child->m_right_sibling)
+                ++children;
+            writer.write_varint(children);
+            codec.encode(writer, current->m_data);
+
+            if (current->m_left_child != nullptr)
+            {
+                current = current->m_left_child;
+                continue;
+            }
+
+            while (current != nullptr && current->m_right_sibling == nullptr)
+                current = current->m_parent;
+            if (current != nullptr)
+                current = current->m_right_sibling;
+        }
+
+        writer.flush();
+    }
+
+    /**
+     * @brief Writes the tree to the stream in the compact binary format, read back by load().
+     * @details The shape is stored apart from the values, in whichever encoding is smaller for this tree: balanced
+     * parentheses (2 bits per node) or runs of equal child counts in preorder as varint (count, run length) pairs,
+     * which fold the leaves and the regular fan-outs of wide trees into a few bytes. The values follow in preorder.
+     * Costs three stackless preorder passes and nothing but the stream buffer.
+     * @param stream The destination stream, opened in binary mode.
+     * @param codec Object providing encode(binary_writer&, const T&).
+     * @throws std::runtime_error If the stream fails. Rethrows the exceptions thrown by the codec.
+     */
+    template <typename Codec = default_codec>
+    void save_compact(std::ostream& stream, Codec codec = Codec()) const
+    {
+        std::uint64_t run_bytes = 0;
+        for_each_fanout_run([&](std::uint64_t count, std::uint64_t run) {
+            run_bytes += varint_size(count) + varint_size(run);
+        });
+        const std::uint64_t parentheses_bytes = (static_cast<std::uint64_t>(m_size) * 2 + 7) / 8;
+
+        binary_writer writer(stream);
+        if (parentheses_bytes < run_bytes)
+        {
+            write_binary_header(writer, shape_encoding::balanced_parentheses, m_size);
+            write_balanced_parentheses(writer);
+        }
+        else
+        {
+            write_binary_header(writer, shape_encoding::fanout_runs, m_size);
+            for_each_fanout_run([&](std::uint64_t count, std::uint64_t run) {
+                writer.write_varint(count);
+                writer.write_varint(run);
+            });
+        }
+
+        for (const T& value : *this)
+            codec.encode(writer, value);
+
+        writer.flush();
+    }
+
+    /**
+     * @brief Reads a tree written by save() or save_compact().
+     * @details Nodes are linked as they are decoded: every node is appended after the last child of its parent, which
+     * is kept on a stack of open parents, so the tree is never walked. Memory use besides the tree is bounded by the
+     * stream buffer and the depth of the tree, plus the encoded shape for the compact format, which is read and
+     * checked as a whole before the first node is created.
+     * @param stream The source stream, opened in binary mode.
+     * @param codec Object providing T decode(binary_reader&).
+     * @throws std::runtime_error If the stream is truncated or malformed. Rethrows the exceptions thrown by the codec.
+     * No node is leaked.
+     */
+    template <typename Codec = default_codec>
+    [[nodiscard]] static general_tree load(std::istream& stream, Codec codec = Codec())
+    {
+        binary_reader reader(stream);
+        std::uint64_t size = 0;
+        const shape_encoding encoding = read_binary_header(reader, size);
+
+        general_tree result;
+        if (size == 0)
+            return result;
+        if (encoding != shape_encoding::child_counts)
+            return load_compact(reader, encoding, size, codec);
+
+        struct open_parent
+        {
+            private_node* m_node;
+            private_node* m_last_child;
+            std::uint64_t m_remaining;
+        };
+        std::vector<open_parent> parents;
+
+        for (std::uint64_t i = 0; i < size; i++)
+        {
+            const std::uint64_t children = reader.read_varint();
+            private_node* new_node = new private_node(codec.decode(reader));
+
+            if (parents.empty())
+            {
+                if (result.m_root != nullptr)
+                {
+                    delete new_node;
+                    throw std::runtime_error("Malformed general_tree binary stream");
+                }
+                result.m_root = new_node;
+            }
+            else
+            {
+                open_parent& parent = parents.back();
+                new_node->m_parent = parent.m_node;
+                if (parent.m_last_child == nullptr)
+                    parent.m_node->m_left_child = new_node;
+                else
+                    parent.m_last_child->m_right_sibling = new_node;
+                parent.m_last_child = new_node;
+                --parent.m_remaining;
+            }
+            ++result.m_size;
+
+            if (children > 0)
+                parents.push_back({new_node, nullptr, children});
+            else
+            {
+                while (!parents.empty() && parents.back().m_remaining == 0)
+                    parents.pop_back();
+            }
+        }
+
+        if (!parents.empty())
+            throw std::runtime_error("Malformed general_tree binary stream");
+
+        return result;
+    }
+
+    /// Index stored in the columns for a missing parent or first child.
+    static constexpr std::size_t no_index = std::numeric_limits<std::size_t>::max();
+
+    /**
+     * @brief Caller-provided buffers filled by export_columns(), indexed by preorder position.
+     * @details An empty span skips its column. Every other span needs room for size() elements.
+     */
+    struct column_buffers
+    {
+        std::span<std::size_t> parent_index; ///< Index of the parent, no_index for the root.
+        std::span<std::size_t> depth;        ///< Distance from the root.
+        std::span<std::size_t> subtree_size; ///< Number of nodes in the subtree, the node included.
+        std::span<std::size_t> first_child;  ///< Index of the left child, no_index for leaves.
+        std::span<T> values;                 ///< Copies of the values.
+    };
+
+    /**
+     * @brief Writes the structure and the values of the tree into flat columns in preorder.
+     * @details Single stackless preorder pass. The columns of a subtree are contiguous: node i spans the indices
+     * [i, i + subtree_size[i]), and its right sibling, if any, is at i + subtree_size[i]. Besides the buffers, the only
+     * storage is the indices of the ancestors of the current node.
+     * @param buffers Destination of the columns.
+     * @throws std::invalid_argument If a non-empty buffer is smaller than size(). Nothing is written in that case.
+     * Rethrows the exceptions thrown by the copy assignment of T.
+     */
+    void export_columns(const column_buffers& buffers) const
+    {
+        for (std::size_t column_size :
+             {buffers.parent_index.size(), buffers.depth.size(), buffers.subtree_size.size(),
+              buffers.first_child.size(), buffers.values.size()})
+        {
+            if (column_size != 0 && column_size < m_size)
+                throw std::invalid_argument("Column buffer smaller than the tree");
+        }
+
+        std::vector<std::size_t> ancestors;
+        std::size_t index = 0;
+        for (const private_node* current = m_root; current != nullptr;)
+        {
+            if (!buffers.parent_index.empty())
+                buffers.parent_index[index] = ancestors.empty() ? no_index : ancestors.back();
+            if (!buffers.depth.empty())
+                buffers.depth[index] = ancestors.size();
+            if (!buffers.first_child.empty())
+                buffers.first_child[index] = current->m_left_child != nullptr ? index + 1 : no_index;
+            if (!buffers.values.empty())
+                buffers.values[index] = current->m_data;
+
+            if (current->m_left_child != nullptr)
+            {
+                ancestors.push_back(index++);
+                current = current->m_left_child;
+                continue;
+            }
+
+            // the subtree of every ancestor left behind ends with this leaf
+            if (!buffers.subtree_size.empty())
+                buffers.subtree_size[index] = 1;
+            ++index;
+            while (current != nullptr && current->m_right_sibling == nullptr)
+            {
+                current = current->m_parent;
+                if (current != nullptr)
+                {
+                    if (!buffers.subtree_size.empty())
+                        buffers.subtree_size[ancestors.back()] = index - ancestors.back();
+                    ancestors.pop_back();
+                }
+            }
+            if (current != nullptr)
+                current = current->m_right_sibling;
+        }
+    }
+
+    /**
+     * @brief Builds a tree from the parent column and the values column of export_columns().
+     * @details O(n): nodes are created in preorder and appended after the last child of their parent, which is kept
+     * on a stack of open ancestors, as in load(). The other columns are implied by these two.
+     * @param parent_index Index of the parent of every node in preorder, no_index for the root.
+     * @param values Value of every node in preorder.
+     * @throws std::invalid_argument If the columns have different sizes or the parent column does not describe a tree
+     * in preorder. No node is leaked. Rethrows the exceptions thrown by the copy constructor of T.
+     */
+    [[nodiscard]] static general_tree import_columns(
+        std::span<const std::size_t> parent_index, std::span<const T> values
+    )
+    {
+        if (parent_index.size() != values.size())
+            throw std::invalid_argument("Columns of different sizes");
+
+        general_tree result;
+        struct open_ancestor
+        {
+            std::size_t m_index;
+            private_node* m_node;
+            private_node* m_last_child;
+        };
+        std::vector<open_ancestor> ancestors;
+
+        for (std::size_t i = 0; i < values.size(); i++)
+        {
+            const std::size_t parent = parent_index[i];
+            if (i == 0 ? parent != no_index : parent >= i)
+                throw std::invalid_argument("Parent column not in preorder");
+
+            // in preorder the parent is on the path from the root to the previous node
+            while (!ancestors.empty() && ancestors.back().m_index != parent)
+                ancestors.pop_back();
+            if (i > 0 && ancestors.empty())
+                throw std::invalid_argument("Parent column not in preorder");
+
+            private_node* new_node = new private_node(values[i]);
+            if (ancestors.empty())
+                result.m_root = new_node;
+            else
+            {
+                open_ancestor& ancestor = ancestors.back();
+                new_node->m_parent = ancestor.m_node;
+                if (ancestor.m_last_child == nullptr)
+                    ancestor.m_node->m_left_child = new_node;
+                else
+                    ancestor.m_last_child->m_right_sibling = new_node;
+                ancestor.m_last_child = new_node;
+            }
+            ++result.m_size;
+            ancestors.push_back({i, new_node, nullptr});
+        }
+
+        return result;
+    }
+
+private:
+    // - parents[i] is the parent of node i, no_index for the root
+    // - for_each_child(append) calls append(i) for every node but the root, in the order of the siblings
+    // - the grouping and the checks are serial, node allocation and linking use thread_count threads
+    template <typename ForEachChild>
+    [[nodiscard]] static general_tree build_from_parents(
+        std::span<const T> values, std::span<const std::size_t> parents, ForEachChild for_each_child,
+        std::size_t thread_count
+    )
+    {
+        const std::size_t count = values.size();
+        general_tree result;
+        if (count == 0)
+            return result;
+
+        // counting sort of the children by parent: the children of p are children[first[p]] to children[first[p + 1] - 1]
+        std::size_t root = no_index;
+        std::vector<std::size_t> first(count + 1, 0);
+        for (std::size_t i = 0; i < count; i++)
+        {
+            if (parents[i] == no_index)
+            {
+                if (root != no_index)
+                    throw std::invalid_argument("More than one root");
+                root = i;
+            }
+            else if (parents[i] >= count)
+                throw std::invalid_argument("Parent index out of range");
+            else
+                ++first[parents[i] + 1];
+        }
+        if (root == no_index)
+            throw std::invalid_argument("No root");
+        for (std::size_t i = 0; i < count; i++)
+            first[i + 1] += first[i];
+
+        std::vector<std::size_t> children(count - 1);
+        {
+            std::vector<std::size_t> next(first.begin(), first.end() - 1);
+            for_each_child([&](std::size_t child) { children[next[parents[child]]++] = child; });
+        }
+
+        // nodes on a cycle are not reachable from the root
+        {
+            std::vector<std::size_t> reached = {root};
+            reached.reserve(count);
+            for (std::size_t i = 0; i < reached.size(); i++)
+                reached.insert(
+                    reached.end(), children.begin() + static_cast<std::ptrdiff_t>(first[reached[i]]),
+                    children.begin() + static_cast<std::ptrdiff_t>(first[reached[i] + 1])
+                );
+            if (reached.size() != count)
+                throw std::invalid_argument("Parent links do not form a tree");
+        }
+
+        std::vector<private_node*> nodes(count, nullptr);
+        auto allocate = [&](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; i++)
+                nodes[i] = new private_node(values[i]);
+        };
+        try
+        {
+            parallel_chunks(count, thread_count, allocate);
+        }
+        catch (...)
+        {
+            for (private_node* node : nodes)
+                delete node;
+            throw;
+        }
+
+        // every node is linked by the chunk holding its parent
+        auto link = [&](std::size_t begin, std::size_t end) {
+            for (std::size_t parent = begin; parent < end; parent++)
+            {
+                private_node* previous = nullptr;
+                for (std::size_t k = first[parent]; k < first[parent + 1]; k++)
+                {
+                    private_node* child = nodes[children[k]];
+                    child->m_parent = nodes[parent];
+                    if (previous == nullptr)
+                        nodes[parent]->m_left_child = child;
+                    else
+                        previous->m_right_sibling = child;
+                    previous = child;
+                }
+            }
+        };
+        parallel_chunks(count, thread_count, link);
+
+        result.m_root = nodes[root];
+        result.m_size = count;
+        return result;
+    }
+
+    [[nodiscard]] static general_tree build_from_parent_array(
+        std::span<const T> values, std::span<const std::size_t> parents, std::size_t thread_count
+    )
+    {
+        if (parents.size() != values.size())
+            throw std::invalid_argument("Columns of different sizes");
+
+        auto for_each_child = [&](auto append) {
+            for (std::size_t i = 0; i < parents.size(); i++)
+            {
+                if (parents[i] != no_index)
+                    append(i);
+            }
+        };
+        return build_from_parents(values, parents, for_each_child, thread_count);
+    }
+
+    [[nodiscard]] static general_tree build_from_edges(
+        std::span<const T> values, std::span<const std::pair<std::size_t, std::size_t>> edges, std::size_t thread_count
+    )
+    {
+        std::vector<std::size_t> parents(values.size(), no_index);
+        for (const auto& [parent, child] : edges)
+        {
+            if (parent >= values.size() || child >= values.size())
+                throw std::invalid_argument("Node index out of range");
+            if (parents[child] != no_index)
+                throw std::invalid_argument("Node with more than one parent");
+            parents[child] = parent;
+        }
+
+        auto for_each_child = [&](auto append) {
+            for (const auto& edge : edges)
+                append(edge.second);
+        };
+        return build_from_parents(values, parents, for_each_child, thread_count);
+    }
+
+public:
+    /**
+     * @brief Builds a tree from a parent array in O(n).
+     * @details Node i holds values[i]. Children keep the order of their indices. The children are grouped by parent
+     * with a counting sort, so no sibling list is ever walked.
+     * @param values Value of every node.
+     * @param parents Index of the parent of every node, no_index for the root. Any order.
+     * @throws std::invalid_argument If the arrays have different sizes or do not describe a single tree (no root,
+     * several roots, out of range index or cycle). Nothing is allocated in that case. Rethrows the exceptions thrown by
+     * the copy constructor of T; no node is leaked.
+     */
+    [[nodiscard]] static general_tree from_parent_array(
+        std::span<const T> values, std::span<const std::size_t> parents
+    )
+    {
+        return build_from_parent_array(values, parents, 1);
+    }
+
+    /**
+     * @brief Same as from_parent_array(values, parents), allocating and linking the nodes concurrently.
+     * @details T's copy constructor must be safe to call from several threads at once.
+     * @param policy The number of threads to use.
+     */
+    [[nodiscard]] static general_tree from_parent_array(
+        std::span<const T> values, std::span<const std::size_t> parents, parallel_policy policy
+    )
+    {
+        return build_from_parent_array(values, parents, resolve_thread_count(policy.thread_count));
+    }
+
+    /**
+     * @brief Builds a tree from a list of (parent, child) edges in O(n).
+     * @details Node i holds values[i]. Children keep the order of their edges. The root is the only node that is not
+     * the child of an edge.
+     * @param values Value of every node.
+     * @param edges One (parent index, child index) pair per node but the root, in any order.
+     * @throws std::invalid_argument If the edges do not describe a single tree over all the values (out of range index,
+     * node with several parents, several roots or cycle). Nothing is allocated in that case. Rethrows the exceptions
+     * thrown by the copy constructor of T; no node is leaked.
+     */
+    [[nodiscard]] static general_tree from_edges(
+        std::span<const T> values, std::span<const std::pair<std::size_t, std::size_t>> edges
+    )
+    {
+        return build_from_edges(values, edges, 1);
+    }
+
+    /**
+     * @brief Same as from_edges(values, edges), allocating and linking the nodes concurrently.
+     * @details T's copy constructor must be safe to call from several threads at once.
+     * @param policy The number of threads to use.
+     */
+    [[nodiscard]] static general_tree from_edges(
+        std::span<const T> values, std::span<const std::pair<std::size_t, std::size_t>> edges, parallel_policy policy
+    )
+    {
+        return build_from_edges(values, edges, resolve_thread_count(policy.thread_count));
+    }
+
+    /// Kind of an edit_operation.
+    enum class edit_kind : std::uint8_t
+    {
+        update, ///< Replaces the value of the node at path.
+        erase,  ///< Deletes the subtree rooted at path.
+        move,   ///< Moves the subtree rooted at path under parent, at position.
+        insert  ///< Inserts a new subtree under parent, at position.
+    };
+
+    /**
+     * @brief One step of an edit script, see diff() and apply().
+     * @details Nodes are named by their path in the tree before the script is applied: the child indices followed from
+     * the root, empty for the root itself. Positions are indices among the children of the parent once the whole
+     * script is applied. Inserted subtrees are stored in the columns of import_columns().
+     */
+    struct edit_operation
+    {
+        edit_kind kind;
+        std::vector<std::size_t> path;         ///< Node updated, erased or moved.
+        std::vector<std::size_t> parent;       ///< New parent of a moved or inserted subtree.
+        std::size_t position = 0;              ///< Index among the children of parent once the script is applied.
+        std::vector<T> values;                 ///< New value of an update, or the inserted values in preorder.
+        std::vector<std::size_t> parent_index; ///< Parent column of the inserted subtree.
+    };
+
+    /// Edit operations in any order: apply() orders them itself.
+    using edit_script = std::vector<edit_operation>;
+
+private:
+    // Preorder layout of a tree for diff(): the children of i are i + 1, then every next sibling c + m_subtree_size[c]
+    // up to i + m_subtree_size[i]. m_value_hash covers the value of the node, m_hash the values and the shape of the
+    // subtree.
+    struct diff_layout
+    {
+        std::vector<const private_node*> m_nodes;
+        std::vector<std::size_t> m_parent;
+        std::vector<std::size_t> m_rank;
+        std::vector<std::size_t> m_child_count;
+        std::vector<std::size_t> m_subtree_size;
+        std::vector<std::size_t> m_value_hash;
+        std::vector<std::size_t> m_hash;
+
+        [[nodiscard]] std::vector<std::size_t> children(std::size_t i) const
+        {
+            std::vector<std::size_t> result;
+            result.reserve(m_child_count[i]);
+            for (std::size_t child = i + 1; child < i + m_subtree_size[i]; child += m_subtree_size[child])
+                result.push_back(child);
+            return result;
+        }
+
+        [[nodiscard]] std::vector<std::size_t> path(std::size_t i) const
+        {
+            std::vector<std::size_t> result;
+            for (; m_parent[i] != no_index; i = m_parent[i])
+                result.push_back(m_rank[i]);
+            std::reverse(result.begin(), result.end());
+            return result;
+        }
+    };
+
+    static std::size_t combine_hash(std::size_t seed, std::size_t value) noexcept
+    {
+        return seed ^ (value + static_cast<std::size_t>(0x9e3779b97f4a7c15ULL) + (seed << 6) + (seed >> 2));
+    }
+
+    template <typename Hash>
+    [[nodiscard]] static diff_layout make_diff_layout(const private_node* root, Hash& hash)
+    {
+        diff_layout layout;
+        std::vector<std::size_t> ancestors;
+        for (const private_node* current = root; current != nullptr;)
+        {
+            layout.m_parent.push_back(ancestors.empty() ? no_index : ancestors.back());
+            layout.m_nodes.push_back(current);
+
+            if (current->m_left_child != nullptr)
+            {
+                ancestors.push_back(layout.m_nodes.size() - 1);
+                current = current->m_left_child;
+                continue;
+            }
+
+            while (current != nullptr && current->m_right_sibling == nullptr)
+            {
+                current = current->m_parent;
+                if (current != nullptr)
+                    ancestors.pop_back();
+            }
+            if (current != nullptr)
+                current = current->m_right_sibling;
+        }
+
+        // preorder lists the siblings in order, and the subtrees of later nodes are complete first in reverse order
+        const std::size_t count = layout.m_nodes.size();
+        layout.m_rank.assign(count, 0);
+        layout.m_child_count.assign(count, 0);
+        layout.m_subtree_size.assign(count, 1);
+        layout.m_value_hash.assign(count, 0);
+        layout.m_hash.assign(count, 0);
+        for (std::size_t i = 1; i < count; i++)
+            layout.m_rank[i] = layout.m_child_count[layout.m_parent[i]]++;
+        for (std::size_t i = count; i-- > 1;)
+            layout.m_subtree_size[layout.m_parent[i]] += layout.m_subtree_size[i];
+        for (std::size_t i = count; i-- > 0;)
+        {
+            layout.m_value_hash[i] = static_cast<std::size_t>(hash(layout.m_nodes[i]->m_data));
+            std::size_t h = combine_hash(layout.m_value_hash[i], layout.m_subtree_size[i]);
+            for (std::size_t child = i + 1; child < i + layout.m_subtree_size[i]; child += layout.m_subtree_size[child])
+                h = combine_hash(h, layout.m_hash[child]);
+            layout.m_hash[i] = h;
+        }
+        return layout;
+    }
+
+    // - the hashes only rule out differences, equal subtrees are confirmed value by value
+    static bool same_subtree(const diff_layout& a, std::size_t i, const diff_layout& b, std::size_t j)
+    {
+        if (a.m_hash[i] != b.m_hash[j] || a.m_subtree_size[i] != b.m_subtree_size[j])
+            return false;
+        for (std::size_t k = 0; k < a.m_subtree_size[i]; k++)
+        {
+            if (a.m_child_count[i + k] != b.m_child_count[j + k])
+                return false;
+            if (!(a.m_nodes[i + k]->m_data == b.m_nodes[j + k]->m_data))
+                return false;
+        }
+        return true;
+    }
+
+    static edit_operation make_insert(
+        const diff_layout& to, std::size_t subtree, std::vector<std::size_t> parent, std::size_t position
+    )
+    {
+        edit_operation op{edit_kind::insert, {}, std::move(parent), position, {}, {}};
+        op.values.reserve(to.m_subtree_size[subtree]);
+        op.parent_index.reserve(to.m_subtree_size[subtree]);
+        for (std::size_t k = 0; k < to.m_subtree_size[subtree]; k++)
+        {
+            op.values.push_back(to.m_nodes[subtree + k]->m_data);
+            op.parent_index.push_back(k == 0 ? no_index : to.m_parent[subtree + k] - subtree);
+        }
+        return op;
+    }
+
+    // - indices into sequence of the longest strictly increasing subsequence, in O(n log n)
+    static std::vector<std::size_t> longest_increasing(const std::vector<std::size_t>& sequence)
+    {
+        std::vector<std::size_t> tails;
+        std::vector<std::size_t> previous(sequence.size(), no_index);
+        for (std::size_t i = 0; i < sequence.size(); i++)
+        {
+            auto shorter = [&sequence](std::size_t tail, std::size_t value) { return sequence[tail] < value; };
+            auto it = std::lower_bound(tails.begin(), tails.end(), sequence[i], shorter);
+            if (it != tails.begin())
+                previous[i] = *std::prev(it);
+            if (it == tails.end())
+                tails.push_back(i);
+            else
+                *it = i;
+        }
+
+        std::vector<std::size_t> result;
+        for (std::size_t i = tails.empty() ? no_index : tails.back(); i != no_index; i = previous[i])
+            result.push_back(i);
+        std::reverse(result.begin(), result.end());
+        return result;
+    }
+
+public:
     /**
-     * @brief Creates and emplaces a new right sibling for the given destination node.
-     * @tparam Args Variadic template parameters for the new node constructor.
-     * @param destiny The node to which the new right sibling will be attached.
-     * @param args Arguments to forward to the new node's constructor.
-     * @return node A handle to the newly created right sibling node.
-     * @throws std::invalid_argument If the destination node is null or is the root (cannot have a sibling).
+     * @brief Computes an edit script that turns one tree into another.
+     * @details Both trees are hashed bottom-up, then matched top-down from the roots: identical subtrees are skipped
+     * whole. Among the children of matched nodes, identical subtrees are paired first (common prefix and suffix, then
+     * by hash); the longest run of them still in order stays in place and the others are moved. The remaining children
+     * are paired by value between the stays and compared recursively, and whatever is left is erased or inserted. An
+     * inserted subtree identical to an erased one becomes a move. The script is small for local changes but not
+     * guaranteed minimal.
+     * @param from The tree the script applies to.
+     * @param to The tree the script produces.
+     * @param hash Object providing std::size_t operator()(const T&), consistent with operator== of T.
+     * @return edit_script The operations for apply(). Empty if the trees are equal.
      */
-    template <typename... Args>
-    node emplace_right_sibling(node destiny, Args&&... args)
+    template <typename Hash = std::hash<T>>
+    [[nodiscard]] static edit_script diff(const general_tree& from, const general_tree& to, Hash hash = Hash())
     {
-        if (destiny.m_node == nullptr)
-            throw std::invalid_argument("Cannot insert right sibling to null node");
+        edit_script script;
+        if (to.m_root == nullptr)
+        {
+            if (from.m_root != nullptr)
+                script.push_back({edit_kind::erase, {}, {}, 0, {}, {}});
+            return script;
+        }
+
+        const diff_layout b = make_diff_layout(to.m_root, hash);
+        if (from.m_root == nullptr)
+        {
+            script.push_back(make_insert(b, 0, {}, 0));
+            return script;
+        }
+        const diff_layout a = make_diff_layout(from.m_root, hash);
+
+        struct pending_insert
+        {
+            std::size_t m_parent;
+            std::size_t m_position;
+            std::size_t m_subtree;
+        };
+        std::vector<pending_insert> inserts;
+        std::vector<std::size_t> erased;
+
+        std::vector<std::pair<std::size_t, std::size_t>> pending = {{0, 0}};
+        while (!pending.empty())
+        {
+            const auto [x, y] = pending.back();
+            pending.pop_back();
+            if (same_subtree(a, x, b, y))
+                continue;
+
+            if (!(a.m_nodes[x]->m_data == b.m_nodes[y]->m_data))
+                script.push_back({edit_kind::update, a.path(x), {}, 0, {b.m_nodes[y]->m_data}, {}});
+
+            const std::vector<std::size_t> xs = a.children(x);
+            const std::vector<std::size_t> ys = b.children(y);
+            std::vector<std::size_t> matched_x(ys.size(), no_index);
+            std::vector<bool> used_x(xs.size(), false);
+            auto match = [&](std::size_t p, std::size_t q) {
+                matched_x[q] = p;
+                used_x[p] = true;
+            };
+
+            std::size_t prefix = 0;
+            while (prefix < xs.size() && prefix < ys.size() && same_subtree(a, xs[prefix], b, ys[prefix]))
+            {
+                match(prefix, prefix);
+                ++prefix;
+            }
+            std::size_t suffix = 0;
+            while (suffix < xs.size() - prefix && suffix < ys.size() - prefix &&
+                   same_subtree(a, xs[xs.size() - 1 - suffix], b, ys[ys.size() - 1 - suffix]))
+            {
+                match(xs.size() - 1 - suffix, ys.size() - 1 - suffix);
+                ++suffix;
+            }
+
+            if (prefix + suffix < ys.size() && prefix + suffix < xs.size())
+            {
+                struct bucket
+                {
+                    std::vector<std::size_t> m_positions;
+                    std::size_t m_next = 0;
+                };
+                std::unordered_map<std::size_t, bucket> buckets;
+                for (std::size_t p = prefix; p < xs.size() - suffix; p++)
+                    buckets[a.m_hash[xs[p]]].m_positions.push_back(p);
+
+                for (std::size_t q = prefix; q < ys.size() - suffix; q++)
+                {
+                    auto it = buckets.find(b.m_hash[ys[q]]);
+                    if (it == buckets.end())
+                        continue;
+                    bucket& candidates = it->second;
+                    while (candidates.m_next < candidates.m_positions.size() &&
+                           used_x[candidates.m_positions[candidates.m_next]])
+                        ++candidates.m_next;
+                    for (std::size_t k = candidates.m_next; k < candidates.m_positions.size(); k++)
+                    {
+                        const std::size_t p = candidates.m_positions[k];
+                        if (!used_x[p] && same_subtree(a, xs[p], b, ys[q]))
+                        {
+                            match(p, q);
+                            break;
+                        }
+                    }
+                }
+            }
+
+            // identical children in order stay, the others move
+            std::vector<std::size_t> matched_q;
+            std::vector<std::size_t> matched_p;
+            for (std::size_t q = 0; q < ys.size(); q++)
+            {
+                if (matched_x[q] != no_index)
+                {
+                    matched_q.push_back(q);
+                    matched_p.push_back(matched_x[q]);
+                }
+            }
+            std::vector<std::pair<std::size_t, std::size_t>> anchors;
+            std::size_t next_stay = 0;
+            const std::vector<std::size_t> stays = longest_increasing(matched_p);
+            for (std::size_t k = 0; k < matched_q.size(); k++)
+            {
+                if (next_stay < stays.size() && stays[next_stay] == k)
+                {
+                    anchors.emplace_back(matched_p[k], matched_q[k]);
+                    ++next_stay;
+                }
+                else
+                    script.push_back({edit_kind::move, a.path(xs[matched_p[k]]), a.path(x), matched_q[k], {}, {}});
+            }
+            anchors.emplace_back(xs.size(), ys.size());
+
+            // between two stays, children with the same value are compared in order. Between two such pairs, if as
+            // many children are left on both sides they are compared in order too, otherwise erased and inserted.
+            std::vector<std::size_t> left_q;
+            auto flush = [&](std::size_t begin_p, std::size_t end_p) {
+                std::vector<std::size_t> left_p;
+                for (std::size_t k = begin_p; k < end_p; k++)
+                {
+                    if (!used_x[k])
+                        left_p.push_back(k);
+                }
+                if (left_p.size() == left_q.size())
+                {
+                    for (std::size_t k = 0; k < left_p.size(); k++)
+                        pending.emplace_back(xs[left_p[k]], ys[left_q[k]]);
+                }
+                else
+                {
+                    for (std::size_t q : left_q)
+                        inserts.push_back({x, q, ys[q]});
+                    for (std::size_t k : left_p)
+                        erased.push_back(xs[k]);
+                }
+                left_q.clear();
+            };
+
+            // children of the gap by value hash, in order: a bucket is only scanned forward, past the last pair
+            struct value_bucket
+            {
+                std::vector<std::size_t> m_positions;
+                std::size_t m_next = 0;
+            };
+
+            std::size_t gap_p = 0;
+            std::size_t gap_q = 0;
+            for (const auto& [anchor_p, anchor_q] : anchors)
+            {
+                // a map per gap: clearing a map sized for a large gap would cost its buckets at every small one
+                std::unordered_map<std::size_t, value_bucket> by_value;
+                for (std::size_t k = gap_p; k < anchor_p; k++)
+                {
+                    if (!used_x[k])
+                        by_value[a.m_value_hash[xs[k]]].m_positions.push_back(k);
+                }
+
+                std::size_t p = gap_p;
+                for (std::size_t q = gap_q; q < anchor_q; q++)
+                {
+                    if (matched_x[q] != no_index)
+                        continue;
+                    std::size_t candidate = anchor_p;
+                    auto it = by_value.find(b.m_value_hash[ys[q]]);
+                    if (it != by_value.end())
+                    {
+                        value_bucket& bucket = it->second;
+                        while (bucket.m_next < bucket.m_positions.size() && bucket.m_positions[bucket.m_next] < p)
+                            ++bucket.m_next;
+                        for (std::size_t k = bucket.m_next; k < bucket.m_positions.size(); k++)
+                        {
+                            const std::size_t position = bucket.m_positions[k];
+                            if (a.m_nodes[xs[position]]->m_data == b.m_nodes[ys[q]]->m_data)
+                            {
+                                candidate = position;
+                                break;
+                            }
+                        }
+                    }
+                    if (candidate < anchor_p)
+                    {
+                        flush(p, candidate);
+                        match(candidate, q);
+                        pending.emplace_back(xs[candidate], ys[q]);
+                        p = candidate + 1;
+                    }
+                    else
+                        left_q.push_back(q);
+                }
+                flush(p, anchor_p);
+                gap_p = anchor_p + 1;
+                gap_q = anchor_q + 1;
+            }
+        }
+
+        // an inserted subtree identical to an erased one is moved instead
+        std::unordered_map<std::size_t, std::vector<std::size_t>> erased_by_hash;
+        for (std::size_t k = 0; k < erased.size(); k++)
+            erased_by_hash[a.m_hash[erased[k]]].push_back(k);
+        std::vector<bool> moved(erased.size(), false);
+        for (const pending_insert& insert : inserts)
+        {
+            std::size_t source = no_index;
+            auto it = erased_by_hash.find(b.m_hash[insert.m_subtree]);
+            if (it != erased_by_hash.end())
+            {
+                for (std::size_t k : it->second)
+                {
+                    if (!moved[k] && same_subtree(a, erased[k], b, insert.m_subtree))
+                    {
+                        source = k;
+                        break;
+                    }
+                }
+            }
+
+            if (source == no_index)
+                script.push_back(make_insert(b, insert.m_subtree, a.path(insert.m_parent), insert.m_position));
+            else
+            {
+                moved[source] = true;
+                script.push_back(
+                    {edit_kind::move, a.path(erased[source]), a.path(insert.m_parent), insert.m_position, {}, {}}
+                );
+            }
+        }
+        for (std::size_t k = 0; k < erased.size(); k++)
+        {
+            if (!moved[k])
+                script.push_back({edit_kind::erase, a.path(erased[k]), {}, 0, {}, {}});
+        }
+
+        return script;
+    }
+
+    /**
+     * @brief Applies an edit script in place, as produced by diff() for a tree equal to this one.
+     * @details Paths are resolved and the whole script is checked first, and inserted subtrees are built; then values
+     * are updated, moved and erased subtrees are unlinked, and moved and inserted subtrees are linked in order of
+     * position, one walk over the children of every parent involved. Cost grows with the size of the script and of the
+     * sibling lists it touches, not with the size of the tree. An insertion under the root, when the tree is empty or
+     * the script erases the root, creates the new root.
+     * @param script The operations to apply.
+     * @throws std::invalid_argument If a path is not in the tree, an update has not exactly one value, an inserted
+     * subtree is malformed, a position is out of range, or operations conflict (a node removed twice, or touched
+     * inside a removed subtree). The tree is unchanged in that case. Rethrows the exceptions thrown by the copy
+     * constructor and copy assignment of T.
+     */
+    void apply(const edit_script& script)
+    {
+        // the children of every node on a path are remembered up to the furthest index looked up, so many paths
+        // through the same wide node walk its sibling list once
+        std::unordered_map<const private_node*, std::vector<private_node*>> known_children;
+        auto resolve = [this, &known_children](const std::vector<std::size_t>& path) {
+            private_node* current = m_root;
+            for (std::size_t index : path)
+            {
+                if (current == nullptr)
+                    break;
+                std::vector<private_node*>& children = known_children[current];
+                if (children.empty() && current->m_left_child != nullptr)
+                    children.push_back(current->m_left_child);
+                while (!children.empty() && children.size() <= index && children.back()->m_right_sibling != nullptr)
+                    children.push_back(children.back()->m_right_sibling);
+                current = index < children.size() ? children[index] : nullptr;
+            }
+            if (current == nullptr)
+                throw std::invalid_argument("Edit path not in the tree");
+            return current;
+        };
+
+        struct attachment
+        {
+            private_node* m_parent;
+            std::size_t m_position;
+            private_node* m_moved;
+            general_tree m_inserted;
+        };
+        std::vector<std::pair<private_node*, const T*>> updates;
+        std::vector<private_node*> erased;
+        std::vector<private_node*> moved;
+        std::vector<attachment> attachments;
+
+        for (const edit_operation& op : script)
+        {
+            switch (op.kind)
+            {
+            case edit_kind::update:
+                if (op.values.size() != 1)
+                    throw std::invalid_argument("Update without exactly one value");
+                updates.emplace_back(resolve(op.path), &op.values.front());
+                break;
+            case edit_kind::erase:
+                erased.push_back(resolve(op.path));
+                break;
+            case edit_kind::move:
+            {
+                private_node* source = resolve(op.path);
+                if (source == m_root)
+                    throw std::invalid_argument("Cannot move the root");
+                moved.push_back(source);
+                attachments.push_back({resolve(op.parent), op.position, source, general_tree()});
+                break;
+            }
+            case edit_kind::insert:
+            {
+                private_node* parent = op.parent.empty() ? m_root : resolve(op.parent);
+                attachments.push_back({parent, op.position, nullptr, import_columns(op.parent_index, op.values)});
+                if (attachments.back().m_inserted.empty())
+                    throw std::invalid_argument("Empty inserted subtree");
+                break;
+            }
+            default:
+                throw std::invalid_argument("Unknown edit kind");
+            }
+        }
+
+        // nothing may be removed twice, or touched inside a removed subtree
+        std::unordered_map<private_node*, std::size_t> removed_children;
+        std::unordered_set<const private_node*> removed;
+        for (const std::vector<private_node*>* list : {&erased, &moved})
+        {
+            for (private_node* pnode : *list)
+            {
+                if (!removed.insert(pnode).second)
+                    throw std::invalid_argument("Node removed twice by the edit script");
+                ++removed_children[pnode->m_parent];
+            }
+        }
+        auto inside_removed = [&removed](const private_node* pnode) {
+            for (; pnode != nullptr; pnode = pnode->m_parent)
+            {
+                if (removed.contains(pnode))
+                    return true;
+            }
+            return false;
+        };
+        for (const private_node* pnode : removed)
+        {
+            if (inside_removed(pnode->m_parent))
+                throw std::invalid_argument("Edit inside a removed subtree");
+        }
+        for (const auto& [target, value] : updates)
+        {
+            if (inside_removed(target))
+                throw std::invalid_argument("Edit inside a removed subtree");
+        }
+
+        const bool root_replaced = m_root == nullptr || removed.contains(m_root);
+        bool has_new_root = false;
+        for (attachment& entry : attachments)
+        {
+            if (entry.m_parent == m_root && root_replaced)
+            {
+                if (entry.m_moved != nullptr || has_new_root)
+                    throw std::invalid_argument("Edit script with more than one root");
+                entry.m_parent = nullptr;
+                has_new_root = true;
+            }
+            else if (inside_removed(entry.m_parent))
+                throw std::invalid_argument("Edit inside a removed subtree");
+        }
+
+        // inserting in order of position, every position must fall within the children present at that point
+        std::stable_sort(attachments.begin(), attachments.end(), [](const attachment& lhs, const attachment& rhs) {
+            return lhs.m_parent != rhs.m_parent ? std::less<private_node*>()(lhs.m_parent, rhs.m_parent)
+                                                : lhs.m_position < rhs.m_position;
+        });
+        for (std::size_t begin = 0, end = 0; begin < attachments.size(); begin = end)
+        {
+            private_node* parent = attachments[begin].m_parent;
+            while (end < attachments.size() && attachments[end].m_parent == parent)
+                ++end;
+            if (parent == nullptr)
+                continue;
+
+            std::size_t present = 0;
+            for (private_node* child = parent->m_left_child; child != nullptr; child = child->m_right_sibling)
+                ++present;
+            auto it = removed_children.find(parent);
+            present -= it == removed_children.end() ? 0 : it->second;
+            for (std::size_t k = begin; k < end; k++)
+            {
+                if ((k > begin && attachments[k].m_position == attachments[k - 1].m_position) ||
+                    attachments[k].m_position > present + (k - begin))
+                    throw std::invalid_argument("Edit position out of range");
+            }
+        }
+
+        for (const auto& [target, value] : updates)
+            target->m_data = *value;
+
+        // one walk per sibling list drops all of its removed children
+        for (const auto& entry : removed_children)
+        {
+            if (entry.first == nullptr)
+            {
+                m_root = nullptr;
+                continue;
+            }
+            private_node** link = &entry.first->m_left_child;
+            while (*link != nullptr)
+            {
+                if (removed.contains(*link))
+                    *link = (*link)->m_right_sibling;
+                else
+                    link = &(*link)->m_right_sibling;
+            }
+        }
+        for (private_node* pnode : moved)
+        {
+            pnode->m_parent = nullptr;
+            pnode->m_right_sibling = nullptr;
+        }
+        for (private_node* pnode : erased)
+            destroy_subtree(pnode);
+
+        for (std::size_t begin = 0, end = 0; begin < attachments.size(); begin = end)
+        {
+            private_node* parent = attachments[begin].m_parent;
+            private_node* previous = nullptr;
+            private_node* current = parent == nullptr ? nullptr : parent->m_left_child;
+            std::size_t index = 0;
+            for (end = begin; end < attachments.size() && attachments[end].m_parent == parent; end++)
+            {
+                attachment& entry = attachments[end];
+                for (; index < entry.m_position && parent != nullptr; index++)
+                {
+                    previous = current;
+                    current = current->m_right_sibling;
+                }
+
+                private_node* pnode = entry.m_moved;
+                if (pnode == nullptr)
+                {
+                    pnode = std::exchange(entry.m_inserted.m_root, nullptr);
+                    m_size += std::exchange(entry.m_inserted.m_size, 0);
+                }
+
+                pnode->m_parent = parent;
+                pnode->m_right_sibling = current;
+                if (parent == nullptr)
+                    m_root = pnode;
+                else if (previous == nullptr)
+                    parent->m_left_child = pnode;
+                else
+                    previous->m_right_sibling = pnode;
+                previous = pnode;
+                ++index;
+            }
+        }
+    }
+
+    /**
+     * @brief Tree whose modifications are appended to a write-ahead log, with periodic checkpoints.
+     * @details Every insertion and deletion made through the journaled tree appends a record to the log file: the
+     * operation, the id of the node it applies to and, for insertions, the encoded value, framed by its length and a
+     * checksum. An inserted subtree is logged as a single record holding the subtree in the format of save().
+     * checkpoint() writes the whole tree in the format of save() and starts an empty log. On construction the last
+     * checkpoint is loaded and the log is replayed on top of it; a torn or corrupted record at the end of the log, left
+     * by a crash while it was being appended, is discarded together with anything after it. Records are buffered by the
+     * file stream until sync(), checkpoint() or destruction. Values modified in place through node handles are not
+     * logged.
+     */
+    template <typename Codec = default_codec>
+    class journaled_tree
+    {
+    private:
+        static constexpr char log_magic[4] = {'G', 'T', 'R', 'L'};
+        static constexpr std::uint8_t log_version = 1;
+
+        enum class record_type : std::uint8_t
+        {
+            emplace_root = 0,
+            emplace_left_child = 1,
+            emplace_right_sibling = 2,
+            delete_left_child = 3,
+            delete_right_sibling = 4,
+            clear = 5,
+            insert_left_subtree = 6,
+            insert_right_subtree = 7
+        };
+
+        // input stream buffer over a record already in memory
+        class record_buffer : public std::streambuf
+        {
+        public:
+            void reset(char* data, std::size_t size) noexcept
+            {
+                setg(data, data, data + size);
+            }
+        };
+
+        general_tree m_tree;
+        Codec m_codec;
+        std::string m_checkpoint_path;
+        std::string m_log_path;
+        std::ofstream m_log;
+        std::ostringstream m_record;
+        // ids are assigned in preorder when a checkpoint is written or loaded, then in creation order
+        std::unordered_map<const private_node*, std::uint64_t> m_ids;
+        std::uint64_t m_next_id = 0;
+        std::uint64_t m_generation = 0;
+        std::uint64_t m_records = 0;
+
+        // FNV-1a
+        static std::uint32_t checksum(std::string_view bytes) noexcept
+        {
+            std::uint32_t hash = 2166136261u;
+            for (char byte : bytes)
+                hash = (hash ^ static_cast<std::uint8_t>(byte)) * 16777619u;
+            return hash;
+        }
+
+        static std::uint64_t varint_size(std::uint64_t value) noexcept
+        {
+            std::uint64_t size = 1;
+            for (; value >= 0x80; value >>= 7)
+                ++size;
+            return size;
+        }
+
+        std::uint64_t id_of(node n) const
+        {
+            if (n.m_node == nullptr)
+                throw std::invalid_argument("Cannot use null node");
+
+            const auto it = m_ids.find(n.m_node);
+            if (it == m_ids.end())
+                throw std::invalid_argument("Node does not belong to the journaled tree");
+            return it->second;
+        }
+
+        // - calls visit on every node of the subtree rooted at pnode in preorder, without its right siblings
+        template <typename Visit>
+        static void for_each_in_subtree(private_node* pnode, Visit&& visit)
+        {
+            private_node* current = pnode;
+            while (current != nullptr)
+            {
+                visit(current);
+                if (current->m_left_child != nullptr)
+                {
+                    current = current->m_left_child;
+                    continue;
+                }
+
+                while (current != pnode && current->m_right_sibling == nullptr)
+                    current = current->m_parent;
+                current = (current == pnode) ? nullptr : current->m_right_sibling;
+            }
+        }
+
+        // - forgets the ids of the subtree rooted at pnode, without its right siblings
+        // - clears the corresponding entries of nodes_by_id when replaying
+        void forget_subtree(private_node* pnode, std::vector<private_node*>* nodes_by_id) noexcept
+        {
+            for_each_in_subtree(pnode, [&](private_node* current) {
+                const auto it = m_ids.find(current);
+                if (nodes_by_id != nullptr)
+                    (*nodes_by_id)[it->second] = nullptr;
+                m_ids.erase(it);
+            });
+        }
+
+        // - numbers the nodes in preorder, starting at 0
+        void renumber(std::vector<private_node*>* nodes_by_id)
+        {
+            m_ids.clear();
+            m_ids.reserve(m_tree.m_size);
+            m_next_id = 0;
+            for (private_node* current = m_tree.m_root; current != nullptr;)
+            {
+                m_ids.emplace(current, m_next_id++);
+                if (nodes_by_id != nullptr)
+                    nodes_by_id->push_back(current);
+
+                if (current->m_left_child != nullptr)
+                {
+                    current = current->m_left_child;
+                    continue;
+                }
+
+                while (current != nullptr && current->m_right_sibling == nullptr)
+                    current = current->m_parent;
+                if (current != nullptr)
+                    current = current->m_right_sibling;
+            }
+        }
+
+        // - gives the next ids in preorder to the subtree rooted at pnode, without its right siblings
+        // - appends its nodes to nodes_by_id when replaying; no id is kept if either fails
+        void register_subtree(private_node* pnode, std::vector<private_node*>* nodes_by_id)
+        {
+            const std::uint64_t first_id = m_next_id;
+            const std::size_t first_index = nodes_by_id != nullptr ? nodes_by_id->size() : 0;
+            try
+            {
+                for_each_in_subtree(pnode, [&](private_node* current) {
+                    m_ids.emplace(current, m_next_id);
+                    if (nodes_by_id != nullptr)
+                        nodes_by_id->push_back(current);
+                    ++m_next_id;
+                });
+            }
+            catch (...)
+            {
+                // erasing a node that got no id does nothing
+                for_each_in_subtree(pnode, [this](private_node* current) { m_ids.erase(current); });
+                if (nodes_by_id != nullptr)
+                    nodes_by_id->resize(first_index);
+                m_next_id = first_id;
+                throw;
+            }
+        }
+
+        // - appends a record to the log; value is null for deletions, subtree is null except for subtree insertions
+        // - a log that failed once stays unusable, since a partial record may have been written
+        void append_record(
+            record_type type, std::uint64_t target, const T* value, const general_tree* subtree = nullptr
+        )
+        {
+            if (!m_log)
+                throw std::runtime_error("Failed to write to log");
+
+            m_record.str(std::string());
+            {
+                binary_writer writer(m_record);
+                writer.write_byte(static_cast<std::uint8_t>(type));
+                writer.write_varint(target);
+                if (value != nullptr)
+                    m_codec.encode(writer, *value);
+            }
+            if (subtree != nullptr)
+                subtree->save(m_record, m_codec);
+
+            const std::string_view payload = m_record.view();
+            const std::uint32_t hash = checksum(payload);
+            const std::uint8_t hash_bytes[4] = {
+                static_cast<std::uint8_t>(hash), static_cast<std::uint8_t>(hash >> 8),
+                static_cast<std::uint8_t>(hash >> 16), static_cast<std::uint8_t>(hash >> 24)
+            };
+
+            try
+            {
+                binary_writer writer(m_log);
+                writer.write_varint(payload.size());
+                writer.write_bytes(payload.data(), payload.size());
+                writer.write_bytes(hash_bytes, sizeof(hash_bytes));
+            }
+            catch (...)
+            {
+                m_log.setstate(std::ios::badbit);
+                throw;
+            }
+            ++m_records;
+        }
+
+        // - registers a node created by the tree, and logs its creation unless replaying
+        // - the node is removed again if either fails
+        void register_created(record_type type, std::uint64_t target, private_node* created, bool log)
+        {
+            try
+            {
+                m_ids.emplace(created, m_next_id);
+                if (log)
+                    append_record(type, target, &created->m_data);
+                ++m_next_id;
+            }
+            catch (...)
+            {
+                m_ids.erase(created);
+                m_tree.delete_from_node(created);
+                if (type == record_type::emplace_root)
+                    m_tree.m_root = nullptr;
+                throw;
+            }
+        }
+
+        // - gives ids to the nodes of a subtree about to be inserted, then logs the insertion
+        // - the ids are dropped again if the record cannot be written
+        void log_subtree(record_type type, std::uint64_t target, const general_tree& subtree)
+        {
+            const std::uint64_t first_id = m_next_id;
+            register_subtree(subtree.m_root, nullptr);
+            try
+            {
+                append_record(type, target, nullptr, &subtree);
+            }
+            catch (...)
+            {
+                for_each_in_subtree(subtree.m_root, [this](private_node* current) { m_ids.erase(current); });
+                m_next_id = first_id;
+                throw;
+            }
+        }
+
+        // - creates a log file holding only the header of the given generation
+        static std::ofstream start_log(const std::string& path, std::uint64_t generation)
+        {
+            std::ofstream log(path, std::ios::binary | std::ios::trunc);
+            if (!log)
+                throw std::runtime_error("Cannot open " + path);
+
+            binary_writer writer(log);
+            writer.write_bytes(log_magic, sizeof(log_magic));
+            writer.write_byte(log_version);
+            writer.write_varint(generation);
+            writer.flush();
+            return log;
+        }
+
+        // - applies the records of the log that belong to the current checkpoint
+        // - returns the size of the valid prefix of the log, or 0 if the log must be started again
+        std::uint64_t replay(std::vector<private_node*>& nodes_by_id)
+        {
+            std::ifstream log(m_log_path, std::ios::binary);
+            if (!log)
+                return 0;
 
-        if (destiny.m_node->m_parent == nullptr)
-            throw std::invalid_argument("Cannot insert right sibling to root");
+            const std::uint64_t log_size = std::filesystem::file_size(m_log_path);
+            binary_reader reader(log);
+            std::uint64_t offset = 0;
+            try
+            {
+                char magic[sizeof(log_magic)];
+                reader.read_bytes(magic, sizeof(magic));
+                if (!std::equal(std::begin(magic), std::end(magic), std::begin(log_magic)) ||
+                    reader.read_byte() != log_version)
+                    return 0;
 
-        private_node* new_node = new private_node(std::forward<Args>(args)...);
-        new_node->m_parent = destiny.m_node->m_parent;
-        new_node->m_right_sibling = destiny.m_node->m_right_sibling;
-        destiny.m_node->m_right_sibling = new_node;
-        return new_node;
-    }
+                // the log of an older checkpoint: a crash happened between the checkpoint and the new log
+                const std::uint64_t generation = reader.read_varint();
+                if (generation != m_generation)
+                    return 0;
+                offset = sizeof(log_magic) + 1 + varint_size(generation);
+            }
+            catch (const std::runtime_error&)
+            {
+                return 0;
+            }
+
+            std::string payload;
+            record_buffer buffer;
+            std::istream payload_stream(&buffer);
+
+            while (offset < log_size)
+            {
+                // a torn record ends the log
+                std::uint64_t length = 0;
+                std::uint64_t record_size = 0;
+                try
+                {
+                    length = reader.read_varint();
+                    record_size = varint_size(length) + length + 4;
+                    if (record_size > log_size - offset)
+                        break;
+
+                    payload.resize(static_cast<std::size_t>(length));
+                    reader.read_bytes(payload.data(), payload.size());
+                    std::uint8_t hash_bytes[4];
+                    reader.read_bytes(hash_bytes, sizeof(hash_bytes));
+                    const std::uint32_t hash = std::uint32_t(hash_bytes[0]) | std::uint32_t(hash_bytes[1]) << 8 |
+                                               std::uint32_t(hash_bytes[2]) << 16 | std::uint32_t(hash_bytes[3]) << 24;
+                    if (hash != checksum(payload))
+                        break;
+                }
+                catch (const std::runtime_error&)
+                {
+                    break;
+                }
+
+                buffer.reset(payload.data(), payload.size());
+                apply_record(payload_stream, nodes_by_id);
+                offset += record_size;
+            }
+
+            return offset;
+        }
+
+        // - applies one logged operation
+        // - throws std::runtime_error if it does not match the tree, since its checksum was valid
+        void apply_record(std::istream& payload, std::vector<private_node*>& nodes_by_id)
+        {
+            binary_reader record(payload);
+            const auto type = static_cast<record_type>(record.read_byte());
+            const std::uint64_t target = record.read_varint();
+
+            if (type == record_type::clear)
+            {
+                m_tree.clear();
+                m_ids.clear();
+                std::fill(nodes_by_id.begin(), nodes_by_id.end(), nullptr);
+                return;
+            }
+
+            private_node* destiny = nullptr;
+            if (type == record_type::emplace_root)
+            {
+                if (m_tree.m_root != nullptr)
+                    throw std::runtime_error("Malformed general_tree log");
+            }
+            else
+            {
+                if (target >= nodes_by_id.size() || nodes_by_id[target] == nullptr)
+                    throw std::runtime_error("Malformed general_tree log");
+                destiny = nodes_by_id[target];
+                if (destiny->m_parent == nullptr &&
+                    (type == record_type::emplace_right_sibling || type == record_type::delete_right_sibling ||
+                     type == record_type::insert_right_subtree))
+                    throw std::runtime_error("Malformed general_tree log");
+            }
+
+            node created;
+            switch (type)
+            {
+            case record_type::emplace_root:
+                created = m_tree.emplace_root(m_codec.decode(record));
+                break;
+            case record_type::emplace_left_child:
+                created = m_tree.emplace_left_child(destiny, m_codec.decode(record));
+                break;
+            case record_type::emplace_right_sibling:
+                created = m_tree.emplace_right_sibling(destiny, m_codec.decode(record));
+                break;
+            case record_type::delete_left_child:
+                forget_subtree(destiny->m_left_child, &nodes_by_id);
+                m_tree.delete_left_child(destiny);
+                return;
+            case record_type::delete_right_sibling:
+                forget_subtree(destiny->m_right_sibling, &nodes_by_id);
+                m_tree.delete_right_sibling(destiny);
+                return;
+            case record_type::insert_left_subtree:
+            case record_type::insert_right_subtree:
+            {
+                general_tree subtree = general_tree::load(payload, m_codec);
+                if (subtree.m_root == nullptr)
+                    throw std::runtime_error("Malformed general_tree log");
+                created = type == record_type::insert_left_subtree ? m_tree.insert_left_child(destiny, subtree)
+                                                                   : m_tree.insert_right_sibling(destiny, subtree);
+                register_subtree(created.m_node, &nodes_by_id);
+                return;
+            }
+            default:
+                throw std::runtime_error("Malformed general_tree log");
+            }
+
+            register_created(type, target, created.m_node, false);
+            nodes_by_id.push_back(created.m_node);
+        }
+
+    public:
+        /**
+         * @brief Opens a journaled tree, recovering the state left by a previous instance if any.
+         * @param checkpoint_path File holding the last checkpoint. A missing file stands for an empty tree.
+         * @param log_path File holding the log. Created if missing; records that do not apply to the checkpoint are
+         * discarded.
+         * @param codec Object providing encode(binary_writer&, const T&) and T decode(binary_reader&).
+         * @throws std::runtime_error If the checkpoint is malformed, the log contradicts it, or a file cannot be
+         * opened. Rethrows the exceptions thrown by the codec.
+         */
+        journaled_tree(std::string checkpoint_path, std::string log_path, Codec codec = Codec())
+            : m_codec(std::move(codec)), m_checkpoint_path(std::move(checkpoint_path)), m_log_path(std::move(log_path))
+        {
+            std::ifstream checkpoint(m_checkpoint_path, std::ios::binary);
+            if (checkpoint)
+            {
+                binary_reader reader(checkpoint);
+                m_generation = reader.read_varint();
+                m_tree = general_tree::load(checkpoint, m_codec);
+            }
+
+            std::vector<private_node*> nodes_by_id;
+            renumber(&nodes_by_id);
+            const std::uint64_t valid_size = replay(nodes_by_id);
+
+            if (valid_size == 0)
+            {
+                m_log = start_log(m_log_path, m_generation);
+                return;
+            }
+
+            // drop the torn tail before appending after it
+            if (valid_size < std::filesystem::file_size(m_log_path))
+                std::filesystem::resize_file(m_log_path, valid_size);
+            m_log.open(m_log_path, std::ios::binary | std::ios::app);
+            if (!m_log)
+                throw std::runtime_error("Cannot open " + m_log_path);
+        }
+
+        journaled_tree(const journaled_tree&) = delete;
+        journaled_tree& operator=(const journaled_tree&) = delete;
+
+        /**
+         * @brief Returns the tree. It must only be modified through the journaled tree.
+         */
+        [[nodiscard]] const general_tree& tree() const noexcept
+        {
+            return m_tree;
+        }
+
+        [[nodiscard]] node root() const noexcept
+        {
+            return m_tree.m_root;
+        }
+
+        [[nodiscard]] std::size_t size() const noexcept
+        {
+            return m_tree.m_size;
+        }
+
+        bool empty() const noexcept
+        {
+            return m_tree.m_root == nullptr;
+        }
+
+        /**
+         * @brief Returns the number of records appended to the log since the last checkpoint.
+         */
+        [[nodiscard]] std::uint64_t records_since_checkpoint() const noexcept
+        {
+            return m_records;
+        }
+
+        /**
+         * @brief Same as general_tree::emplace_root, logged.
+         * @throws std::runtime_error If a root node already exists or the log cannot be written.
+         */
+        template <typename... Args>
+        node emplace_root(Args&&... args)
+        {
+            node created = m_tree.emplace_root(std::forward<Args>(args)...);
+            register_created(record_type::emplace_root, 0, created.m_node, true);
+            return created;
+        }
+
+        /**
+         * @brief Same as general_tree::emplace_left_child, logged.
+         * @throws std::invalid_argument If the node is null or does not belong to the tree.
+         * @throws std::runtime_error If the log cannot be written; the tree is left unchanged.
+         */
+        template <typename... Args>
+        node emplace_left_child(node destiny, Args&&... args)
+        {
+            const std::uint64_t target = id_of(destiny);
+            node created = m_tree.emplace_left_child(destiny, std::forward<Args>(args)...);
+            register_created(record_type::emplace_left_child, target, created.m_node, true);
+            return created;
+        }
+
+        /**
+         * @brief Same as general_tree::emplace_right_sibling, logged.
+         * @throws std::invalid_argument If the node is null, is the root or does not belong to the tree.
+         * @throws std::runtime_error If the log cannot be written; the tree is left unchanged.
+         */
+        template <typename... Args>
+        node emplace_right_sibling(node destiny, Args&&... args)
+        {
+            const std::uint64_t target = id_of(destiny);
+            node created = m_tree.emplace_right_sibling(destiny, std::forward<Args>(args)...);
+            register_created(record_type::emplace_right_sibling, target, created.m_node, true);
+            return created;
+        }
+
+        template <typename U, typename = std::enable_if_t<std::is_convertible_v<U, T>>>
+        node insert_left_child(node destiny, U&& new_node_value)
+        {
+            return emplace_left_child(destiny, std::forward<U>(new_node_value));
+        }
+
+        template <typename U, typename = std::enable_if_t<std::is_convertible_v<U, T>>>
+        node insert_right_sibling(node destiny, U&& new_node_value)
+        {
+            return emplace_right_sibling(destiny, std::forward<U>(new_node_value));
+        }
+
+        /**
+         * @brief Same as general_tree::insert_left_child for an entire subtree, logged as one record holding it.
+         * @return node A handle to the root of the inserted subtree, or a null node if the subtree is empty.
+         * @throws std::invalid_argument If the node is null or does not belong to the tree.
+         * @throws std::runtime_error If the log cannot be written; the tree and the subtree are left unchanged.
+         * Rethrows the exceptions thrown by the codec.
+         */
+        node insert_left_child(node destiny, general_tree& subtree)
+        {
+            const std::uint64_t target = id_of(destiny);
+            if (subtree.m_root == nullptr)
+                return node(nullptr);
+
+            log_subtree(record_type::insert_left_subtree, target, subtree);
+            return m_tree.insert_left_child(destiny, subtree);
+        }
+
+        /**
+         * @brief Same as general_tree::insert_right_sibling for an entire subtree, logged as one record holding it.
+         * @return node A handle to the root of the inserted subtree, or a null node if the subtree is empty.
+         * @throws std::invalid_argument If the node is null, is the root or does not belong to the tree.
+         * @throws std::runtime_error If the log cannot be written; the tree and the subtree are left unchanged.
+         * Rethrows the exceptions thrown by the codec.
+         */
+        node insert_right_sibling(node destiny, general_tree& subtree)
+        {
+            const std::uint64_t target = id_of(destiny);
+            if (destiny.is_root())
+                throw std::invalid_argument("Cannot insert right sibling to root");
+            if (subtree.m_root == nullptr)
+                return node(nullptr);
+
+            log_subtree(record_type::insert_right_subtree, target, subtree);
+            return m_tree.insert_right_sibling(destiny, subtree);
+        }
+
+        /**
+         * @brief Same as general_tree::delete_left_child, logged.
+         * @throws std::invalid_argument If the node is null or does not belong to the tree.
+         * @throws std::runtime_error If the log cannot be written; the tree is left unchanged.
+         */
+        void delete_left_child(node n)
+        {
+            const std::uint64_t target = id_of(n);
+            if (n.m_node->m_left_child == nullptr)
+                return;
+
+            append_record(record_type::delete_left_child, target, nullptr);
+            forget_subtree(n.m_node->m_left_child, nullptr);
+            m_tree.delete_left_child(n);
+        }
+
+        /**
+         * @brief Same as general_tree::delete_right_sibling, logged.
+         * @throws std::invalid_argument If the node is null, is the root or does not belong to the tree.
+         * @throws std::runtime_error If the log cannot be written; the tree is left unchanged.
+         */
+        void delete_right_sibling(node n)
+        {
+            const std::uint64_t target = id_of(n);
+            if (n.is_root())
+                throw std::invalid_argument("Can not delete right sibling of root node");
+            if (n.m_node->m_right_sibling == nullptr)
+                return;
+
+            append_record(record_type::delete_right_sibling, target, nullptr);
+            forget_subtree(n.m_node->m_right_sibling, nullptr);
+            m_tree.delete_right_sibling(n);
+        }
+
+        /**
+         * @brief Same as general_tree::clear, logged.
+         * @throws std::runtime_error If the log cannot be written; the tree is left unchanged.
+         */
+        void clear()
+        {
+            append_record(record_type::clear, 0, nullptr);
+            m_tree.clear();
+            m_ids.clear();
+        }
+
+        /**
+         * @brief Flushes the buffered records to the log file.
+         * @throws std::runtime_error If the log cannot be written.
+         */
+        void sync()
+        {
+            if (!m_log.flush())
+                throw std::runtime_error("Failed to write to log");
+        }
+
+        /**
+         * @brief Writes the whole tree to the checkpoint file and starts an empty log.
+         * @details The checkpoint and the new log are written to temporary files that then replace the previous ones,
+         * checkpoint first. The log is tagged with the checkpoint it follows, so a crash at any point recovers either
+         * the previous checkpoint with its log or the new checkpoint.
+         * @throws std::runtime_error If a file cannot be written or replaced. If the new checkpoint was not in place
+         * yet, the previous checkpoint and log stay in use. Otherwise the log is left unusable: every later
+         * modification throws std::runtime_error without changing the tree, and opening the files again recovers the
+         * new checkpoint. Rethrows the exceptions thrown by the codec.
+         */
+        void checkpoint()
+        {
+            const std::string checkpoint_temporary = m_checkpoint_path + ".tmp";
+            const std::string log_temporary = m_log_path + ".tmp";
+            {
+                std::ofstream checkpoint(checkpoint_temporary, std::ios::binary | std::ios::trunc);
+                if (!checkpoint)
+                    throw std::runtime_error("Cannot open " + checkpoint_temporary);
+
+                binary_writer writer(checkpoint);
+                writer.write_varint(m_generation + 1);
+                m_tree.save(checkpoint, m_codec);
+            }
+            std::ofstream log = start_log(log_temporary, m_generation + 1);
+            std::filesystem::rename(checkpoint_temporary, m_checkpoint_path);
+
+            // the records of the previous log are in the new checkpoint: until the new log replaces it, nothing can
+            // be appended
+            m_log.close();
+            m_log.setstate(std::ios::badbit);
+            ++m_generation;
+            renumber(nullptr);
+            std::filesystem::rename(log_temporary, m_log_path);
+            m_log = std::move(log);
+            m_records = 0;
+        }
+    };
 
     /**
-     * @brief Inserts a new right sibling node for the given destination node, with the provided value.
-     * @param destiny The node to which the right sibling will be inserted.
-     * @param new_node_value The value to store in the newly created right sibling node.
-     * @return node A handle to the newly created right sibling node.
-     * @throws std::invalid_argument If the destination node is null or is the root (cannot have a sibling).
+     * @brief Buffered text output used by write_ascii(), write_dot() and value formatters.
+     * @details Text is gathered in a fixed-size buffer and handed to the stream buffer in large blocks, so writing a
+     * line costs no formatted stream call. Numbers are formatted with std::to_chars.
      */
-    template <typename U, typename = std::enable_if_t<std::is_convertible_v<U, T>>>
-    node insert_right_sibling(node destiny, U&& new_node_value)
+    class text_writer
     {
-        return emplace_right_sibling(destiny, std::forward<U>(new_node_value));
-    }
+    private:
+        friend class general_tree;
+
+        std::ostream& m_stream;
+        std::array<char, 16 * 1024> m_buffer;
+        std::size_t m_used = 0;
+        // set while writing DOT labels: quotes, backslashes and line breaks are escaped
+        bool m_escape = false;
+        std::ostringstream m_scratch;
+
+        void flush_buffer()
+        {
+            const auto count = static_cast<std::streamsize>(m_used);
+            if (m_stream.rdbuf()->sputn(m_buffer.data(), count) != count)
+                throw std::runtime_error("Failed to write to stream");
+            m_used = 0;
+        }
+
+        void put(char c)
+        {
+            if (m_used == m_buffer.size())
+                flush_buffer();
+            m_buffer[m_used++] = c;
+        }
+
+        void append(std::string_view text)
+        {
+            while (!text.empty())
+            {
+                if (m_used == m_buffer.size())
+                    flush_buffer();
+                const std::size_t count = std::min(text.size(), m_buffer.size() - m_used);
+                std::copy_n(text.data(), count, m_buffer.data() + m_used);
+                m_used += count;
+                text.remove_prefix(count);
+            }
+        }
+
+    public:
+        explicit text_writer(std::ostream& stream) : m_stream(stream) {}
+
+        text_writer(const text_writer&) = delete;
+        text_writer& operator=(const text_writer&) = delete;
+
+        /**
+         * @throws std::runtime_error If the stream fails.
+         */
+        void write(char c)
+        {
+            if (!m_escape)
+                put(c);
+            else if (c == '"' || c == '\\')
+            {
+                put('\\');
+                put(c);
+            }
+            else if (c == '\n')
+            {
+                put('\\');
+                put('n');
+            }
+            else if (c != '\r')
+                put(c);
+        }
+
+        /**
+         * @throws std::runtime_error If the stream fails.
+         */
+        void write(std::string_view text)
+        {
+            if (!m_escape)
+            {
+                append(text);
+                return;
+            }
+
+            // runs without characters to escape are copied at once
+            while (!text.empty())
+            {
+                const std::size_t special = std::min(text.find_first_of("\"\\\n\r"), text.size());
+                append(text.substr(0, special));
+                if (special == text.size())
+                    return;
+                write(text[special]);
+                text.remove_prefix(special + 1);
+            }
+        }
+
+        /**
+         * @brief Writes an integer or floating-point number in its shortest form.
+         * @throws std::runtime_error If the stream fails.
+         */
+        template <typename Number>
+        void write_number(Number value)
+        {
+            char digits[64];
+            const auto result = std::to_chars(std::begin(digits), std::end(digits), value);
+            write(std::string_view(digits, static_cast<std::size_t>(result.ptr - digits)));
+        }
+
+        /**
+         * @brief Writes any value through its operator<<, formatted in a reused string stream.
+         * @throws std::runtime_error If the stream fails.
+         */
+        template <typename Value>
+        void write_streamed(const Value& value)
+        {
+            m_scratch.str(std::string());
+            m_scratch << value;
+            write(m_scratch.view());
+        }
+
+        /**
+         * @brief Hands the buffered text to the stream and flushes it.
+         * @throws std::runtime_error If the stream fails.
+         */
+        void flush()
+        {
+            flush_buffer();
+            if (!m_stream.flush())
+                throw std::runtime_error("Failed to write to stream");
+        }
+    };
 
     /**
-     * @brief Returns the root node of the tree.
+     * @brief Value formatter used when none is given to write_ascii() and write_dot().
+     * @details Characters and strings are written as they are, booleans as true/false, numbers with std::to_chars and
+     * any other type through its operator<<. A custom formatter is any object providing
+     * operator()(text_writer&, const T&).
      */
-    [[nodiscard]] node root() const noexcept
+    struct default_formatter
     {
-        return m_root;
-    }
+        void operator()(text_writer& writer, const T& value) const
+        {
+            if constexpr (std::is_same_v<T, bool>)
+                writer.write(value ? std::string_view("true") : std::string_view("false"));
+            else if constexpr (std::is_same_v<T, char>)
+                writer.write(value);
+            else if constexpr (std::is_arithmetic_v<T>)
+                writer.write_number(value);
+            else if constexpr (std::is_convertible_v<const T&, std::string_view>)
+                writer.write(std::string_view(value));
+            else
+                writer.write_streamed(value);
+        }
+    };
 
     /**
-     * @brief Checks whether the tree is empty.
+     * @brief Draws the tree with box-drawing characters, one node per line, as in the README.
+     * @details Single stackless preorder pass. Besides the output buffer, the only state is the indentation of the
+     * current line, which grows by one segment when going down and is written with a single copy.
+     * @param stream The destination stream. The output is UTF-8.
+     * @param max_depth Nodes deeper than this are not written; 0 writes the root only.
+     * @param format Object providing operator()(text_writer&, const T&).
+     * @throws std::runtime_error If the stream fails. Rethrows the exceptions thrown by the formatter.
      */
-    bool empty() const noexcept
+    template <typename Formatter = default_formatter>
+    void write_ascii(
+        std::ostream& stream, std::size_t max_depth = std::numeric_limits<std::size_t>::max(),
+        Formatter format = Formatter()
+    ) const
     {
-        return m_root == nullptr;
+        // UTF-8 spelled out, so the output does not depend on the execution character set
+        static constexpr std::string_view vertical = "\xe2\x94\x82   ";
+        static constexpr std::string_view blank = "    ";
+        static constexpr std::string_view tee = "\xe2\x94\x9c\xe2\x94\x80\xe2\x94\x80 ";
+        static constexpr std::string_view corner = "\xe2\x94\x94\xe2\x94\x80\xe2\x94\x80 ";
+
+        text_writer writer(stream);
+        // one segment per ancestor below the root: vertical if its branch continues below, blank otherwise
+        std::string indentation;
+        std::size_t depth = 0;
+        for (const private_node* current = m_root; current != nullptr;)
+        {
+            if (depth > 0)
+            {
+                writer.write(indentation);
+                writer.write(current->m_right_sibling != nullptr ? tee : corner);
+            }
+            format(writer, current->m_data);
+            writer.write('\n');
+
+            if (current->m_left_child != nullptr && depth < max_depth)
+            {
+                if (depth > 0)
+                    indentation += current->m_right_sibling != nullptr ? vertical : blank;
+                ++depth;
+                current = current->m_left_child;
+                continue;
+            }
+
+            while (current != m_root && current->m_right_sibling == nullptr)
+            {
+                current = current->m_parent;
+                // both segments end with three spaces, only the blank one has a fourth
+                if (--depth > 0)
+                    indentation.resize(
+                        indentation.size() - (indentation[indentation.size() - 4] == ' ' ? blank : vertical).size()
+                    );
+            }
+            current = (current == m_root) ? nullptr : current->m_right_sibling;
+        }
+
+        writer.flush();
     }
 
     /**
-     * @brief Clears all nodes from the tree.
+     * @brief Writes the tree as a Graphviz digraph: one labelled vertex per node and one edge per parent-child link.
+     * @details Single stackless preorder pass. Vertices are named after their preorder index; the only state besides
+     * the output buffer is the index of every node on the path from the root.
+     * @param stream The destination stream.
+     * @param max_depth Nodes deeper than this are not written; 0 writes the root only.
+     * @param format Object providing operator()(text_writer&, const T&). Its output is escaped for DOT labels.
+     * @throws std::runtime_error If the stream fails. Rethrows the exceptions thrown by the formatter.
      */
-    void clear()
+    template <typename Formatter = default_formatter>
+    void write_dot(
+        std::ostream& stream, std::size_t max_depth = std::numeric_limits<std::size_t>::max(),
+        Formatter format = Formatter()
+    ) const
     {
-        delete_from_node(m_root);
-        m_root = nullptr;
-    }
+        text_writer writer(stream);
+        writer.write("digraph tree {\n");
 
-    void delete_right_sibling(node n)
-    {
-        if (n.is_null())
-            throw std::invalid_argument("Can not delete right sibling of null node");
+        std::vector<std::uint64_t> path;
+        std::uint64_t next_index = 0;
+        for (const private_node* current = m_root; current != nullptr;)
+        {
+            const std::uint64_t index = next_index++;
+            writer.write("  n");
+            writer.write_number(index);
+            writer.write(" [label=\"");
+            writer.m_escape = true;
+            format(writer, current->m_data);
+            writer.m_escape = false;
+            writer.write("\"];\n");
 
-        if (n.is_root())
-            throw std::invalid_argument("Can not delete right sibling of root node");
+            if (!path.empty())
+            {
+                writer.write("  n");
+                writer.write_number(path.back());
+                writer.write(" -> n");
+                writer.write_number(index);
+                writer.write(";\n");
+            }
 
-        delete_from_node(n.m_node->m_right_sibling);
-    }
+            if (current->m_left_child != nullptr && path.size() < max_depth)
+            {
+                path.push_back(index);
+                current = current->m_left_child;
+                continue;
+            }
 
-    void delete_left_child(node n)
-    {
-        if (n.is_null())
-            throw std::invalid_argument("Can not delete left child of null node");
+            while (current != m_root && current->m_right_sibling == nullptr)
+            {
+                current = current->m_parent;
+                path.pop_back();
+            }
+            current = (current == m_root) ? nullptr : current->m_right_sibling;
+        }
 
-        delete_from_node(n.m_node->m_left_child);
+        writer.write("}\n");
+        writer.flush();
     }
 
     ~general_tree()
@@ -0,0 +1,137 @@
+#include "general-tree.h"
+#include "utils/fixtures/lifecycle-counter.fixture.h"
+#include "utils/helpers/seed-tree.h"
+#include <doctest.h>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+TEST_CASE_FIXTURE(LifecycleCounterFixture, "general_tree::batch")
+{
+    SUBCASE("same result as applying the operations one by one")
+    {
+        general_tree<int> expected(0);
+        general_tree<int> gt(0);
+        std::vector<general_tree<int>::node> expected_nodes = {expected.root()};
+        std::vector<general_tree<int>::node> nodes = {gt.root()};
+
+        std::mt19937 rng(7);
+        auto batch = gt.batch();
+        for (int i = 1; i < 5000; i++)
+        {
+            // favour the last nodes so that consecutive insertions can be merged
+            std::uniform_int_distribution<std::size_t> recent(nodes.size() > 4 ? nodes.size() - 4 : 0, nodes.size() - 1);
+            std::uniform_int_distribution<std::size_t> any(0, nodes.size() - 1);
+            const std::size_t index = (rng() % 2 == 0) ? recent(rng) : any(rng);
+
+            if (index != 0 && rng() % 2 == 0)
+            {
+                expected_nodes.push_back(expected.emplace_right_sibling(expected_nodes[index], i));
+                nodes.push_back(batch.emplace_right_sibling(nodes[index], i));
+            }
+            else
+            {
+                expected_nodes.push_back(expected.emplace_left_child(expected_nodes[index], i));
+                nodes.push_back(batch.emplace_left_child(nodes[index], i));
+            }
+        }
+
+        REQUIRE_LT(batch.pending_operations(), 5000);
+        REQUIRE_EQ(gt.size(), 1);
+        batch.commit();
+        REQUIRE_EQ(gt.size(), expected.size());
+        REQUIRE(gt == expected);
+        REQUIRE_EQ(batch.pending_operations(), 0);
+    }
+
+    SUBCASE("consecutive insertions under the same parent are merged")
+    {
+        general_tree<int> gt(0);
+        auto batch = gt.batch();
+        for (int i = 1; i <= 100; i++)
+            batch.emplace_left_child(gt.root(), i);
+        REQUIRE_EQ(batch.pending_operations(), 1);
+        batch.commit();
+
+        int expected = 100;
+        bool ordered = true;
+        for (auto child : general_tree<int>::children(gt.root()))
+            ordered = ordered && child.data() == expected--;
+        REQUIRE(ordered);
+        REQUIRE_EQ(gt.size(), 101);
+    }
+
+    SUBCASE("appending siblings one after another is merged")
+    {
+        general_tree<int> gt(0);
+        auto batch = gt.batch();
+        auto last = batch.emplace_left_child(gt.root(), 1);
+        for (int i = 2; i <= 100; i++)
+            last = batch.emplace_right_sibling(last, i);
+        REQUIRE_EQ(batch.pending_operations(), 1);
+        batch.commit();
+
+        int expected = 1;
+        bool ordered = true;
+        for (auto child : general_tree<int>::children(gt.root()))
+            ordered = ordered && child.data() == expected++;
+        REQUIRE(ordered);
+        REQUIRE_EQ(expected, 101);
+    }
+
+    SUBCASE("deletions apply to the tree as it is at that point of the batch")
+    {
+        general_tree<LifecycleCounter> gt = seed_tree(10);
+        auto batch = gt.batch();
+        batch.emplace_left_child(gt.root(), "new", 100);
+        batch.delete_left_child(gt.root());
+        batch.delete_right_sibling(gt.root().left_child());
+        REQUIRE_EQ(LifecycleCounter::destructor_calls, 0);
+        batch.commit();
+
+        // the new node and the second original child (with its descendants) are gone
+        REQUIRE_EQ(gt.root().children_count(), 1);
+        REQUIRE_EQ(gt.root().left_child().data().get_int(), 1);
+        REQUIRE_EQ(gt.size(), 7);
+        REQUIRE_EQ(LifecycleCounter::destructor_calls, 4);
+    }
+
+    SUBCASE("nodes of a discarded batch are freed and the tree is untouched")
+    {
+        general_tree<LifecycleCounter> gt = seed_tree(10);
+        {
+            auto batch = gt.batch();
+            auto child = batch.emplace_left_child(gt.root(), "new", 100);
+            batch.emplace_left_child(child, "new", 101);
+            batch.emplace_right_sibling(child, "new", 102);
+            batch.delete_left_child(gt.root());
+        }
+        REQUIRE_EQ(LifecycleCounter::destructor_calls, 3);
+        REQUIRE_EQ(gt.size(), 10);
+        REQUIRE_EQ(gt.root().left_child().data().get_int(), 1);
+    }
+
+    SUBCASE("the batch can be reused after commit")
+    {
+        general_tree<int> gt(0);
+        auto batch = gt.batch();
+        batch.emplace_left_child(gt.root(), 1);
+        batch.commit();
+        batch.emplace_left_child(gt.root(), 2);
+        batch.commit();
+        REQUIRE_EQ(gt.size(), 3);
+        REQUIRE_EQ(gt.root().left_child().data(), 2);
+    }
+
+    SUBCASE("throw invalid argument on null or root nodes")
+    {
+        general_tree<int> gt(0);
+        auto batch = gt.batch();
+        CHECK_THROWS_AS(batch.emplace_left_child(nullptr, 1), std::invalid_argument);
+        CHECK_THROWS_AS(batch.emplace_right_sibling(nullptr, 1), std::invalid_argument);
+        CHECK_THROWS_AS(batch.emplace_right_sibling(gt.root(), 1), std::invalid_argument);
+        CHECK_THROWS_AS(batch.delete_left_child(nullptr), std::invalid_argument);
+        CHECK_THROWS_AS(batch.delete_right_sibling(gt.root()), std::invalid_argument);
+        REQUIRE_EQ(batch.pending_operations(), 0);
+    }
+}
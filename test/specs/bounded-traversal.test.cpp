@@ -0,0 +1,129 @@
+#include "general-tree.h"
+#include <doctest.h>
+#include <ranges>
+#include <stdexcept>
+#include <vector>
+
+static_assert(std::ranges::forward_range<general_tree<int>::bounded_preorder_view>);
+static_assert(std::ranges::input_range<general_tree<int>::bounded_level_order_view>);
+
+TEST_CASE("general_tree bounded traversals")
+{
+    /*
+            1
+          / | \
+         2  3  4
+        / \     \
+       5   6     7
+           |
+           8
+    */
+    general_tree<int> mytree;
+    mytree.create_root(1);
+    auto n2 = mytree.insert_left_child(mytree.root(), 2);
+    auto n3 = mytree.insert_right_sibling(n2, 3);
+    auto n4 = mytree.insert_right_sibling(n3, 4);
+    auto n5 = mytree.insert_left_child(n2, 5);
+    auto n6 = mytree.insert_right_sibling(n5, 6);
+    mytree.insert_left_child(n4, 7);
+    mytree.insert_left_child(n6, 8);
+
+    SUBCASE("bounded preorder")
+    {
+        SUBCASE("depth 0 yields only the subtree root")
+        {
+            const std::vector<int> expected_result = {1};
+            std::vector<int> traversal;
+            for (auto n : general_tree<int>::bounded_preorder(mytree.root(), 0))
+                traversal.push_back(n.data());
+            REQUIRE_EQ(expected_result, traversal);
+        }
+
+        SUBCASE("prunes below the maximum depth")
+        {
+            const std::vector<int> expected_result = {1, 2, 5, 6, 3, 4, 7};
+            std::vector<int> traversal;
+            for (auto n : general_tree<int>::bounded_preorder(mytree.root(), 2))
+                traversal.push_back(n.data());
+            REQUIRE_EQ(expected_result, traversal);
+        }
+
+        SUBCASE("a large maximum depth yields the full preorder")
+        {
+            std::vector<int> expected_result(mytree.begin(), mytree.end());
+            std::vector<int> traversal;
+            for (auto n : general_tree<int>::bounded_preorder(mytree.root(), 100))
+                traversal.push_back(n.data());
+            REQUIRE_EQ(expected_result, traversal);
+        }
+
+        SUBCASE("depths are relative to the subtree root")
+        {
+            const std::vector<int> expected_result = {2, 5, 6};
+            std::vector<int> traversal;
+            for (auto n : general_tree<int>::bounded_preorder(n2, 1))
+                traversal.push_back(n.data());
+            REQUIRE_EQ(expected_result, traversal);
+        }
+    }
+
+    SUBCASE("bounded level order")
+    {
+        SUBCASE("depth 0 yields only the subtree root")
+        {
+            const std::vector<int> expected_result = {1};
+            std::vector<int> traversal;
+            for (auto n : general_tree<int>::bounded_level_order(mytree.root(), 0))
+                traversal.push_back(n.data());
+            REQUIRE_EQ(expected_result, traversal);
+        }
+
+        SUBCASE("yields level by level up to the maximum depth")
+        {
+            const std::vector<int> expected_result = {1, 2, 3, 4, 5, 6, 7};
+            std::vector<int> traversal;
+            for (auto n : general_tree<int>::bounded_level_order(mytree.root(), 2))
+                traversal.push_back(n.data());
+            REQUIRE_EQ(expected_result, traversal);
+        }
+
+        SUBCASE("a large maximum depth yields every node")
+        {
+            const std::vector<int> expected_result = {1, 2, 3, 4, 5, 6, 7, 8};
+            std::vector<int> traversal;
+            for (auto n : general_tree<int>::bounded_level_order(mytree.root(), 100))
+                traversal.push_back(n.data());
+            REQUIRE_EQ(expected_result, traversal);
+        }
+
+        SUBCASE("iterator reports the depth of the current node")
+        {
+            const std::vector<std::size_t> expected_result = {0, 1, 1, 1, 2, 2, 2};
+            std::vector<std::size_t> depths;
+            auto view = general_tree<int>::bounded_level_order(mytree.root(), 2);
+            for (auto it = view.begin(); it != view.end(); ++it)
+                depths.push_back(it.depth());
+            REQUIRE_EQ(expected_result, depths);
+        }
+
+        SUBCASE("can be iterated again")
+        {
+            auto view = general_tree<int>::bounded_level_order(n2, 1);
+            const std::vector<int> expected_result = {2, 5, 6};
+            for (int i = 0; i < 2; i++)
+            {
+                std::vector<int> traversal;
+                for (auto n : view)
+                    traversal.push_back(n.data());
+                REQUIRE_EQ(expected_result, traversal);
+            }
+        }
+    }
+
+    SUBCASE("throw invalid argument if node is null")
+    {
+        general_tree<int> empty;
+        CHECK_THROWS_AS(general_tree<int>::bounded_preorder(empty.root(), 1), std::invalid_argument);
+        CHECK_THROWS_AS(general_tree<int>::bounded_level_order(empty.root(), 1), std::invalid_argument);
+    }
+}
@@ -0,0 +1,167 @@
+#include "general-tree.h"
+#include "utils/fixtures/throwing-copy.fixture.h"
+#include <cstddef>
+#include <doctest.h>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    using edge = std::pair<std::size_t, std::size_t>;
+    constexpr std::size_t none = general_tree<int>::no_index;
+
+    // node i gets parent (i - 1) / fanout, so the children of a node have consecutive indices
+    std::vector<std::size_t> wide_parents(std::size_t size, std::size_t fanout)
+    {
+        std::vector<std::size_t> parents(size, none);
+        for (std::size_t i = 1; i < size; i++)
+            parents[i] = (i - 1) / fanout;
+        return parents;
+    }
+}
+
+TEST_CASE("general_tree::from_parent_array")
+{
+    SUBCASE("children keep the order of their indices")
+    {
+        // 3 -> {0, 4}, 0 -> {1, 2}
+        const std::vector<std::string> values = {"a", "a1", "a2", "root", "b"};
+        const std::vector<std::size_t> parents = {3, 0, 0, none, 3};
+        const auto tree = general_tree<std::string>::from_parent_array(values, parents);
+
+        REQUIRE_EQ(tree.size(), 5);
+        REQUIRE_EQ(tree.root().data(), "root");
+        REQUIRE_EQ(tree.root().left_child().data(), "a");
+        REQUIRE_EQ(tree.root().child(1).data(), "b");
+        REQUIRE_EQ(tree.root().left_child().child(1).data(), "a2");
+        REQUIRE_EQ(tree.root().left_child().left_child().parent().data(), "a");
+
+        const std::vector<std::string> preorder(tree.begin(), tree.end());
+        const std::vector<std::string> expected = {"root", "a", "a1", "a2", "b"};
+        REQUIRE(preorder == expected);
+    }
+
+    SUBCASE("round trip with export_columns")
+    {
+        const std::vector<std::size_t> parents = wide_parents(5000, 3);
+        std::vector<int> values(parents.size());
+        std::iota(values.begin(), values.end(), 0);
+        const auto tree = general_tree<int>::from_parent_array(values, parents);
+
+        std::vector<std::size_t> exported_parents(tree.size());
+        std::vector<int> exported_values(tree.size());
+        general_tree<int>::column_buffers buffers{};
+        buffers.parent_index = exported_parents;
+        buffers.values = exported_values;
+        tree.export_columns(buffers);
+        REQUIRE_EQ(general_tree<int>::from_parent_array(exported_values, exported_parents), tree);
+    }
+
+    SUBCASE("parallel result is identical to the serial one")
+    {
+        const std::vector<std::size_t> parents = wide_parents(20000, 5);
+        std::vector<int> values(parents.size());
+        std::iota(values.begin(), values.end(), 0);
+        const auto serial = general_tree<int>::from_parent_array(values, parents);
+
+        for (std::size_t threads : {1, 2, 4, 8})
+        {
+            const auto parallel = general_tree<int>::from_parent_array(values, parents, {threads});
+            REQUIRE_EQ(parallel, serial);
+            REQUIRE_EQ(parallel.size(), serial.size());
+        }
+    }
+
+    SUBCASE("empty arrays make an empty tree")
+    {
+        REQUIRE(general_tree<int>::from_parent_array({}, {}).empty());
+    }
+
+    SUBCASE("throw invalid argument if the arrays do not describe a tree")
+    {
+        const std::vector<int> values = {0, 1, 2, 3};
+        const std::vector<std::vector<std::size_t>> malformed = {
+            {none, 0, 0},       // sizes differ
+            {1, 0, 0, 0},       // no root
+            {none, 0, none, 1}, // second root
+            {none, 0, 7, 1},    // out of range parent
+            {none, 2, 3, 1},    // cycle
+            {none, 1, 0, 3},    // self loop
+        };
+        for (const auto& parents : malformed)
+            CHECK_THROWS_AS(general_tree<int>::from_parent_array(values, parents), std::invalid_argument);
+    }
+
+    SUBCASE("no node is leaked if a copy throws")
+    {
+        const std::vector<std::size_t> parents = wide_parents(4000, 4);
+        std::vector<ThrowingCopy> values;
+        values.reserve(parents.size());
+        for (std::size_t i = 0; i < parents.size(); i++)
+            values.emplace_back(static_cast<int>(i));
+        const int alive_before = ThrowingCopy::alive;
+        for (std::size_t threads : {1, 4})
+        {
+            ThrowingCopy::copies_left = 3000;
+            CHECK_THROWS_AS(
+                general_tree<ThrowingCopy>::from_parent_array(values, parents, {threads}), std::runtime_error
+            );
+            REQUIRE_EQ(ThrowingCopy::alive, alive_before);
+        }
+    }
+}
+
+TEST_CASE("general_tree::from_edges")
+{
+    SUBCASE("children keep the order of their edges")
+    {
+        const std::vector<int> values = {0, 1, 2, 3, 4};
+        const std::vector<edge> edges = {{0, 3}, {3, 4}, {0, 1}, {3, 2}};
+        const auto tree = general_tree<int>::from_edges(values, edges);
+
+        const std::vector<int> preorder(tree.begin(), tree.end());
+        const std::vector<int> expected = {0, 3, 4, 2, 1};
+        REQUIRE(preorder == expected);
+        REQUIRE_EQ(tree.root().child(1).data(), 1);
+        REQUIRE_EQ(tree.root().left_child().child(1).parent().data(), 3);
+    }
+
+    SUBCASE("parallel result is identical to the serial one")
+    {
+        const std::vector<std::size_t> parents = wide_parents(20000, 7);
+        std::vector<edge> edges;
+        for (std::size_t i = parents.size() - 1; i > 0; i--)
+            edges.emplace_back(parents[i], i);
+        std::vector<int> values(parents.size());
+        std::iota(values.begin(), values.end(), 0);
+
+        const auto serial = general_tree<int>::from_edges(values, edges);
+        REQUIRE_EQ(serial.root().left_child().data(), 7);
+        for (std::size_t threads : {2, 4, 8})
+            REQUIRE_EQ(general_tree<int>::from_edges(values, edges, {threads}), serial);
+    }
+
+    SUBCASE("a single value without edges is the root")
+    {
+        const std::vector<int> values = {42};
+        const auto tree = general_tree<int>::from_edges(values, {});
+        REQUIRE_EQ(tree.size(), 1);
+        REQUIRE_EQ(tree.root().data(), 42);
+    }
+
+    SUBCASE("throw invalid argument if the edges do not describe a tree")
+    {
+        const std::vector<int> values = {0, 1, 2, 3};
+        const std::vector<std::vector<edge>> malformed = {
+            {{0, 1}, {0, 2}},         // second root
+            {{0, 1}, {0, 2}, {0, 9}}, // out of range child
+            {{0, 1}, {1, 2}, {0, 2}}, // node with two parents
+            {{0, 1}, {3, 2}, {2, 3}}, // cycle
+        };
+        for (const auto& edges : malformed)
+            CHECK_THROWS_AS(general_tree<int>::from_edges(values, edges), std::invalid_argument);
+    }
+}
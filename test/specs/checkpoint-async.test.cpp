@@ -0,0 +1,148 @@
+#include "general-tree.h"
+#include <atomic>
+#include <doctest.h>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    general_tree<int> load_file(const std::string& path)
+    {
+        std::ifstream file(path, std::ios::binary);
+        return general_tree<int>::load(file);
+    }
+
+    // holds the checkpoint thread on its first value until the gate opens
+    struct gated_codec
+    {
+        std::atomic<bool>* open;
+
+        void encode(general_tree<int>::binary_writer& writer, const int& value) const
+        {
+            while (!open->load())
+                std::this_thread::yield();
+            general_tree<int>::default_codec().encode(writer, value);
+        }
+    };
+}
+
+TEST_CASE("general_tree::concurrent_tree::checkpoint_async")
+{
+    using concurrent_tree = general_tree<int>::concurrent_tree;
+    const std::string path = (std::filesystem::temp_directory_path() / "general-tree-checkpoint.bin").string();
+
+    general_tree<int> mirror(0);
+    std::vector<general_tree<int>::node> nodes = {mirror.root()};
+    for (int i = 1; i < 100000; i++)
+        nodes.push_back(mirror.insert_left_child(nodes[static_cast<std::size_t>(i) / 4], i));
+
+    SUBCASE("the checkpoint holds the tree as it was when it started")
+    {
+        const general_tree<int> expected = mirror;
+        concurrent_tree ct{general_tree<int>(mirror)};
+        ct.checkpoint_async(path);
+
+        // every kind of write, mirrored on a plain tree, while the checkpoint runs
+        auto root = ct.read().root();
+        for (int i = 0; i < 4000 || ct.checkpoint_running(); i++)
+        {
+            switch (i % 5)
+            {
+            case 0:
+                ct.emplace_left_child(root, i);
+                mirror.emplace_left_child(mirror.root(), i);
+                break;
+            case 1:
+                ct.emplace_right_sibling(ct.read().left_child(root), i);
+                mirror.emplace_right_sibling(mirror.root().left_child(), i);
+                break;
+            case 2:
+                ct.delete_right_sibling(ct.read().left_child(root));
+                mirror.delete_right_sibling(mirror.root().left_child());
+                break;
+            case 3:
+                ct.delete_left_child(root);
+                mirror.delete_left_child(mirror.root());
+                break;
+            case 4:
+                root = ct.replace(root, -i);
+                mirror.root().data() = -i;
+                break;
+            }
+        }
+
+        ct.wait_for_checkpoint();
+        REQUIRE(load_file(path) == expected);
+        REQUIRE_EQ(ct.size(), mirror.size());
+
+        // the next checkpoint sees the writes
+        ct.checkpoint_async(path);
+        ct.wait_for_checkpoint();
+        REQUIRE(load_file(path) == mirror);
+    }
+
+    SUBCASE("nodes removed during the checkpoint are reclaimed after it")
+    {
+        const general_tree<int> expected = mirror;
+        concurrent_tree ct{std::move(mirror)};
+        ct.checkpoint_async(path);
+        ct.clear();
+        REQUIRE(ct.read().root().is_null());
+
+        ct.wait_for_checkpoint();
+        REQUIRE(load_file(path) == expected);
+        ct.reclaim();
+        REQUIRE_EQ(ct.retired_count(), 0);
+    }
+
+    SUBCASE("throw runtime error on reclaim while a checkpoint runs")
+    {
+        concurrent_tree ct{general_tree<int>(mirror)};
+        std::atomic<bool> open = false;
+        ct.checkpoint_async(path, gated_codec{&open});
+        ct.delete_left_child(ct.read().root());
+
+        CHECK_THROWS_AS(ct.reclaim(), std::runtime_error);
+        REQUIRE(ct.checkpoint_running());
+        ct.emplace_left_child(ct.read().root(), -1);
+
+        open = true;
+        ct.wait_for_checkpoint();
+        ct.reclaim();
+        REQUIRE_EQ(ct.retired_count(), 0);
+        REQUIRE(load_file(path) == mirror);
+    }
+
+    SUBCASE("empty tree")
+    {
+        concurrent_tree ct;
+        ct.checkpoint_async(path);
+        ct.wait_for_checkpoint();
+        REQUIRE(load_file(path).empty());
+    }
+
+    SUBCASE("the tree can be destroyed while a checkpoint runs")
+    {
+        {
+            concurrent_tree ct{general_tree<int>(mirror)};
+            ct.checkpoint_async(path);
+        }
+        REQUIRE(load_file(path) == mirror);
+    }
+
+    SUBCASE("throw runtime error if the file cannot be created")
+    {
+        concurrent_tree ct{general_tree<int>(mirror)};
+        const std::string missing_directory =
+            (std::filesystem::temp_directory_path() / "general-tree-missing" / "checkpoint.bin").string();
+        CHECK_THROWS_AS(ct.checkpoint_async(missing_directory), std::runtime_error);
+        REQUIRE_FALSE(ct.checkpoint_running());
+        CHECK_NOTHROW(ct.wait_for_checkpoint());
+    }
+
+    std::filesystem::remove(path);
+}
@@ -0,0 +1,111 @@
+#include "general-tree.h"
+#include "utils/fixtures/lifecycle-counter.fixture.h"
+#include "utils/helpers/seed-tree.h"
+#include <chrono>
+#include <doctest.h>
+#include <stdexcept>
+
+TEST_CASE_FIXTURE(LifecycleCounterFixture, "clear_incremental")
+{
+    const std::size_t gt_size = 1000;
+    general_tree<LifecycleCounter> gt = seed_tree(gt_size);
+
+    SUBCASE("tree is empty right away")
+    {
+        auto handle = gt.clear_incremental(10);
+        REQUIRE(gt.empty());
+        REQUIRE_EQ(gt.size(), 0);
+        REQUIRE_EQ(handle.remaining(), gt_size);
+        REQUIRE_EQ(LifecycleCounter::destructor_calls, 0);
+    }
+
+    SUBCASE("each step frees at most the budget")
+    {
+        auto handle = gt.clear_incremental(10);
+        std::size_t steps = 0;
+        while (!handle.done())
+        {
+            const std::size_t before = LifecycleCounter::destructor_calls;
+            const std::size_t freed = handle.step();
+            REQUIRE_LE(freed, 10);
+            REQUIRE_EQ(LifecycleCounter::destructor_calls - before, freed);
+            ++steps;
+        }
+        REQUIRE_EQ(LifecycleCounter::destructor_calls, gt_size);
+        REQUIRE_EQ(handle.remaining(), 0);
+        REQUIRE_GE(steps, gt_size / 10);
+    }
+
+    SUBCASE("deep chains are freed in bounded steps")
+    {
+        general_tree<int> chain(0);
+        auto last = chain.root();
+        for (int i = 1; i < 5000; i++)
+            last = chain.insert_left_child(last, i);
+
+        auto handle = chain.clear_incremental(100);
+        std::size_t total = 0;
+        while (!handle.done())
+            total += handle.step();
+        REQUIRE_EQ(total, 5000);
+    }
+
+    SUBCASE("time budget")
+    {
+        auto handle = gt.clear_incremental(std::chrono::milliseconds(50));
+        while (!handle.done())
+            handle.step();
+        REQUIRE_EQ(LifecycleCounter::destructor_calls, gt_size);
+    }
+
+    SUBCASE("the destructor frees the remaining nodes")
+    {
+        {
+            auto handle = gt.clear_incremental(10);
+            handle.step();
+        }
+        REQUIRE_EQ(LifecycleCounter::destructor_calls, gt_size);
+    }
+
+    SUBCASE("finish frees everything")
+    {
+        auto handle = gt.clear_incremental(1);
+        handle.finish();
+        REQUIRE(handle.done());
+        REQUIRE_EQ(LifecycleCounter::destructor_calls, gt_size);
+    }
+
+    SUBCASE("handles can be moved")
+    {
+        auto handle = gt.clear_incremental(10);
+        handle.step();
+        auto moved = std::move(handle);
+        REQUIRE(handle.done());
+        moved.finish();
+        REQUIRE_EQ(LifecycleCounter::destructor_calls, gt_size);
+    }
+
+    SUBCASE("the tree can be reused while nodes are being freed")
+    {
+        auto handle = gt.clear_incremental(10);
+        gt.emplace_root("string", 0);
+        handle.finish();
+        REQUIRE_EQ(gt.size(), 1);
+        REQUIRE_EQ(LifecycleCounter::destructor_calls, gt_size);
+    }
+
+    SUBCASE("empty tree")
+    {
+        general_tree<int> empty;
+        auto handle = empty.clear_incremental(10);
+        REQUIRE(handle.done());
+        REQUIRE_EQ(handle.step(), 0);
+    }
+
+    SUBCASE("throw invalid argument if the budget is zero")
+    {
+        CHECK_THROWS_AS(gt.clear_incremental(0), std::invalid_argument);
+        CHECK_THROWS_AS(gt.clear_incremental(std::chrono::seconds(0)), std::invalid_argument);
+        REQUIRE_EQ(gt.size(), gt_size);
+    }
+}
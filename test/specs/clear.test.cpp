@@ -42,4 +42,81 @@ TEST_CASE_FIXTURE(LifecycleCounterFixture, "clear")
         // new nodes destroyed successfully
         REQUIRE_EQ(LifecycleCounter::destructor_calls, 3);
     }
-}
\ No newline at end of file
+}
+
+TEST_CASE_FIXTURE(LifecycleCounterFixture, "clear (parallel)")
+{
+    SUBCASE("delete all nodes from tree")
+    {
+        for (std::size_t threads : {1, 2, 4, 8})
+        {
+            std::size_t gt_size = 3000;
+            general_tree<LifecycleCounter> gt = seed_tree(gt_size);
+            gt.clear({threads});
+            REQUIRE_EQ(LifecycleCounter::destructor_calls, gt_size);
+            REQUIRE(gt.empty());
+            REQUIRE_EQ(gt.size(), 0);
+        }
+    }
+
+    SUBCASE("calling clear on an empty tree is safe")
+    {
+        general_tree<int> emptygt;
+        REQUIRE_NOTHROW(emptygt.clear(general_tree<int>::par));
+        REQUIRE(emptygt.empty());
+    }
+
+    SUBCASE("inserting new nodes after clear is safe")
+    {
+        general_tree<LifecycleCounter> gt = seed_tree(50);
+        gt.clear({4});
+        LifecycleCounter::destructor_calls = 0;
+
+        gt.emplace_root("string", 0);
+        gt.emplace_left_child(gt.root(), "string1", 1);
+        gt.clear({4});
+        REQUIRE_EQ(LifecycleCounter::destructor_calls, 2);
+    }
+}
+
+TEST_CASE_FIXTURE(LifecycleCounterFixture, "clear_in_background")
+{
+    SUBCASE("tree is empty right away and nodes are freed asynchronously")
+    {
+        std::size_t gt_size = 3000;
+        general_tree<LifecycleCounter> gt = seed_tree(gt_size);
+        gt.clear_in_background();
+        REQUIRE(gt.empty());
+        REQUIRE_EQ(gt.size(), 0);
+
+        general_tree<LifecycleCounter>::wait_for_background_reclaim();
+        REQUIRE_EQ(LifecycleCounter::destructor_calls, gt_size);
+    }
+
+    SUBCASE("several trees can be queued")
+    {
+        general_tree<LifecycleCounter> gt1 = seed_tree(100);
+        general_tree<LifecycleCounter> gt2 = seed_tree(200);
+        gt1.clear_in_background();
+        gt2.clear_in_background();
+        general_tree<LifecycleCounter>::wait_for_background_reclaim();
+        REQUIRE_EQ(LifecycleCounter::destructor_calls, 300);
+    }
+
+    SUBCASE("the tree can be reused right away")
+    {
+        general_tree<LifecycleCounter> gt = seed_tree(100);
+        gt.clear_in_background();
+        gt.emplace_root("string", 0);
+        REQUIRE_EQ(gt.size(), 1);
+        general_tree<LifecycleCounter>::wait_for_background_reclaim();
+        REQUIRE_EQ(LifecycleCounter::destructor_calls, 100);
+    }
+
+    SUBCASE("calling it on an empty tree is safe")
+    {
+        general_tree<int> emptygt;
+        REQUIRE_NOTHROW(emptygt.clear_in_background());
+        REQUIRE_NOTHROW(general_tree<int>::wait_for_background_reclaim());
+    }
+}
@@ -0,0 +1,113 @@
+#include "general-tree.h"
+#include "utils/helpers/filesystem-tree.h"
+#include <cstddef>
+#include <doctest.h>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+    constexpr std::size_t none = general_tree<std::string>::no_index;
+}
+
+TEST_CASE("general_tree::export_columns")
+{
+    const general_tree<std::string> tree = filesystem_tree();
+    std::vector<std::size_t> parent_index(tree.size());
+    std::vector<std::size_t> depth(tree.size());
+    std::vector<std::size_t> subtree_size(tree.size());
+    std::vector<std::size_t> first_child(tree.size());
+    std::vector<std::string> values(tree.size());
+
+    SUBCASE("one preorder row per node")
+    {
+        tree.export_columns({parent_index, depth, subtree_size, first_child, values});
+
+        const std::vector<std::string> expected_values = {"/",    "bin",       "etc",      "home", "user",
+                                                          "Documents", "Projects", "var",  "log"};
+        const std::vector<std::size_t> expected_parents = {none, 0, 0, 0, 3, 4, 4, 0, 7};
+        const std::vector<std::size_t> expected_depths = {0, 1, 1, 1, 2, 3, 3, 1, 2};
+        const std::vector<std::size_t> expected_sizes = {9, 1, 1, 4, 3, 1, 1, 2, 1};
+        const std::vector<std::size_t> expected_children = {1, none, none, 4, 5, none, none, 8, none};
+        REQUIRE(values == expected_values);
+        REQUIRE(parent_index == expected_parents);
+        REQUIRE(depth == expected_depths);
+        REQUIRE(subtree_size == expected_sizes);
+        REQUIRE(first_child == expected_children);
+    }
+
+    SUBCASE("empty buffers skip their column")
+    {
+        general_tree<std::string>::column_buffers buffers{};
+        buffers.subtree_size = subtree_size;
+        tree.export_columns(buffers);
+        REQUIRE_EQ(subtree_size.front(), tree.size());
+        REQUIRE(values.front().empty());
+    }
+
+    SUBCASE("throw invalid argument if a buffer is too small")
+    {
+        std::vector<std::size_t> small(tree.size() - 1);
+        CHECK_THROWS_AS(tree.export_columns({parent_index, small, {}, {}, {}}), std::invalid_argument);
+        REQUIRE(values.front().empty());
+    }
+
+    SUBCASE("deep trees")
+    {
+        general_tree<int> chain(0);
+        auto last = chain.root();
+        for (int i = 1; i < 100000; i++)
+            last = chain.insert_left_child(last, i);
+
+        std::vector<std::size_t> sizes(chain.size());
+        general_tree<int>::column_buffers buffers{};
+        buffers.subtree_size = sizes;
+        chain.export_columns(buffers);
+        REQUIRE_EQ(sizes.front(), 100000);
+        REQUIRE_EQ(sizes.back(), 1);
+    }
+
+    SUBCASE("empty tree")
+    {
+        CHECK_NOTHROW(general_tree<std::string>().export_columns({}));
+    }
+}
+
+TEST_CASE("general_tree::import_columns")
+{
+    SUBCASE("round trip")
+    {
+        const general_tree<std::string> tree = filesystem_tree();
+        std::vector<std::size_t> parent_index(tree.size());
+        std::vector<std::string> values(tree.size());
+        general_tree<std::string>::column_buffers buffers{};
+        buffers.parent_index = parent_index;
+        buffers.values = values;
+        tree.export_columns(buffers);
+
+        const general_tree<std::string> imported = general_tree<std::string>::import_columns(parent_index, values);
+        REQUIRE(imported == tree);
+        REQUIRE_EQ(imported.size(), tree.size());
+        REQUIRE_EQ(imported.root().child(2).left_child().parent().data(), "home");
+    }
+
+    SUBCASE("empty columns make an empty tree")
+    {
+        REQUIRE(general_tree<int>::import_columns({}, {}).empty());
+    }
+
+    SUBCASE("throw invalid argument if the columns are not a tree in preorder")
+    {
+        const std::vector<int> values = {0, 1, 2, 3};
+        const std::vector<std::vector<std::size_t>> malformed = {
+            {none, 0, 1},          // sizes differ
+            {0, 0, 1, 2},          // root with a parent
+            {none, 0, none, 1},    // second root
+            {none, 2, 0, 0},       // parent after the child
+            {none, 0, 0, 1},       // parent no longer on the path
+        };
+        for (const auto& parent_index : malformed)
+            CHECK_THROWS_AS(general_tree<int>::import_columns(parent_index, values), std::invalid_argument);
+    }
+}
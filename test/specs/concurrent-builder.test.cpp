@@ -0,0 +1,126 @@
+#include "general-tree.h"
+#include "utils/fixtures/lifecycle-counter.fixture.h"
+#include <doctest.h>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+TEST_CASE_FIXTURE(LifecycleCounterFixture, "general_tree::concurrent_builder")
+{
+    using builder = general_tree<int>::concurrent_builder;
+
+    SUBCASE("threads append to a shared parent")
+    {
+        const int threads = 8;
+        const int per_thread = 2000;
+        builder b(general_tree<int>(-1));
+
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; t++)
+        {
+            workers.emplace_back([&b, t] {
+                for (int i = 0; i < per_thread; i++)
+                    b.concurrent_emplace_child(b.root(), t * per_thread + i);
+            });
+        }
+        for (std::thread& worker : workers)
+            worker.join();
+
+        general_tree<int> gt = std::move(b).seal();
+        REQUIRE_EQ(gt.size(), threads * per_thread + 1);
+        REQUIRE_EQ(gt.root().children_count(), threads * per_thread);
+
+        std::vector<int> seen(threads * per_thread, 0);
+        std::vector<int> last(threads, -1);
+        for (auto child : general_tree<int>::children(gt.root()))
+        {
+            REQUIRE_EQ(child.parent(), gt.root());
+            ++seen[child.data()];
+            REQUIRE_GT(child.data(), last[child.data() / per_thread]);
+            last[child.data() / per_thread] = child.data();
+        }
+        for (int count : seen)
+            REQUIRE_EQ(count, 1);
+    }
+
+    SUBCASE("children keep their insertion order after the existing ones")
+    {
+        general_tree<int> gt(0);
+        auto first = gt.insert_left_child(gt.root(), 1);
+        gt.insert_left_child(first, 10);
+        gt.insert_right_sibling(first, 2);
+        builder b(std::move(gt));
+
+        b.concurrent_emplace_child(b.root(), 3);
+        b.concurrent_emplace_child(b.root(), 4);
+        b.concurrent_emplace_child(first, 11);
+        general_tree<int> sealed = std::move(b).seal();
+
+        const std::vector<int> preorder(sealed.begin(), sealed.end());
+        const std::vector<int> expected = {0, 1, 10, 11, 2, 3, 4};
+        REQUIRE(preorder == expected);
+        REQUIRE_EQ(sealed.size(), 7);
+    }
+
+    SUBCASE("threads build their own subtrees under shared parents")
+    {
+        const int threads = 4;
+        builder b(general_tree<int>(0));
+
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; t++)
+        {
+            workers.emplace_back([&b] {
+                for (int i = 0; i < 100; i++)
+                {
+                    auto child = b.concurrent_emplace_child(b.root(), 1);
+                    for (int j = 0; j < 10; j++)
+                        b.concurrent_emplace_child(child, 2);
+                }
+            });
+        }
+        for (std::thread& worker : workers)
+            worker.join();
+
+        general_tree<int> gt = std::move(b).seal();
+        REQUIRE_EQ(gt.size(), 1 + threads * 100 * 11);
+        for (auto n : general_tree<int>::children(gt.root()))
+            REQUIRE_EQ(n.children_count(), 10);
+    }
+
+    SUBCASE("sealed tree is a regular tree")
+    {
+        builder b(general_tree<int>(0));
+        auto child = b.concurrent_emplace_child(b.root(), 1);
+        b.concurrent_emplace_child(child, 2);
+        general_tree<int> gt = std::move(b).seal();
+
+        gt.emplace_right_sibling(gt.root().left_child(), 3);
+        REQUIRE_EQ(gt.size(), 4);
+
+        general_tree<int> expected(0);
+        expected.insert_left_child(expected.root(), 1);
+        expected.insert_left_child(expected.root().left_child(), 2);
+        expected.insert_right_sibling(expected.root().left_child(), 3);
+        REQUIRE(gt == expected);
+    }
+
+    SUBCASE("unsealed nodes are freed by the builder")
+    {
+        {
+            general_tree<LifecycleCounter> gt;
+            gt.emplace_root("root", 0);
+            general_tree<LifecycleCounter>::concurrent_builder b(std::move(gt));
+            for (int i = 0; i < 10; i++)
+                b.concurrent_emplace_child(b.root(), "string", i);
+        }
+        REQUIRE_EQ(LifecycleCounter::destructor_calls, 11);
+    }
+
+    SUBCASE("throw invalid argument if the tree is empty or the parent is null")
+    {
+        CHECK_THROWS_AS(builder(general_tree<int>()), std::invalid_argument);
+        builder b(general_tree<int>(0));
+        CHECK_THROWS_AS(b.concurrent_emplace_child(nullptr, 1), std::invalid_argument);
+    }
+}
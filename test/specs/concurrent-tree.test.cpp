@@ -0,0 +1,186 @@
+#include "general-tree.h"
+#include "utils/fixtures/lifecycle-counter.fixture.h"
+#include "utils/helpers/seed-tree.h"
+#include <atomic>
+#include <doctest.h>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+TEST_CASE_FIXTURE(LifecycleCounterFixture, "general_tree::concurrent_tree")
+{
+    using concurrent_tree = general_tree<LifecycleCounter>::concurrent_tree;
+
+    SUBCASE("readers see the nodes of the adopted tree")
+    {
+        concurrent_tree ct(seed_tree(100));
+        REQUIRE_EQ(ct.size(), 100);
+
+        auto guard = ct.read();
+        std::size_t visited = 0;
+        struct counter
+        {
+            std::size_t& m_visited;
+            void on_enter(general_tree<LifecycleCounter>::node)
+            {
+                ++m_visited;
+            }
+        };
+        guard.visit(guard.root(), counter{visited});
+        REQUIRE_EQ(visited, 100);
+    }
+
+    SUBCASE("writes are visible to new readers")
+    {
+        concurrent_tree ct;
+        auto root = ct.emplace_root("root", 0);
+        auto child = ct.emplace_left_child(root, "child", 1);
+        ct.emplace_right_sibling(child, "sibling", 2);
+
+        auto guard = ct.read();
+        REQUIRE_EQ(guard.root(), root);
+        REQUIRE_EQ(guard.left_child(root), child);
+        REQUIRE_EQ(guard.right_sibling(child).data().get_int(), 2);
+        REQUIRE_EQ(guard.parent(child), root);
+        REQUIRE_EQ(ct.size(), 3);
+    }
+
+    SUBCASE("deleted nodes are not freed while a reader can reach them")
+    {
+        concurrent_tree ct(seed_tree(10));
+        auto guard = ct.read();
+        auto root = guard.root();
+        auto removed = guard.left_child(root);
+        const std::size_t removed_count = removed.descendants_count() + 1;
+
+        ct.delete_left_child(root);
+        REQUIRE_EQ(ct.size(), 10 - removed_count);
+        ct.delete_left_child(root);
+        REQUIRE_EQ(ct.size(), 1);
+        REQUIRE_EQ(LifecycleCounter::destructor_calls, 0);
+        REQUIRE_EQ(removed.data().get_int(), 1);
+        REQUIRE_EQ(ct.retired_count(), 9);
+    }
+
+    SUBCASE("reclaim frees the retired nodes once readers are gone")
+    {
+        concurrent_tree ct(seed_tree(10));
+        {
+            auto guard = ct.read();
+            ct.delete_right_sibling(guard.left_child(guard.root()));
+        }
+        ct.reclaim();
+        REQUIRE_EQ(ct.retired_count(), 0);
+        REQUIRE_EQ(LifecycleCounter::destructor_calls, 10 - ct.size());
+    }
+
+    SUBCASE("replace publishes a new node and keeps the children")
+    {
+        concurrent_tree ct(seed_tree(10));
+        auto guard = ct.read();
+        auto old_node = guard.left_child(guard.root());
+        auto old_child = guard.left_child(old_node);
+
+        auto new_node = ct.replace(old_node, "replaced", 100);
+        REQUIRE_EQ(guard.left_child(guard.root()), new_node);
+        REQUIRE_EQ(guard.left_child(new_node), old_child);
+        REQUIRE_EQ(guard.parent(old_child), new_node);
+        REQUIRE_EQ(old_node.data().get_int(), 1);
+        REQUIRE_EQ(ct.size(), 10);
+        REQUIRE_EQ(ct.retired_count(), 1);
+    }
+
+    SUBCASE("replace the root")
+    {
+        concurrent_tree ct(seed_tree(10));
+        auto new_root = ct.replace(ct.read().root(), "root", 100);
+        auto guard = ct.read();
+        REQUIRE_EQ(guard.root(), new_root);
+        REQUIRE_EQ(guard.parent(guard.left_child(new_root)), new_root);
+    }
+
+    SUBCASE("clear retires every node")
+    {
+        concurrent_tree ct(seed_tree(10));
+        ct.clear();
+        REQUIRE(ct.read().root().is_null());
+        REQUIRE_EQ(ct.size(), 0);
+        ct.reclaim();
+        REQUIRE_EQ(LifecycleCounter::destructor_calls, 10);
+    }
+
+    SUBCASE("the destructor frees live and retired nodes")
+    {
+        {
+            concurrent_tree ct(seed_tree(10));
+            ct.delete_left_child(ct.read().root());
+        }
+        REQUIRE_EQ(LifecycleCounter::destructor_calls, 10);
+    }
+
+    SUBCASE("readers traverse while a writer inserts and deletes")
+    {
+        general_tree<int>::concurrent_tree ct;
+        auto root = ct.emplace_root(0);
+        std::atomic<bool> stop = false;
+        std::atomic<bool> valid = true;
+
+        auto reader = [&] {
+            while (!stop.load())
+            {
+                auto guard = ct.read();
+                // every node holds the depth at which it was inserted
+                struct checker
+                {
+                    std::size_t m_depth = 0;
+                    bool m_valid = true;
+                    void on_enter(general_tree<int>::node n)
+                    {
+                        m_valid = m_valid && n.data() == static_cast<int>(m_depth);
+                        ++m_depth;
+                    }
+                    void on_leave(general_tree<int>::node)
+                    {
+                        --m_depth;
+                    }
+                } check;
+                guard.visit(guard.root(), check);
+                if (!check.m_valid)
+                    valid.store(false);
+            }
+        };
+
+        std::vector<std::thread> readers;
+        for (int i = 0; i < 4; i++)
+            readers.emplace_back(reader);
+
+        for (int i = 0; i < 2000; i++)
+        {
+            auto child = ct.emplace_left_child(root, 1);
+            ct.emplace_left_child(child, 2);
+            ct.emplace_right_sibling(child, 1);
+            if (i % 3 == 0)
+                ct.delete_left_child(root);
+            if (i % 5 == 0)
+                ct.replace(ct.read().left_child(root), 1);
+        }
+
+        stop.store(true);
+        for (std::thread& thread : readers)
+            thread.join();
+
+        REQUIRE(valid.load());
+        ct.reclaim();
+        REQUIRE_EQ(ct.retired_count(), 0);
+    }
+
+    SUBCASE("throw invalid argument on null or root nodes")
+    {
+        concurrent_tree ct(seed_tree(10));
+        CHECK_THROWS_AS(ct.emplace_left_child(nullptr, "string", 0), std::invalid_argument);
+        CHECK_THROWS_AS(ct.emplace_right_sibling(ct.read().root(), "string", 0), std::invalid_argument);
+        CHECK_THROWS_AS(ct.replace(nullptr, "string", 0), std::invalid_argument);
+        CHECK_THROWS_AS(ct.delete_right_sibling(ct.read().root()), std::invalid_argument);
+        CHECK_THROWS_AS(ct.emplace_root("string", 0), std::runtime_error);
+    }
+}
@@ -0,0 +1,202 @@
+#include "general-tree.h"
+#include "utils/fixtures/lifecycle-counter.fixture.h"
+#include <doctest.h>
+#include <stdexcept>
+#include <vector>
+
+TEST_CASE("general_tree::tree_cursor")
+{
+    /*
+            1
+          / | \
+         2  3  4
+        / \     \
+       5   6     7
+    */
+    general_tree<int> mytree;
+    mytree.create_root(1);
+    auto n2 = mytree.insert_left_child(mytree.root(), 2);
+    auto n3 = mytree.insert_right_sibling(n2, 3);
+    auto n4 = mytree.insert_right_sibling(n3, 4);
+    auto n5 = mytree.insert_left_child(n2, 5);
+    auto n6 = mytree.insert_right_sibling(n5, 6);
+    auto n7 = mytree.insert_left_child(n4, 7);
+
+    SUBCASE("starts at the root")
+    {
+        auto cursor = mytree.cursor();
+        REQUIRE_EQ(cursor.current(), mytree.root());
+        REQUIRE_EQ(cursor.depth(), 0);
+        REQUIRE_EQ(cursor.index(), 0);
+    }
+
+    SUBCASE("null cursor on empty tree")
+    {
+        general_tree<int> empty;
+        auto cursor = empty.cursor();
+        REQUIRE(cursor.is_null());
+        REQUIRE_FALSE(cursor.down());
+        REQUIRE_FALSE(cursor.up());
+        REQUIRE_FALSE(cursor.next_sibling());
+        REQUIRE_FALSE(cursor.prev_sibling());
+    }
+
+    SUBCASE("down moves to the requested child and tracks depth and index")
+    {
+        auto cursor = mytree.cursor();
+        REQUIRE(cursor.down(2));
+        REQUIRE_EQ(cursor.current(), n4);
+        REQUIRE_EQ(cursor.depth(), 1);
+        REQUIRE_EQ(cursor.index(), 2);
+
+        REQUIRE(cursor.down());
+        REQUIRE_EQ(cursor.current(), n7);
+        REQUIRE_EQ(cursor.depth(), 2);
+        REQUIRE_EQ(cursor.index(), 0);
+    }
+
+    SUBCASE("down to a missing child leaves the cursor unchanged")
+    {
+        auto cursor = mytree.cursor();
+        REQUIRE_FALSE(cursor.down(3));
+        REQUIRE_EQ(cursor.current(), mytree.root());
+        REQUIRE(cursor.down(1));
+        REQUIRE_FALSE(cursor.down());
+        REQUIRE_EQ(cursor.current(), n3);
+        REQUIRE_EQ(cursor.depth(), 1);
+    }
+
+    SUBCASE("up restores depth and index of the parent")
+    {
+        auto cursor = mytree.cursor();
+        cursor.down(0);
+        cursor.down(1);
+        REQUIRE_EQ(cursor.current(), n6);
+
+        REQUIRE(cursor.up());
+        REQUIRE_EQ(cursor.current(), n2);
+        REQUIRE_EQ(cursor.index(), 0);
+        REQUIRE_EQ(cursor.depth(), 1);
+
+        REQUIRE(cursor.up());
+        REQUIRE_EQ(cursor.current(), mytree.root());
+        REQUIRE_FALSE(cursor.up());
+    }
+
+    SUBCASE("sibling navigation in both directions")
+    {
+        auto cursor = mytree.cursor();
+        cursor.down();
+        REQUIRE_FALSE(cursor.prev_sibling());
+
+        REQUIRE(cursor.next_sibling());
+        REQUIRE(cursor.next_sibling());
+        REQUIRE_EQ(cursor.current(), n4);
+        REQUIRE_EQ(cursor.index(), 2);
+        REQUIRE_FALSE(cursor.next_sibling());
+
+        REQUIRE(cursor.prev_sibling());
+        REQUIRE_EQ(cursor.current(), n3);
+        REQUIRE_EQ(cursor.index(), 1);
+        REQUIRE(cursor.prev_sibling());
+        REQUIRE_EQ(cursor.current(), n2);
+        REQUIRE_EQ(cursor.index(), 0);
+    }
+
+    SUBCASE("root has no siblings")
+    {
+        auto cursor = mytree.cursor();
+        REQUIRE_FALSE(cursor.next_sibling());
+        REQUIRE_FALSE(cursor.prev_sibling());
+    }
+
+    SUBCASE("cursor created from a node rebuilds its path")
+    {
+        auto cursor = mytree.cursor(n6);
+        REQUIRE_EQ(cursor.depth(), 2);
+        REQUIRE_EQ(cursor.index(), 1);
+        REQUIRE(cursor.prev_sibling());
+        REQUIRE_EQ(cursor.current(), n5);
+        REQUIRE(cursor.up());
+        REQUIRE(cursor.next_sibling());
+        REQUIRE_EQ(cursor.current(), n3);
+        REQUIRE_EQ(cursor.index(), 1);
+    }
+
+    SUBCASE("throw invalid argument if node is null")
+    {
+        CHECK_THROWS_AS(mytree.cursor(nullptr), std::invalid_argument);
+    }
+
+    SUBCASE("insert at the cursor")
+    {
+        auto cursor = mytree.cursor(n3);
+        auto child = cursor.emplace_left_child(8);
+        auto sibling = cursor.emplace_right_sibling(9);
+        REQUIRE_EQ(cursor.current(), n3);
+        REQUIRE_EQ(n3.left_child(), child);
+        REQUIRE_EQ(n3.right_sibling(), sibling);
+        REQUIRE_EQ(sibling.right_sibling(), n4);
+
+        REQUIRE(cursor.next_sibling());
+        REQUIRE_EQ(cursor.current(), sibling);
+        REQUIRE_EQ(cursor.index(), 2);
+    }
+
+    SUBCASE("erase moves to the right sibling")
+    {
+        auto cursor = mytree.cursor(n3);
+        cursor.erase();
+        REQUIRE_EQ(cursor.current(), n4);
+        REQUIRE_EQ(cursor.index(), 1);
+        REQUIRE_EQ(n2.right_sibling(), n4);
+    }
+
+    SUBCASE("erase the first child updates the parent")
+    {
+        auto cursor = mytree.cursor(n2);
+        cursor.erase();
+        REQUIRE_EQ(cursor.current(), n3);
+        REQUIRE_EQ(cursor.index(), 0);
+        REQUIRE_EQ(mytree.root().left_child(), n3);
+    }
+
+    SUBCASE("erase the last child moves to the left sibling")
+    {
+        auto cursor = mytree.cursor(n4);
+        cursor.erase();
+        REQUIRE_EQ(cursor.current(), n3);
+        REQUIRE_EQ(cursor.index(), 1);
+        REQUIRE_FALSE(n3.has_right_sibling());
+    }
+
+    SUBCASE("erase the only child moves to the parent")
+    {
+        auto cursor = mytree.cursor(n7);
+        cursor.erase();
+        REQUIRE_EQ(cursor.current(), n4);
+        REQUIRE_EQ(cursor.depth(), 1);
+        REQUIRE(n4.is_leaf());
+    }
+
+    SUBCASE("erase the root empties the tree")
+    {
+        auto cursor = mytree.cursor();
+        cursor.erase();
+        REQUIRE(cursor.is_null());
+        REQUIRE(mytree.empty());
+    }
+}
+
+TEST_CASE_FIXTURE(LifecycleCounterFixture, "tree_cursor::erase destroys the subtree")
+{
+    general_tree<LifecycleCounter> gt;
+    gt.emplace_root("string0", 0);
+    auto left = gt.emplace_left_child(gt.root(), "string1", 1);
+    gt.emplace_left_child(left, "string2", 2);
+    gt.emplace_right_sibling(left, "string3", 3);
+
+    auto cursor = gt.cursor(left);
+    cursor.erase();
+    CHECK_EQ(LifecycleCounter::destructor_calls, 2);
+}
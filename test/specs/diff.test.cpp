@@ -0,0 +1,230 @@
+#include "general-tree.h"
+#include "utils/helpers/filesystem-tree.h"
+#include <cstddef>
+#include <doctest.h>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+    using tree_type = general_tree<std::string>;
+    using edit_kind = tree_type::edit_kind;
+
+    std::size_t count_kind(const tree_type::edit_script& script, edit_kind kind)
+    {
+        std::size_t count = 0;
+        for (const auto& op : script)
+            count += op.kind == kind ? 1 : 0;
+        return count;
+    }
+
+    // - diff from a to b, applied to a copy of a, gives b
+    tree_type::edit_script check_round_trip(const tree_type& a, const tree_type& b)
+    {
+        tree_type::edit_script script = tree_type::diff(a, b);
+        tree_type patched(a);
+        patched.apply(script);
+        REQUIRE(patched == b);
+        REQUIRE_EQ(patched.size(), b.size());
+        return script;
+    }
+
+    general_tree<int> random_tree(std::mt19937& rng, std::size_t size)
+    {
+        general_tree<int> tree(0);
+        std::vector<general_tree<int>::node> nodes = {tree.root()};
+        for (std::size_t i = 1; i < size; i++)
+        {
+            auto parent = nodes[std::uniform_int_distribution<std::size_t>(0, nodes.size() - 1)(rng)];
+            nodes.push_back(tree.insert_left_child(parent, static_cast<int>(rng() % 50)));
+        }
+        return tree;
+    }
+
+    general_tree<int>::node random_node(std::mt19937& rng, general_tree<int>& tree)
+    {
+        std::vector<general_tree<int>::node> nodes = {tree.root()};
+        for (std::size_t i = 0; i < nodes.size(); i++)
+        {
+            for (auto child : general_tree<int>::children(nodes[i]))
+                nodes.push_back(child);
+        }
+        return nodes[std::uniform_int_distribution<std::size_t>(0, nodes.size() - 1)(rng)];
+    }
+}
+
+TEST_CASE("general_tree::diff and general_tree::apply")
+{
+    const tree_type original = filesystem_tree();
+    tree_type target = filesystem_tree();
+
+    SUBCASE("equal trees give an empty script")
+    {
+        REQUIRE(tree_type::diff(original, target).empty());
+    }
+
+    SUBCASE("value change is one update")
+    {
+        target.root().child(2).left_child().data() = "admin";
+        const auto script = check_round_trip(original, target);
+        REQUIRE_EQ(script.size(), 1);
+        REQUIRE_EQ(script.front().kind, edit_kind::update);
+        REQUIRE(script.front().path == std::vector<std::size_t>{2, 0});
+    }
+
+    SUBCASE("new subtree is one insert")
+    {
+        auto etc = target.root().child(1);
+        auto hosts = target.insert_left_child(etc, "hosts");
+        target.insert_left_child(hosts, "backup");
+        const auto script = check_round_trip(original, target);
+        REQUIRE_EQ(script.size(), 1);
+        REQUIRE_EQ(script.front().kind, edit_kind::insert);
+        REQUIRE_EQ(script.front().values.size(), 2);
+    }
+
+    SUBCASE("removed subtree is one erase")
+    {
+        target.delete_right_sibling(target.root().child(1));
+        const auto script = check_round_trip(original, target);
+        REQUIRE_EQ(script.size(), 1);
+        REQUIRE_EQ(script.front().kind, edit_kind::erase);
+    }
+
+    SUBCASE("reordered children are moved, not copied")
+    {
+        tree_type reordered("/");
+        auto var = reordered.insert_left_child(reordered.root(), "var");
+        reordered.insert_left_child(var, "log");
+        auto bin = reordered.insert_right_sibling(var, "bin");
+        auto etc = reordered.insert_right_sibling(bin, "etc");
+        auto home = reordered.insert_right_sibling(etc, "home");
+        auto user = reordered.insert_left_child(home, "user");
+        auto docs = reordered.insert_left_child(user, "Documents");
+        reordered.insert_right_sibling(docs, "Projects");
+
+        const auto script = check_round_trip(original, reordered);
+        REQUIRE_EQ(script.size(), 1);
+        REQUIRE_EQ(script.front().kind, edit_kind::move);
+    }
+
+    SUBCASE("subtree moved to another parent is one move")
+    {
+        tree_type moved("/");
+        auto bin = moved.insert_left_child(moved.root(), "bin");
+        auto etc = moved.insert_right_sibling(bin, "etc");
+        auto home = moved.insert_right_sibling(etc, "home");
+        auto var = moved.insert_right_sibling(home, "var");
+        moved.insert_left_child(home, "user");
+        auto log = moved.insert_left_child(var, "log");
+        auto docs = moved.insert_right_sibling(log, "Documents");
+        moved.insert_right_sibling(docs, "Projects");
+
+        const auto script = check_round_trip(original, moved);
+        REQUIRE_EQ(count_kind(script, edit_kind::move), 2);
+        REQUIRE_EQ(count_kind(script, edit_kind::insert), 0);
+        REQUIRE_EQ(count_kind(script, edit_kind::erase), 0);
+    }
+
+    SUBCASE("swapped and edited children keep their order")
+    {
+        tree_type a("r");
+        auto x = a.insert_left_child(a.root(), "x");
+        a.insert_left_child(x, "1");
+        auto y = a.insert_right_sibling(x, "y");
+        a.insert_left_child(y, "2");
+        a.insert_right_sibling(y, "z");
+
+        tree_type b("r");
+        auto y2 = b.insert_left_child(b.root(), "y");
+        b.insert_left_child(y2, "3");
+        auto w = b.insert_right_sibling(y2, "w");
+        b.insert_left_child(w, "4");
+        b.insert_right_sibling(w, "z");
+
+        check_round_trip(a, b);
+        check_round_trip(b, a);
+    }
+
+    SUBCASE("empty trees")
+    {
+        const tree_type empty;
+        check_round_trip(empty, original);
+        check_round_trip(original, empty);
+        REQUIRE(tree_type::diff(empty, tree_type()).empty());
+    }
+
+    SUBCASE("random edits of large trees")
+    {
+        std::mt19937 rng(7);
+        for (int round = 0; round < 20; round++)
+        {
+            const general_tree<int> a = random_tree(rng, 2000);
+            general_tree<int> b(a);
+            const int edits = 1 + round % 5;
+            for (int i = 0; i < edits; i++)
+            {
+                auto n = random_node(rng, b);
+                switch (rng() % 3)
+                {
+                case 0:
+                    n.data() = 1000 + i;
+                    break;
+                case 1:
+                    b.insert_left_child(n, 2000 + i);
+                    break;
+                default:
+                    if (!n.left_child().is_null())
+                        b.delete_left_child(n);
+                    break;
+                }
+            }
+
+            const auto script = general_tree<int>::diff(a, b);
+            general_tree<int> patched(a);
+            patched.apply(script);
+            REQUIRE(patched == b);
+            REQUIRE_EQ(patched.size(), b.size());
+            REQUIRE_LE(script.size(), static_cast<std::size_t>(4 * edits));
+        }
+    }
+
+    SUBCASE("deep trees do not exhaust the stack")
+    {
+        general_tree<int> a(0);
+        auto last = a.root();
+        for (int i = 1; i < 100000; i++)
+            last = a.insert_left_child(last, i);
+        general_tree<int> b(a);
+        b.insert_left_child(b.root(), -1);
+
+        auto script = general_tree<int>::diff(a, b);
+        REQUIRE_EQ(script.size(), 1);
+        a.apply(script);
+        REQUIRE(a == b);
+    }
+
+    SUBCASE("throw invalid argument on a bad script and leave the tree unchanged")
+    {
+        using op = tree_type::edit_operation;
+        const std::vector<tree_type::edit_script> bad_scripts = {
+            {op{edit_kind::update, {7}, {}, 0, {"x"}, {}}},                                 // path not in the tree
+            {op{edit_kind::update, {0}, {}, 0, {}, {}}},                                    // update without a value
+            {op{edit_kind::erase, {2}, {}, 0, {}, {}}, op{edit_kind::erase, {2, 0}, {}, 0, {}, {}}}, // nested erase
+            {op{edit_kind::erase, {1}, {}, 0, {}, {}}, op{edit_kind::erase, {1}, {}, 0, {}, {}}},    // erased twice
+            {op{edit_kind::move, {2}, {2, 0}, 0, {}, {}}},                                  // into its own subtree
+            {op{edit_kind::move, {}, {0}, 0, {}, {}}},                                      // the root
+            {op{edit_kind::insert, {}, {1}, 3, {"x"}, {tree_type::no_index}}},              // position out of range
+            {op{edit_kind::insert, {}, {1}, 0, {"x", "y"}, {tree_type::no_index, 5}}},      // malformed subtree
+        };
+
+        for (const auto& script : bad_scripts)
+        {
+            tree_type patched(original);
+            CHECK_THROWS_AS(patched.apply(script), std::invalid_argument);
+            REQUIRE(patched == original);
+        }
+    }
+}
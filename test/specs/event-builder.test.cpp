@@ -0,0 +1,143 @@
+#include "general-tree.h"
+#include "utils/fixtures/lifecycle-counter.fixture.h"
+#include <doctest.h>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace
+{
+    auto to_string = [](std::string_view atom) { return std::string(atom); };
+
+    std::vector<std::string> preorder(const general_tree<std::string>& tree)
+    {
+        return std::vector<std::string>(tree.begin(), tree.end());
+    }
+}
+
+TEST_CASE_FIXTURE(LifecycleCounterFixture, "general_tree::event_builder")
+{
+    SUBCASE("children are appended in order")
+    {
+        general_tree<int>::event_builder builder;
+        builder.start_node(0);
+        for (int i = 1; i <= 3; i++)
+        {
+            builder.start_node(i);
+            builder.add_leaf(i * 10);
+            builder.add_leaf(i * 10 + 1);
+            builder.end_node();
+        }
+        REQUIRE_EQ(builder.depth(), 1);
+        builder.end_node();
+        REQUIRE_EQ(builder.size(), 10);
+
+        general_tree<int> gt = std::move(builder).seal();
+        REQUIRE_EQ(gt.size(), 10);
+        const std::vector<int> expected = {0, 1, 10, 11, 2, 20, 21, 3, 30, 31};
+        REQUIRE(std::vector<int>(gt.begin(), gt.end()) == expected);
+        REQUIRE_EQ(gt.root().child(2).left_child().parent().data(), 3);
+    }
+
+    SUBCASE("deep trees")
+    {
+        general_tree<int>::event_builder builder;
+        for (int i = 0; i < 100000; i++)
+            builder.start_node(i);
+        for (int i = 0; i < 100000; i++)
+            builder.end_node();
+
+        general_tree<int> gt = std::move(builder).seal();
+        REQUIRE_EQ(gt.size(), 100000);
+        REQUIRE_EQ(gt.root().descendants_count(), 99999);
+    }
+
+    SUBCASE("throw runtime error on unbalanced events")
+    {
+        general_tree<int>::event_builder builder;
+        CHECK_THROWS_AS(builder.end_node(), std::runtime_error);
+        builder.add_leaf(0);
+        CHECK_THROWS_AS(builder.start_node(1), std::runtime_error);
+
+        general_tree<int>::event_builder open;
+        open.start_node(0);
+        CHECK_THROWS_AS(std::move(open).seal(), std::runtime_error);
+    }
+
+    SUBCASE("an abandoned builder frees its nodes")
+    {
+        {
+            general_tree<LifecycleCounter>::event_builder builder;
+            builder.start_node("root", 0);
+            builder.add_leaf("leaf", 1);
+            builder.start_node("inner", 2);
+        }
+        REQUIRE_EQ(LifecycleCounter::destructor_calls, 3);
+    }
+}
+
+TEST_CASE("general_tree::sexpr_parser")
+{
+    SUBCASE("lists hold the value of the node followed by its children")
+    {
+        std::istringstream stream("(root leaf (inner \"quoted atom\" x) \"esc\\\"aped\")");
+        general_tree<std::string> gt = general_tree<std::string>::parse_sexpr(stream, to_string);
+
+        const std::vector<std::string> expected = {"root", "leaf", "inner", "quoted atom", "x", "esc\"aped"};
+        REQUIRE(preorder(gt) == expected);
+        REQUIRE_EQ(gt.root().children_count(), 3);
+        REQUIRE_EQ(gt.root().child(1).children_count(), 2);
+    }
+
+    SUBCASE("same tree whatever the chunk boundaries")
+    {
+        const std::string document = "(a (bb c \"d e\") (ffff (g h) i) \"j\\\\k\" lmnop)";
+        general_tree<std::string>::sexpr_parser whole(to_string);
+        whole.feed(document);
+        const general_tree<std::string> expected = std::move(whole).finish();
+        REQUIRE_EQ(expected.size(), 10);
+
+        for (std::size_t chunk = 1; chunk <= 7; chunk++)
+        {
+            general_tree<std::string>::sexpr_parser parser(to_string);
+            for (std::size_t i = 0; i < document.size(); i += chunk)
+                parser.feed(std::string_view(document).substr(i, chunk));
+            REQUIRE(std::move(parser).finish() == expected);
+        }
+    }
+
+    SUBCASE("atoms are converted to the value type")
+    {
+        general_tree<int>::sexpr_parser parser([](std::string_view atom) { return std::stoi(std::string(atom)); });
+        parser.feed("(1 2 (3 4)\n  5)");
+        general_tree<int> gt = std::move(parser).finish();
+        const std::vector<int> expected = {1, 2, 3, 4, 5};
+        REQUIRE(std::vector<int>(gt.begin(), gt.end()) == expected);
+    }
+
+    SUBCASE("a single atom is a root without children")
+    {
+        general_tree<std::string>::sexpr_parser parser(to_string);
+        parser.feed("  alone  ");
+        general_tree<std::string> gt = std::move(parser).finish();
+        REQUIRE_EQ(gt.size(), 1);
+        REQUIRE_EQ(gt.root().data(), "alone");
+    }
+
+    SUBCASE("throw runtime error on malformed documents")
+    {
+        for (std::string_view document : {"", "(a b", "(a b))", "()", "((a) b)", "(a \"b)", "a b", "(a) (b)"})
+        {
+            CHECK_THROWS_AS(
+                [&] {
+                    general_tree<std::string>::sexpr_parser parser(to_string);
+                    parser.feed(document);
+                    return std::move(parser).finish();
+                }(),
+                std::runtime_error
+            );
+        }
+    }
+}
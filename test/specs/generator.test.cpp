@@ -0,0 +1,150 @@
+#include "general-tree.h"
+#include <doctest.h>
+#include <ranges>
+#include <stdexcept>
+#include <vector>
+
+static_assert(std::ranges::input_range<general_tree<int>::generator>);
+
+TEST_CASE("general_tree::generator")
+{
+    /*
+            1
+          / | \
+         2  3  4
+        / \     \
+       5   6     7
+    */
+    general_tree<int> mytree;
+    mytree.create_root(1);
+    auto n2 = mytree.insert_left_child(mytree.root(), 2);
+    auto n3 = mytree.insert_right_sibling(n2, 3);
+    auto n4 = mytree.insert_right_sibling(n3, 4);
+    auto n5 = mytree.insert_left_child(n2, 5);
+    mytree.insert_right_sibling(n5, 6);
+    mytree.insert_left_child(n4, 7);
+
+    SUBCASE("preorder walk")
+    {
+        const std::vector<int> expected_result = {1, 2, 5, 6, 3, 4, 7};
+        std::vector<int> traversal;
+        for (auto n : general_tree<int>::preorder(mytree.root()))
+            traversal.push_back(n.data());
+        REQUIRE_EQ(expected_result, traversal);
+    }
+
+    SUBCASE("postorder walk")
+    {
+        const std::vector<int> expected_result = {5, 6, 2, 3, 7, 4, 1};
+        std::vector<int> traversal;
+        for (auto n : general_tree<int>::postorder(mytree.root()))
+            traversal.push_back(n.data());
+        REQUIRE_EQ(expected_result, traversal);
+    }
+
+    SUBCASE("walks stay inside the subtree")
+    {
+        const std::vector<int> expected_preorder = {2, 5, 6};
+        const std::vector<int> expected_postorder = {5, 6, 2};
+        std::vector<int> preorder;
+        std::vector<int> postorder;
+        for (auto n : general_tree<int>::preorder(n2))
+            preorder.push_back(n.data());
+        for (auto n : general_tree<int>::postorder(n2))
+            postorder.push_back(n.data());
+        REQUIRE_EQ(expected_preorder, preorder);
+        REQUIRE_EQ(expected_postorder, postorder);
+    }
+
+    SUBCASE("single node walks")
+    {
+        const std::vector<int> expected_result = {3};
+        std::vector<int> preorder;
+        std::vector<int> postorder;
+        for (auto n : general_tree<int>::preorder(n3))
+            preorder.push_back(n.data());
+        for (auto n : general_tree<int>::postorder(n3))
+            postorder.push_back(n.data());
+        REQUIRE_EQ(expected_result, preorder);
+        REQUIRE_EQ(expected_result, postorder);
+    }
+
+    SUBCASE("filter walk skips rejected subtrees")
+    {
+        const std::vector<int> expected_result = {1, 3, 4, 7};
+        std::vector<int> traversal;
+        for (auto n : general_tree<int>::filter_walk(mytree.root(), [](auto n) { return n.data() != 2; }))
+            traversal.push_back(n.data());
+        REQUIRE_EQ(expected_result, traversal);
+    }
+
+    SUBCASE("filter walk rejecting the start node yields nothing")
+    {
+        auto walk = general_tree<int>::filter_walk(mytree.root(), [](auto) { return false; });
+        REQUIRE_FALSE(walk.next());
+        REQUIRE(walk.done());
+    }
+
+    SUBCASE("walks can be suspended and resumed")
+    {
+        auto walk = general_tree<int>::preorder(mytree.root());
+        REQUIRE(walk.next());
+        REQUIRE_EQ(walk.current().data(), 1);
+        REQUIRE(walk.next());
+        REQUIRE_EQ(walk.current().data(), 2);
+
+        // another walk in between
+        auto other = general_tree<int>::postorder(mytree.root());
+        REQUIRE(other.next());
+        REQUIRE_EQ(other.current().data(), 5);
+
+        // the range continues from the current node
+        const std::vector<int> expected_result = {2, 5, 6, 3, 4, 7};
+        std::vector<int> traversal;
+        for (auto n : walk)
+            traversal.push_back(n.data());
+        REQUIRE_EQ(expected_result, traversal);
+        REQUIRE_FALSE(walk.next());
+    }
+
+    SUBCASE("walks can be moved")
+    {
+        auto walk = general_tree<int>::preorder(n2);
+        walk.next();
+        auto moved = std::move(walk);
+        REQUIRE(moved.next());
+        REQUIRE_EQ(moved.current().data(), 5);
+    }
+
+    SUBCASE("predicate exceptions are rethrown when resuming")
+    {
+        auto walk = general_tree<int>::filter_walk(mytree.root(), [](auto n) {
+            if (n.data() == 3)
+                throw std::runtime_error("predicate failure");
+            return true;
+        });
+
+        for (int i = 0; i < 4; i++)
+            REQUIRE(walk.next());
+        CHECK_THROWS_AS(walk.next(), std::runtime_error);
+    }
+
+    SUBCASE("creating many walks reuses coroutine frames")
+    {
+        int total = 0;
+        for (int i = 0; i < 1000; i++)
+        {
+            for (auto n : general_tree<int>::preorder(n2))
+                total += n.data();
+        }
+        REQUIRE_EQ(total, 13000);
+    }
+
+    SUBCASE("throw invalid argument if node is null")
+    {
+        general_tree<int> empty;
+        CHECK_THROWS_AS(general_tree<int>::preorder(empty.root()), std::invalid_argument);
+        CHECK_THROWS_AS(general_tree<int>::postorder(empty.root()), std::invalid_argument);
+        CHECK_THROWS_AS(general_tree<int>::filter_walk(empty.root(), [](auto) { return true; }), std::invalid_argument);
+    }
+}
@@ -0,0 +1,279 @@
+#include "general-tree.h"
+#include <doctest.h>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+namespace
+{
+    struct journal_files
+    {
+        std::string checkpoint = (std::filesystem::temp_directory_path() / "general-tree-journal.checkpoint").string();
+        std::string log = (std::filesystem::temp_directory_path() / "general-tree-journal.log").string();
+
+        journal_files()
+        {
+            remove();
+        }
+
+        ~journal_files()
+        {
+            remove();
+        }
+
+        void remove() const
+        {
+            std::filesystem::remove(checkpoint);
+            std::filesystem::remove(log);
+        }
+    };
+
+    using journaled_tree = general_tree<int>::journaled_tree<>;
+
+    // root 0 with children 1, 2, 3; 2 has children 4, 5
+    void build(journaled_tree& jt)
+    {
+        auto root = jt.emplace_root(0);
+        auto first = jt.emplace_left_child(root, 1);
+        auto second = jt.emplace_right_sibling(first, 2);
+        jt.insert_right_sibling(second, 3);
+        auto fourth = jt.insert_left_child(second, 4);
+        jt.emplace_right_sibling(fourth, 5);
+    }
+}
+
+TEST_CASE("general_tree::journaled_tree")
+{
+    journal_files files;
+
+    SUBCASE("the log is replayed when the tree is opened again")
+    {
+        general_tree<int> expected;
+        {
+            journaled_tree jt(files.checkpoint, files.log);
+            build(jt);
+            jt.delete_right_sibling(jt.root().left_child());
+            jt.emplace_left_child(jt.root(), 6);
+            REQUIRE_EQ(jt.records_since_checkpoint(), 8);
+            expected = jt.tree();
+        }
+
+        journaled_tree reopened(files.checkpoint, files.log);
+        REQUIRE_EQ(reopened.size(), 4);
+        REQUIRE(reopened.tree() == expected);
+
+        // operations keep being appended after the replayed ones
+        reopened.emplace_left_child(reopened.root().left_child(), 7);
+        expected = reopened.tree();
+        reopened.sync();
+        REQUIRE(journaled_tree(files.checkpoint, files.log).tree() == expected);
+    }
+
+    SUBCASE("checkpoint followed by more operations")
+    {
+        general_tree<int> expected;
+        {
+            journaled_tree jt(files.checkpoint, files.log);
+            build(jt);
+            jt.checkpoint();
+            REQUIRE_EQ(jt.records_since_checkpoint(), 0);
+
+            // ids are renumbered by the checkpoint, handles stay valid
+            auto third = jt.root().child(2);
+            jt.delete_left_child(third.parent().child(1));
+            jt.emplace_left_child(third, 8);
+            expected = jt.tree();
+        }
+
+        journaled_tree reopened(files.checkpoint, files.log);
+        REQUIRE(reopened.tree() == expected);
+    }
+
+    SUBCASE("clear is replayed and nodes created after it get new ids")
+    {
+        general_tree<int> expected;
+        {
+            journaled_tree jt(files.checkpoint, files.log);
+            build(jt);
+            jt.clear();
+            REQUIRE(jt.empty());
+            auto root = jt.emplace_root(10);
+            jt.emplace_left_child(root, 11);
+            expected = jt.tree();
+        }
+
+        journaled_tree reopened(files.checkpoint, files.log);
+        REQUIRE(reopened.tree() == expected);
+    }
+
+    SUBCASE("subtree insertions are replayed and their nodes get ids")
+    {
+        general_tree<int> expected;
+        {
+            journaled_tree jt(files.checkpoint, files.log);
+            build(jt);
+
+            general_tree<int> left(20);
+            left.insert_right_sibling(left.insert_left_child(left.root(), 21), 22);
+            auto inserted = jt.insert_left_child(jt.root().child(1), left);
+            REQUIRE(left.empty());
+
+            general_tree<int> right(30);
+            right.insert_left_child(right.root(), 31);
+            jt.insert_right_sibling(jt.root().left_child(), right);
+
+            general_tree<int> empty;
+            REQUIRE(jt.insert_left_child(jt.root(), empty).is_null());
+            REQUIRE_EQ(jt.records_since_checkpoint(), 8);
+
+            // the nodes of the inserted subtrees can be used in later operations
+            jt.emplace_left_child(inserted.child(1), 23);
+            jt.delete_left_child(inserted);
+            expected = jt.tree();
+        }
+
+        journaled_tree reopened(files.checkpoint, files.log);
+        REQUIRE(reopened.tree() == expected);
+        REQUIRE_EQ(reopened.size(), expected.size());
+    }
+
+    SUBCASE("a torn record at the end of the log is discarded")
+    {
+        general_tree<int> expected;
+        {
+            journaled_tree jt(files.checkpoint, files.log);
+            build(jt);
+            expected = jt.tree();
+            jt.emplace_left_child(jt.root(), 9);
+        }
+
+        std::filesystem::resize_file(files.log, std::filesystem::file_size(files.log) - 2);
+        {
+            journaled_tree reopened(files.checkpoint, files.log);
+            REQUIRE(reopened.tree() == expected);
+
+            // the torn bytes are dropped before appending
+            reopened.emplace_left_child(reopened.root(), 12);
+            expected = reopened.tree();
+        }
+        REQUIRE(journaled_tree(files.checkpoint, files.log).tree() == expected);
+    }
+
+    SUBCASE("a corrupted record ends the replay")
+    {
+        general_tree<int> expected;
+        {
+            journaled_tree jt(files.checkpoint, files.log);
+            build(jt);
+            expected = jt.tree();
+            jt.emplace_left_child(jt.root(), 9);
+        }
+
+        // flip a byte of the checksum of the last record
+        const auto size = std::filesystem::file_size(files.log);
+        std::fstream log(files.log, std::ios::binary | std::ios::in | std::ios::out);
+        log.seekg(static_cast<std::streamoff>(size - 1));
+        const char last = static_cast<char>(log.get());
+        log.seekp(static_cast<std::streamoff>(size - 1));
+        log.put(static_cast<char>(last ^ 0x5a));
+        log.close();
+
+        REQUIRE(journaled_tree(files.checkpoint, files.log).tree() == expected);
+    }
+
+    SUBCASE("the log of an older checkpoint is ignored")
+    {
+        general_tree<int> expected;
+        {
+            journaled_tree jt(files.checkpoint, files.log);
+            build(jt);
+            jt.sync();
+            std::filesystem::copy_file(files.log, files.log + ".old");
+            jt.checkpoint();
+            expected = jt.tree();
+        }
+
+        // as if the process stopped between writing the checkpoint and starting the new log
+        std::filesystem::rename(files.log + ".old", files.log);
+        REQUIRE(journaled_tree(files.checkpoint, files.log).tree() == expected);
+    }
+
+    SUBCASE("a failed checkpoint keeps the previous checkpoint and log")
+    {
+        general_tree<int> expected;
+        {
+            journaled_tree jt(files.checkpoint, files.log);
+            build(jt);
+
+            // the temporary log cannot be created
+            std::filesystem::create_directory(files.log + ".tmp");
+            CHECK_THROWS_AS(jt.checkpoint(), std::runtime_error);
+            std::filesystem::remove(files.log + ".tmp");
+            std::filesystem::remove(files.checkpoint + ".tmp");
+            REQUIRE_FALSE(std::filesystem::exists(files.checkpoint));
+
+            jt.emplace_left_child(jt.root(), 8);
+            expected = jt.tree();
+        }
+        REQUIRE(journaled_tree(files.checkpoint, files.log).tree() == expected);
+    }
+
+    SUBCASE("a checkpoint that fails after replacing the previous one leaves the log unusable")
+    {
+        general_tree<int> expected;
+        {
+            journaled_tree jt(files.checkpoint, files.log);
+            build(jt);
+            expected = jt.tree();
+
+            // the new log cannot replace the previous one
+            std::filesystem::remove(files.log);
+            std::filesystem::create_directories(files.log + "/blocked");
+            CHECK_THROWS_AS(jt.checkpoint(), std::runtime_error);
+            REQUIRE(std::filesystem::exists(files.checkpoint));
+
+            CHECK_THROWS_AS(jt.emplace_left_child(jt.root(), 8), std::runtime_error);
+            CHECK_THROWS_AS(jt.delete_left_child(jt.root()), std::runtime_error);
+            REQUIRE(jt.tree() == expected);
+        }
+
+        std::filesystem::remove_all(files.log);
+        std::filesystem::remove(files.log + ".tmp");
+        REQUIRE(journaled_tree(files.checkpoint, files.log).tree() == expected);
+    }
+
+    SUBCASE("string values")
+    {
+        const std::string checkpoint = files.checkpoint;
+        const std::string log = files.log;
+        general_tree<std::string> expected;
+        {
+            general_tree<std::string>::journaled_tree<> jt(checkpoint, log);
+            auto root = jt.emplace_root("root");
+            jt.emplace_left_child(root, std::string(1000, 'x'));
+            jt.checkpoint();
+            jt.emplace_left_child(root, "");
+            expected = jt.tree();
+        }
+        REQUIRE(general_tree<std::string>::journaled_tree<>(checkpoint, log).tree() == expected);
+    }
+
+    SUBCASE("throw invalid argument on null, foreign or root nodes")
+    {
+        journaled_tree jt(files.checkpoint, files.log);
+        build(jt);
+        general_tree<int> other(1);
+
+        CHECK_THROWS_AS(jt.emplace_left_child(nullptr, 1), std::invalid_argument);
+        CHECK_THROWS_AS(jt.emplace_left_child(other.root(), 1), std::invalid_argument);
+        CHECK_THROWS_AS(jt.emplace_right_sibling(jt.root(), 1), std::invalid_argument);
+        CHECK_THROWS_AS(jt.delete_right_sibling(jt.root()), std::invalid_argument);
+        CHECK_THROWS_AS(jt.delete_left_child(other.root()), std::invalid_argument);
+        CHECK_THROWS_AS(jt.emplace_root(1), std::runtime_error);
+        CHECK_THROWS_AS(jt.insert_left_child(other.root(), other), std::invalid_argument);
+        CHECK_THROWS_AS(jt.insert_right_sibling(jt.root(), other), std::invalid_argument);
+        REQUIRE_EQ(jt.records_since_checkpoint(), 6);
+        REQUIRE_EQ(other.size(), 1);
+    }
+}
@@ -0,0 +1,225 @@
+#include "general-tree-mapped.h"
+#include <cstdint>
+#include <doctest.h>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+namespace
+{
+    std::string temporary_path(const char* name)
+    {
+        return (std::filesystem::temp_directory_path() / name).string();
+    }
+
+    // compares shape and values node by node using both navigation interfaces
+    bool same_tree(const general_tree<std::uint64_t>& expected, const mapped_tree<std::uint64_t>& mapped)
+    {
+        auto left = expected.root();
+        auto right = mapped.root();
+        while (!left.is_null())
+        {
+            if (right.is_null() || left.data() != right.data() || left.is_leaf() != right.is_leaf() ||
+                left.has_right_sibling() != right.has_right_sibling() ||
+                left.descendants_count() != right.descendants_count())
+                return false;
+
+            if (left.has_left_child())
+            {
+                left = left.left_child();
+                right = right.left_child();
+                continue;
+            }
+            while (!left.is_root() && !left.has_right_sibling())
+            {
+                left = left.parent();
+                right = right.parent();
+            }
+            if (left.is_root())
+                return right.is_root();
+            left = left.right_sibling();
+            right = right.right_sibling();
+        }
+        return right.is_null();
+    }
+}
+
+TEST_CASE("mapped_tree")
+{
+    const std::string path = temporary_path("general-tree-mapped.test.bin");
+
+    SUBCASE("round trip keeps shape and values")
+    {
+        general_tree<std::uint64_t> gt(0);
+        std::uint64_t counter = 1;
+        auto last = gt.root();
+        for (int i = 0; i < 200; i++)
+        {
+            auto child = gt.insert_left_child(last, counter++);
+            gt.insert_right_sibling(child, counter++);
+            gt.insert_left_child(child, counter++);
+            last = i % 3 == 0 ? gt.root() : child;
+        }
+
+        mapped_tree<std::uint64_t>::write(gt, path);
+        mapped_tree<std::uint64_t> mapped(path);
+        REQUIRE_EQ(mapped.size(), gt.size());
+        REQUIRE(same_tree(gt, mapped));
+
+        // values are laid out in preorder
+        auto it = gt.begin();
+        bool preorder = true;
+        for (std::uint64_t value : mapped.values())
+            preorder = preorder && value == *it++;
+        REQUIRE(preorder);
+    }
+
+    SUBCASE("node interface")
+    {
+        general_tree<std::uint64_t> gt(1);
+        auto second = gt.insert_left_child(gt.root(), 3);
+        gt.insert_left_child(gt.root(), 2);
+        gt.insert_left_child(second, 4);
+
+        mapped_tree<std::uint64_t>::write(gt, path);
+        mapped_tree<std::uint64_t> mapped(path);
+
+        auto root = mapped.root();
+        REQUIRE(root.is_root());
+        REQUIRE(root.parent().is_null());
+        REQUIRE(root.right_sibling().is_null());
+        REQUIRE_EQ(root.children_count(), 2);
+        REQUIRE_EQ(root.child(0).data(), 2);
+        REQUIRE_EQ(root.child(1).data(), 3);
+        REQUIRE(root.child(2).is_null());
+        REQUIRE_EQ(root.child(1).left_child().data(), 4);
+        REQUIRE_EQ(root.child(1).left_child().depth(), 2);
+        REQUIRE(root.child(1).left_child().parent() == root.child(1));
+        REQUIRE_EQ(root.descendants_count(), 3);
+        CHECK_THROWS_AS(mapped_tree<std::uint64_t>::node().data(), std::invalid_argument);
+    }
+
+    SUBCASE("deep trees")
+    {
+        general_tree<std::uint64_t> gt(0);
+        auto last = gt.root();
+        for (std::uint64_t i = 1; i < 100000; i++)
+            last = gt.insert_left_child(last, i);
+
+        mapped_tree<std::uint64_t>::write(gt, path);
+        mapped_tree<std::uint64_t> mapped(path);
+        REQUIRE(same_tree(gt, mapped));
+        REQUIRE_EQ(mapped.root().descendants_count(), 99999);
+    }
+
+    SUBCASE("empty tree")
+    {
+        general_tree<std::uint64_t> gt;
+        mapped_tree<std::uint64_t>::write(gt, path);
+        mapped_tree<std::uint64_t> mapped(path);
+        REQUIRE(mapped.empty());
+        REQUIRE(mapped.root().is_null());
+        REQUIRE(mapped.values().empty());
+    }
+
+    SUBCASE("move transfers the mapping")
+    {
+        general_tree<std::uint64_t> gt(7);
+        mapped_tree<std::uint64_t>::write(gt, path);
+        mapped_tree<std::uint64_t> mapped(path);
+        mapped_tree<std::uint64_t> moved(std::move(mapped));
+        REQUIRE_EQ(moved.root().data(), 7);
+        REQUIRE(mapped.empty());
+    }
+
+    SUBCASE("throw runtime error on invalid files")
+    {
+        CHECK_THROWS_AS(mapped_tree<std::uint64_t>{temporary_path("general-tree-missing.bin")}, std::runtime_error);
+
+        general_tree<std::uint64_t> gt(7);
+        mapped_tree<std::uint64_t>::write(gt, path);
+        CHECK_THROWS_AS(mapped_tree<std::uint32_t>{path}, std::runtime_error);
+
+        // truncated file
+        std::filesystem::resize_file(path, std::filesystem::file_size(path) - 1);
+        CHECK_THROWS_AS(mapped_tree<std::uint64_t>{path}, std::runtime_error);
+
+        std::ofstream(path, std::ios::binary | std::ios::trunc) << "not a tree";
+        CHECK_THROWS_AS(mapped_tree<std::uint64_t>{path}, std::runtime_error);
+    }
+
+    SUBCASE("throw runtime error on corrupted headers")
+    {
+        general_tree<std::uint64_t> gt(7);
+        gt.insert_left_child(gt.root(), 8);
+
+        // the header fields after magic, version, byte order and value size, in order
+        const auto corrupt = [&](std::size_t field, std::uint64_t value) {
+            mapped_tree<std::uint64_t>::write(gt, path);
+            std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+            file.seekp(static_cast<std::streamoff>(16 + field * sizeof(std::uint64_t)));
+            file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+        };
+
+        // a size that would overflow the computed offsets
+        corrupt(0, std::uint64_t(1) << 62);
+        CHECK_THROWS_AS(mapped_tree<std::uint64_t>{path}, std::runtime_error);
+
+        // columns outside the file
+        for (std::size_t field : {1, 2, 3})
+        {
+            corrupt(field, std::uint64_t(1) << 36);
+            CHECK_THROWS_AS(mapped_tree<std::uint64_t>{path}, std::runtime_error);
+        }
+    }
+
+    SUBCASE("throw runtime error on corrupted columns")
+    {
+        // 0 -> {1 -> {2}, 3}
+        general_tree<std::uint64_t> gt(0);
+        auto first = gt.insert_left_child(gt.root(), 1);
+        gt.insert_right_sibling(first, 3);
+        gt.insert_left_child(first, 2);
+
+        // the parent column starts at offset 64, the subtree size column follows it
+        const auto corrupt = [&](std::size_t column, std::size_t index, std::uint64_t value) {
+            mapped_tree<std::uint64_t>::write(gt, path);
+            std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+            file.seekp(static_cast<std::streamoff>(64 + (column * gt.size() + index) * sizeof(std::uint64_t)));
+            file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+        };
+
+        // parent outside the tree
+        corrupt(0, 2, std::uint64_t(1) << 40);
+        {
+            mapped_tree<std::uint64_t> mapped(path);
+            CHECK_THROWS_AS(mapped.root().left_child().left_child().parent(), std::runtime_error);
+        }
+
+        // parent cycle
+        corrupt(0, 1, 2);
+        {
+            mapped_tree<std::uint64_t> mapped(path);
+            CHECK_THROWS_AS(mapped.root().child(1).depth(), std::runtime_error);
+            CHECK_THROWS_AS(mapped.root().left_child().left_child().depth(), std::runtime_error);
+        }
+
+        // empty subtree
+        corrupt(1, 1, 0);
+        {
+            mapped_tree<std::uint64_t> mapped(path);
+            CHECK_THROWS_AS(mapped.root().children_count(), std::runtime_error);
+            CHECK_THROWS_AS(mapped.root().child(1), std::runtime_error);
+        }
+
+        // subtree past the end of the tree
+        corrupt(1, 3, 2);
+        {
+            mapped_tree<std::uint64_t> mapped(path);
+            CHECK_THROWS_AS(mapped.root().child(1).has_left_child(), std::runtime_error);
+        }
+    }
+
+    std::filesystem::remove(path);
+}
@@ -0,0 +1,91 @@
+#include "general-tree.h"
+#include <cstdint>
+#include <doctest.h>
+#include <set>
+#include <thread>
+
+namespace
+{
+// every subcase uses its own value type, so it starts from an empty pool
+template <int Tag>
+struct pooled_value
+{
+    int value;
+};
+
+struct alignas(64) aligned_value
+{
+    int value;
+};
+
+template <typename T>
+std::set<const void*> node_addresses(const general_tree<T>& gt)
+{
+    std::set<const void*> addresses;
+    for (const T& value : gt)
+        addresses.insert(&value);
+    return addresses;
+}
+
+template <typename T>
+general_tree<T> chain(int length)
+{
+    general_tree<T> gt(T{0});
+    auto last = gt.root();
+    for (int i = 1; i < length; i++)
+        last = gt.insert_left_child(last, T{i});
+    return gt;
+}
+} // namespace
+
+TEST_CASE("node pool")
+{
+    SUBCASE("a new tree reuses the nodes of a destroyed one")
+    {
+        using value = pooled_value<0>;
+        std::set<const void*> freed;
+        {
+            general_tree<value> gt = chain<value>(100);
+            freed = node_addresses(gt);
+        }
+        general_tree<value> gt = chain<value>(100);
+        REQUIRE(node_addresses(gt) == freed);
+    }
+
+    SUBCASE("nodes freed by a thread are reused by other threads once it exits")
+    {
+        using value = pooled_value<1>;
+        std::set<const void*> freed;
+        std::thread worker([&freed] {
+            general_tree<value> gt = chain<value>(100);
+            freed = node_addresses(gt);
+        });
+        worker.join();
+
+        general_tree<value> gt = chain<value>(100);
+        REQUIRE(node_addresses(gt) == freed);
+    }
+
+    SUBCASE("nodes freed in the background are reused")
+    {
+        using value = pooled_value<2>;
+        const int length = 100000;
+        general_tree<value> gt = chain<value>(length);
+        const std::set<const void*> freed = node_addresses(gt);
+        gt.clear_in_background();
+        general_tree<value>::wait_for_background_reclaim();
+
+        general_tree<value> other = chain<value>(length);
+        std::size_t reused = 0;
+        for (const void* address : node_addresses(other))
+            reused += freed.count(address);
+        REQUIRE_GT(reused, length / 2);
+    }
+
+    SUBCASE("over-aligned values keep their alignment")
+    {
+        general_tree<aligned_value> gt = chain<aligned_value>(1000);
+        for (const void* address : node_addresses(gt))
+            REQUIRE_EQ(reinterpret_cast<std::uintptr_t>(address) % alignof(aligned_value), 0);
+    }
+}
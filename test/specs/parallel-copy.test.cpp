@@ -0,0 +1,75 @@
+#include "general-tree.h"
+#include "utils/fixtures/lifecycle-counter.fixture.h"
+#include "utils/fixtures/throwing-copy.fixture.h"
+#include "utils/helpers/seed-tree.h"
+#include <doctest.h>
+#include <stdexcept>
+
+TEST_CASE_FIXTURE(LifecycleCounterFixture, "general_tree parallel copy")
+{
+    const std::size_t gt_size = 3000;
+    general_tree<LifecycleCounter> gt = seed_tree(gt_size);
+
+    SUBCASE("result is identical to the serial copy")
+    {
+        for (std::size_t threads : {1, 2, 4, 8})
+        {
+            general_tree<LifecycleCounter> serial(gt);
+            general_tree<LifecycleCounter> parallel(gt, general_tree<LifecycleCounter>::parallel_policy{threads});
+            REQUIRE_EQ(serial, parallel);
+            REQUIRE_EQ(parallel, gt);
+        }
+    }
+
+    SUBCASE("calls the copy constructor once per node")
+    {
+        auto copy = gt.copy({4});
+        REQUIRE_EQ(LifecycleCounter::copy_constructor_calls, gt_size);
+        REQUIRE_EQ(copy.root().descendants_count() + 1, gt_size);
+    }
+
+    SUBCASE("copy does not share nodes with the original")
+    {
+        auto copy = gt.copy(general_tree<LifecycleCounter>::par);
+        REQUIRE_NE(copy.root(), gt.root());
+        gt.clear();
+        REQUIRE_EQ(copy.root().descendants_count() + 1, gt_size);
+    }
+
+    SUBCASE("parent links of the copy are correct")
+    {
+        auto copy = gt.copy({4});
+        bool parents_ok = true;
+        for (auto n : general_tree<LifecycleCounter>::preorder(copy.root()))
+        {
+            for (auto child : general_tree<LifecycleCounter>::children(n))
+                parents_ok = parents_ok && child.parent() == n;
+        }
+        REQUIRE(parents_ok);
+        REQUIRE(copy.root().is_root());
+    }
+
+    SUBCASE("copying an empty tree")
+    {
+        general_tree<int> empty;
+        auto copy = empty.copy({4});
+        REQUIRE(copy.empty());
+    }
+}
+
+TEST_CASE("general_tree parallel copy releases everything when a copy throws")
+{
+    general_tree<ThrowingCopy> gt(0);
+    auto parent = gt.root();
+    for (int i = 1; i < 2000; i++)
+    {
+        auto child = gt.emplace_left_child(parent, i);
+        if (i % 3 == 0)
+            parent = child;
+    }
+
+    const int alive_before = ThrowingCopy::alive;
+    ThrowingCopy::copies_left = 1000;
+    CHECK_THROWS_AS(general_tree<ThrowingCopy>(gt, {4}), std::runtime_error);
+    REQUIRE_EQ(ThrowingCopy::alive.load(), alive_before);
+}
@@ -0,0 +1,73 @@
+#include "general-tree.h"
+#include "utils/fixtures/lifecycle-counter.fixture.h"
+#include "utils/helpers/seed-tree.h"
+#include <doctest.h>
+
+TEST_CASE_FIXTURE(LifecycleCounterFixture, "general_tree::equals (parallel)")
+{
+    const std::size_t gt_size = 3000;
+    general_tree<LifecycleCounter> gt = seed_tree(gt_size);
+
+    SUBCASE("identical trees are equal")
+    {
+        general_tree<LifecycleCounter> copy(gt);
+        for (std::size_t threads : {1, 2, 4, 8})
+            REQUIRE(gt.equals(copy, {threads}));
+    }
+
+    SUBCASE("a tree is equal to itself")
+    {
+        REQUIRE(gt.equals(gt, general_tree<LifecycleCounter>::par));
+    }
+
+    SUBCASE("empty trees")
+    {
+        general_tree<int> empty1;
+        general_tree<int> empty2;
+        general_tree<int> not_empty(1);
+        REQUIRE(empty1.equals(empty2, {4}));
+        REQUIRE_FALSE(empty1.equals(not_empty, {4}));
+        REQUIRE_FALSE(not_empty.equals(empty1, {4}));
+    }
+
+    SUBCASE("different sizes are rejected before comparing values")
+    {
+        general_tree<LifecycleCounter> smaller = seed_tree(gt_size - 1);
+        REQUIRE_FALSE(gt.equals(smaller, {4}));
+        REQUIRE_FALSE(gt == smaller);
+    }
+
+    SUBCASE("a different value deep in the tree")
+    {
+        general_tree<LifecycleCounter> copy(gt);
+        auto deep = copy.root();
+        while (!deep.is_leaf())
+            deep = deep.left_child().right_sibling().is_null() ? deep.left_child() : deep.left_child().right_sibling();
+        deep.data() = LifecycleCounter("different", -1);
+
+        for (std::size_t threads : {1, 4})
+            REQUIRE_FALSE(gt.equals(copy, {threads}));
+        REQUIRE_FALSE(gt == copy);
+    }
+
+    SUBCASE("same size but different shape")
+    {
+        general_tree<int> tree1(1);
+        auto a = tree1.insert_left_child(tree1.root(), 2);
+        tree1.insert_left_child(a, 3);
+
+        general_tree<int> tree2(1);
+        auto b = tree2.insert_left_child(tree2.root(), 2);
+        tree2.insert_right_sibling(b, 3);
+
+        REQUIRE_FALSE(tree1.equals(tree2, {4}));
+        REQUIRE_FALSE(tree1 == tree2);
+    }
+
+    SUBCASE("different root values")
+    {
+        general_tree<int> tree1(1);
+        general_tree<int> tree2(2);
+        REQUIRE_FALSE(tree1.equals(tree2, {4}));
+    }
+}
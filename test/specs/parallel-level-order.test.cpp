@@ -0,0 +1,102 @@
+#include "general-tree.h"
+#include "utils/fixtures/lifecycle-counter.fixture.h"
+#include "utils/helpers/seed-tree.h"
+#include <atomic>
+#include <doctest.h>
+#include <stdexcept>
+#include <vector>
+
+TEST_CASE_FIXTURE(LifecycleCounterFixture, "general_tree::parallel_level_order")
+{
+    const std::size_t gt_size = 5000;
+    general_tree<LifecycleCounter> gt = seed_tree(gt_size);
+
+    SUBCASE("visits every node exactly once")
+    {
+        for (std::size_t threads : {1, 2, 4, 8})
+        {
+            std::vector<std::atomic<int>> visits(gt_size);
+            gt.parallel_level_order(gt.root(), [&](auto n) { visits[n.data().get_int()].fetch_add(1); }, threads);
+
+            for (auto& count : visits)
+                REQUIRE_EQ(count.load(), 1);
+        }
+    }
+
+    SUBCASE("parents are processed before their children")
+    {
+        for (std::size_t threads : {1, 2, 4, 8})
+        {
+            std::vector<std::atomic<bool>> processed(gt_size);
+            std::atomic<bool> ordered = true;
+            gt.parallel_level_order(
+                gt.root(),
+                [&](auto n) {
+                    if (!n.is_root() && !processed[n.parent().data().get_int()].load())
+                        ordered.store(false);
+                    processed[n.data().get_int()].store(true);
+                },
+                threads
+            );
+            REQUIRE(ordered.load());
+        }
+    }
+
+    SUBCASE("passes the depth relative to the start node")
+    {
+        auto subtree = gt.root().left_child();
+        std::atomic<bool> correct = true;
+        std::atomic<std::size_t> count = 0;
+        gt.parallel_level_order(
+            subtree,
+            [&](auto n, std::size_t depth) {
+                if (n.depth() != depth + 1)
+                    correct.store(false);
+                count.fetch_add(1);
+            },
+            4
+        );
+        REQUIRE(correct.load());
+        REQUIRE_EQ(count.load(), subtree.descendants_count() + 1);
+    }
+
+    SUBCASE("propagates values from the root down")
+    {
+        general_tree<int> tree(0);
+        auto last = tree.root();
+        for (int i = 0; i < 3000; i++)
+        {
+            tree.insert_left_child(last, 0);
+            last = tree.insert_left_child(last, 0);
+        }
+
+        tree.parallel_level_order(
+            tree.root(),
+            [](auto n) {
+                if (!n.is_root())
+                    n.data() = n.parent().data() + 1;
+            },
+            4
+        );
+
+        bool correct = true;
+        for (auto n = tree.root(); !n.is_null(); n = n.left_child())
+            correct = correct && static_cast<std::size_t>(n.data()) == n.depth();
+        REQUIRE(correct);
+    }
+
+    SUBCASE("rethrows the exception thrown by the function")
+    {
+        auto throwing = [](auto n) {
+            if (n.data().get_int() == 4321)
+                throw std::runtime_error("failure");
+        };
+        CHECK_THROWS_AS(gt.parallel_level_order(gt.root(), throwing, 4), std::runtime_error);
+        CHECK_THROWS_AS(gt.parallel_level_order(gt.root(), throwing, 1), std::runtime_error);
+    }
+
+    SUBCASE("throw invalid argument if the start node is null")
+    {
+        CHECK_THROWS_AS(gt.parallel_level_order(nullptr, [](auto) {}), std::invalid_argument);
+    }
+}
@@ -0,0 +1,105 @@
+#include "general-tree.h"
+#include "utils/fixtures/lifecycle-counter.fixture.h"
+#include "utils/helpers/seed-tree.h"
+#include <atomic>
+#include <doctest.h>
+#include <stdexcept>
+#include <vector>
+
+TEST_CASE_FIXTURE(LifecycleCounterFixture, "general_tree::parallel_for_each")
+{
+    const std::size_t gt_size = 5000;
+    general_tree<LifecycleCounter> gt = seed_tree(gt_size);
+
+    SUBCASE("visits every node exactly once")
+    {
+        for (std::size_t threads : {1, 2, 4, 8})
+        {
+            std::vector<std::atomic<int>> visits(gt_size);
+            gt.parallel_for_each(gt.root(), [&](auto n) { visits[n.data().get_int()].fetch_add(1); }, threads);
+
+            for (auto& count : visits)
+                REQUIRE_EQ(count.load(), 1);
+        }
+    }
+
+    SUBCASE("stays inside the given subtree")
+    {
+        auto subtree = gt.root().left_child();
+        std::atomic<std::size_t> count = 0;
+        gt.parallel_for_each(subtree, [&](auto) { count.fetch_add(1); }, 4);
+        REQUIRE_EQ(count.load(), subtree.descendants_count() + 1);
+    }
+
+    SUBCASE("single node")
+    {
+        general_tree<int> tree(7);
+        std::atomic<int> sum = 0;
+        tree.parallel_for_each(tree.root(), [&](auto n) { sum += n.data(); }, 4);
+        REQUIRE_EQ(sum.load(), 7);
+    }
+
+    SUBCASE("can be called from the function")
+    {
+        std::atomic<std::size_t> count = 0;
+        auto subtree = gt.root().left_child();
+        gt.parallel_for_each(
+            subtree,
+            [&](auto n) {
+                if (n == subtree)
+                    gt.parallel_for_each(gt.root(), [&](auto) { count.fetch_add(1); }, 4);
+            },
+            4
+        );
+        REQUIRE_EQ(count.load(), gt_size);
+    }
+
+    SUBCASE("rethrows the exception thrown by the function")
+    {
+        auto throwing = [](auto n) {
+            if (n.data().get_int() == 1234)
+                throw std::runtime_error("failure");
+        };
+        CHECK_THROWS_AS(gt.parallel_for_each(gt.root(), throwing, 4), std::runtime_error);
+    }
+
+    SUBCASE("throw invalid argument if node is null")
+    {
+        general_tree<int> empty;
+        CHECK_THROWS_AS(empty.parallel_for_each(empty.root(), [](auto) {}), std::invalid_argument);
+    }
+}
+
+TEST_CASE_FIXTURE(LifecycleCounterFixture, "general_tree::parallel_reduce")
+{
+    const std::size_t gt_size = 5000;
+    general_tree<LifecycleCounter> gt = seed_tree(gt_size);
+    const long long expected_sum = static_cast<long long>(gt_size) * (gt_size - 1) / 2;
+
+    SUBCASE("combines the mapped values of every node")
+    {
+        for (std::size_t threads : {1, 3, 8})
+        {
+            const long long sum = gt.parallel_reduce(
+                gt.root(), 0LL, [](auto n) { return static_cast<long long>(n.data().get_int()); },
+                [](long long a, long long b) { return a + b; }, threads
+            );
+            REQUIRE_EQ(sum, expected_sum);
+        }
+    }
+
+    SUBCASE("computes a maximum")
+    {
+        const int max = gt.parallel_reduce(
+            gt.root(), 0, [](auto n) { return n.data().get_int(); }, [](int a, int b) { return a > b ? a : b; }, 4
+        );
+        REQUIRE_EQ(max, static_cast<int>(gt_size - 1));
+    }
+
+    SUBCASE("throw invalid argument if node is null")
+    {
+        general_tree<int> empty;
+        auto sum = [](int a, int b) { return a + b; };
+        CHECK_THROWS_AS(empty.parallel_reduce(empty.root(), 0, [](auto n) { return n.data(); }, sum), std::invalid_argument);
+    }
+}
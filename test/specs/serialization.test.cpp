@@ -0,0 +1,251 @@
+#include "general-tree.h"
+#include "utils/fixtures/lifecycle-counter.fixture.h"
+#include "utils/helpers/seed-tree.h"
+#include <doctest.h>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+namespace
+{
+    struct lifecycle_counter_codec
+    {
+        void encode(general_tree<LifecycleCounter>::binary_writer& writer, const LifecycleCounter& value) const
+        {
+            writer.write_varint(value.get_string().size());
+            writer.write_bytes(value.get_string().data(), value.get_string().size());
+            writer.write_varint(static_cast<std::uint64_t>(value.get_int()));
+        }
+
+        LifecycleCounter decode(general_tree<LifecycleCounter>::binary_reader& reader) const
+        {
+            std::string string(reader.read_varint(), '\0');
+            reader.read_bytes(string.data(), string.size());
+            const int integer = static_cast<int>(reader.read_varint());
+            return LifecycleCounter(string, integer);
+        }
+    };
+}
+
+TEST_CASE_FIXTURE(LifecycleCounterFixture, "general_tree::save and general_tree::load")
+{
+    SUBCASE("round trip with a custom codec")
+    {
+        general_tree<LifecycleCounter> gt = seed_tree(5000);
+        std::stringstream stream;
+        gt.save(stream, lifecycle_counter_codec());
+
+        auto loaded = general_tree<LifecycleCounter>::load(stream, lifecycle_counter_codec());
+        REQUIRE_EQ(loaded.size(), gt.size());
+        REQUIRE(loaded == gt);
+    }
+
+    SUBCASE("round trip of trivially copyable values")
+    {
+        general_tree<double> gt(0.5);
+        auto child = gt.insert_left_child(gt.root(), 1.5);
+        gt.insert_left_child(child, 2.5);
+        gt.insert_right_sibling(child, 3.5);
+
+        std::stringstream stream;
+        gt.save(stream);
+        REQUIRE(general_tree<double>::load(stream) == gt);
+    }
+
+    SUBCASE("round trip of strings")
+    {
+        general_tree<std::string> gt("root");
+        gt.insert_left_child(gt.root(), std::string(100000, 'x'));
+        gt.insert_left_child(gt.root(), "");
+
+        std::stringstream stream;
+        gt.save(stream);
+        REQUIRE(general_tree<std::string>::load(stream) == gt);
+    }
+
+    SUBCASE("deep trees do not exhaust the stack")
+    {
+        general_tree<int> gt(0);
+        auto last = gt.root();
+        for (int i = 1; i < 100000; i++)
+            last = gt.insert_left_child(last, i);
+
+        std::stringstream stream;
+        gt.save(stream);
+        auto loaded = general_tree<int>::load(stream);
+        REQUIRE_EQ(loaded.size(), 100000);
+        REQUIRE(loaded == gt);
+    }
+
+    SUBCASE("child order is preserved")
+    {
+        general_tree<int> gt(0);
+        for (int i = 10; i > 0; i--)
+            gt.insert_left_child(gt.root(), i);
+
+        std::stringstream stream;
+        gt.save(stream);
+        auto loaded = general_tree<int>::load(stream);
+
+        int expected = 1;
+        bool ordered = true;
+        for (auto child : general_tree<int>::children(loaded.root()))
+            ordered = ordered && child.data() == expected++;
+        REQUIRE(ordered);
+    }
+
+    SUBCASE("empty tree")
+    {
+        general_tree<int> gt;
+        std::stringstream stream;
+        gt.save(stream);
+        auto loaded = general_tree<int>::load(stream);
+        REQUIRE(loaded.empty());
+        REQUIRE_EQ(loaded.size(), 0);
+    }
+
+    SUBCASE("several trees in the same stream")
+    {
+        general_tree<int> first(1);
+        general_tree<int> second(2);
+        second.insert_left_child(second.root(), 3);
+
+        std::stringstream stream;
+        first.save(stream);
+        second.save(stream);
+        REQUIRE(general_tree<int>::load(stream) == first);
+        REQUIRE(general_tree<int>::load(stream) == second);
+    }
+
+    SUBCASE("throw runtime error on malformed input without leaking nodes")
+    {
+        general_tree<LifecycleCounter> gt = seed_tree(100);
+        std::stringstream stream;
+        gt.save(stream, lifecycle_counter_codec());
+        const std::string bytes = stream.str();
+
+        std::stringstream truncated(bytes.substr(0, bytes.size() / 2));
+        CHECK_THROWS_AS(general_tree<LifecycleCounter>::load(truncated, lifecycle_counter_codec()), std::runtime_error);
+
+        std::stringstream bad_magic("XXXX" + bytes.substr(4));
+        CHECK_THROWS_AS(general_tree<LifecycleCounter>::load(bad_magic, lifecycle_counter_codec()), std::runtime_error);
+
+        std::stringstream empty;
+        CHECK_THROWS_AS(general_tree<int>::load(empty), std::runtime_error);
+
+        REQUIRE_EQ(
+            LifecycleCounter::destructor_calls,
+            LifecycleCounter::parameterized_constructor_calls + LifecycleCounter::move_constructor_calls
+        );
+    }
+}
+
+TEST_CASE_FIXTURE(LifecycleCounterFixture, "general_tree::save_compact")
+{
+    // the shape encoding byte follows the magic and the version
+    const auto encoding_of = [](const std::string& bytes) { return static_cast<int>(bytes[5]); };
+
+    SUBCASE("round trip with a custom codec")
+    {
+        general_tree<LifecycleCounter> gt = seed_tree(5000);
+        std::stringstream stream;
+        gt.save_compact(stream, lifecycle_counter_codec());
+
+        auto loaded = general_tree<LifecycleCounter>::load(stream, lifecycle_counter_codec());
+        REQUIRE_EQ(loaded.size(), gt.size());
+        REQUIRE(loaded == gt);
+    }
+
+    SUBCASE("regular fan-outs are stored as runs")
+    {
+        general_tree<int> gt(0);
+        for (int i = 0; i < 1000; i++)
+            gt.insert_left_child(gt.root(), i);
+
+        std::stringstream compact;
+        gt.save_compact(compact);
+        std::stringstream naive;
+        gt.save(naive);
+
+        REQUIRE_EQ(encoding_of(compact.str()), 2);
+        REQUIRE_LT(compact.str().size(), naive.str().size());
+        REQUIRE(general_tree<int>::load(compact) == gt);
+    }
+
+    SUBCASE("irregular shapes are stored as balanced parentheses")
+    {
+        // alternating fan-outs of 1 and 0 leave no runs to fold
+        general_tree<int> gt(0);
+        auto spine = gt.root();
+        for (int i = 1; i < 20000; i += 2)
+        {
+            auto leaf = gt.insert_left_child(spine, i);
+            spine = gt.insert_right_sibling(leaf, i + 1);
+        }
+
+        std::stringstream compact;
+        gt.save_compact(compact);
+        REQUIRE_EQ(encoding_of(compact.str()), 1);
+        auto loaded = general_tree<int>::load(compact);
+        REQUIRE_EQ(loaded.size(), gt.size());
+        REQUIRE(loaded == gt);
+    }
+
+    SUBCASE("deep trees do not exhaust the stack")
+    {
+        general_tree<int> gt(0);
+        auto last = gt.root();
+        for (int i = 1; i < 100000; i++)
+            last = gt.insert_left_child(last, i);
+
+        std::stringstream stream;
+        gt.save_compact(stream);
+        REQUIRE(general_tree<int>::load(stream) == gt);
+    }
+
+    SUBCASE("single node, empty tree and several trees in the same stream")
+    {
+        general_tree<std::string> single("root");
+        general_tree<std::string> empty;
+        general_tree<std::string> pair("a");
+        pair.insert_left_child(pair.root(), "b");
+
+        std::stringstream stream;
+        single.save_compact(stream);
+        empty.save_compact(stream);
+        pair.save_compact(stream);
+        REQUIRE(general_tree<std::string>::load(stream) == single);
+        REQUIRE(general_tree<std::string>::load(stream).empty());
+        REQUIRE(general_tree<std::string>::load(stream) == pair);
+    }
+
+    SUBCASE("throw runtime error on malformed input without leaking nodes")
+    {
+        general_tree<LifecycleCounter> gt = seed_tree(100);
+        std::stringstream stream;
+        gt.save_compact(stream, lifecycle_counter_codec());
+        const std::string bytes = stream.str();
+
+        std::stringstream truncated(bytes.substr(0, bytes.size() / 2));
+        CHECK_THROWS_AS(general_tree<LifecycleCounter>::load(truncated, lifecycle_counter_codec()), std::runtime_error);
+
+        // a header claiming one more node than the shape describes
+        std::string oversized = bytes;
+        ++oversized[6];
+        std::stringstream wrong_size(oversized);
+        CHECK_THROWS_AS(general_tree<LifecycleCounter>::load(wrong_size, lifecycle_counter_codec()), std::runtime_error);
+
+        // magic, version, encoding, size 3, then a leaf root followed by two more nodes
+        std::stringstream two_roots(std::string("GTRB\x01\x02\x03\x00\x03", 9) + std::string(12, '\0'));
+        CHECK_THROWS_AS(general_tree<int>::load(two_roots), std::runtime_error);
+
+        // size 2 as balanced parentheses: ()() is two roots
+        std::stringstream two_roots_bits(std::string("GTRB\x01\x01\x02\x05", 8) + std::string(8, '\0'));
+        CHECK_THROWS_AS(general_tree<int>::load(two_roots_bits), std::runtime_error);
+
+        REQUIRE_EQ(
+            LifecycleCounter::destructor_calls,
+            LifecycleCounter::parameterized_constructor_calls + LifecycleCounter::move_constructor_calls
+        );
+    }
+}
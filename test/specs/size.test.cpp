@@ -0,0 +1,99 @@
+#include "general-tree.h"
+#include "utils/fixtures/lifecycle-counter.fixture.h"
+#include "utils/helpers/seed-tree.h"
+#include <doctest.h>
+
+TEST_CASE_FIXTURE(LifecycleCounterFixture, "size")
+{
+    SUBCASE("empty tree has size zero")
+    {
+        general_tree<int> gt;
+        REQUIRE_EQ(gt.size(), 0);
+    }
+
+    SUBCASE("counts root, children and siblings")
+    {
+        general_tree<int> gt;
+        gt.create_root(1);
+        REQUIRE_EQ(gt.size(), 1);
+        auto left = gt.insert_left_child(gt.root(), 2);
+        gt.insert_right_sibling(left, 3);
+        gt.emplace_left_child(left, 4);
+        REQUIRE_EQ(gt.size(), 4);
+    }
+
+    SUBCASE("root value constructor")
+    {
+        general_tree<int> gt(1);
+        REQUIRE_EQ(gt.size(), 1);
+    }
+
+    SUBCASE("copies and moves keep the size")
+    {
+        general_tree<LifecycleCounter> gt = seed_tree(20);
+        REQUIRE_EQ(gt.size(), 20);
+
+        general_tree<LifecycleCounter> copy(gt);
+        REQUIRE_EQ(copy.size(), 20);
+
+        general_tree<LifecycleCounter> parallel_copy = gt.copy({4});
+        REQUIRE_EQ(parallel_copy.size(), 20);
+
+        general_tree<LifecycleCounter> assigned;
+        assigned = gt;
+        REQUIRE_EQ(assigned.size(), 20);
+
+        general_tree<LifecycleCounter> moved(std::move(gt));
+        REQUIRE_EQ(moved.size(), 20);
+        REQUIRE_EQ(gt.size(), 0);
+
+        assigned = std::move(moved);
+        REQUIRE_EQ(assigned.size(), 20);
+        REQUIRE_EQ(moved.size(), 0);
+    }
+
+    SUBCASE("inserting a tree moves its size")
+    {
+        general_tree<LifecycleCounter> gt = seed_tree(10);
+        general_tree<LifecycleCounter> left = seed_tree(5);
+        general_tree<LifecycleCounter> right = seed_tree(3);
+
+        gt.insert_left_child(gt.root(), left);
+        gt.insert_right_sibling(gt.root().left_child(), right);
+        REQUIRE_EQ(gt.size(), 18);
+        REQUIRE_EQ(left.size(), 0);
+        REQUIRE_EQ(right.size(), 0);
+    }
+
+    SUBCASE("deleting subtrees decreases the size")
+    {
+        general_tree<LifecycleCounter> gt = seed_tree(10);
+        auto left = gt.root().left_child();
+        const std::size_t right_subtree = left.right_sibling().descendants_count() + 1;
+        gt.delete_right_sibling(left);
+        REQUIRE_EQ(gt.size(), 10 - right_subtree);
+
+        const std::size_t left_subtree = left.descendants_count() + 1;
+        gt.delete_left_child(gt.root());
+        REQUIRE_EQ(gt.size(), 10 - right_subtree - left_subtree);
+        REQUIRE_EQ(gt.size(), 1);
+    }
+
+    SUBCASE("cursor edits keep the size")
+    {
+        general_tree<LifecycleCounter> gt = seed_tree(10);
+        auto cursor = gt.cursor();
+        cursor.emplace_left_child("string", 100);
+        REQUIRE_EQ(gt.size(), 11);
+        cursor.down();
+        cursor.erase();
+        REQUIRE_EQ(gt.size(), 10);
+    }
+
+    SUBCASE("clear resets the size")
+    {
+        general_tree<LifecycleCounter> gt = seed_tree(10);
+        gt.clear();
+        REQUIRE_EQ(gt.size(), 0);
+    }
+}
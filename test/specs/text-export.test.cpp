@@ -0,0 +1,142 @@
+#include "general-tree.h"
+#include "utils/helpers/filesystem-tree.h"
+#include <algorithm>
+#include <doctest.h>
+#include <sstream>
+#include <string>
+#include <string_view>
+
+namespace
+{
+    // expected drawings are written with |-- `-- and | for readability
+    std::string box_drawing(std::string_view ascii)
+    {
+        std::string result;
+        for (char c : ascii)
+        {
+            if (c == '|')
+                result += "\xe2\x94\x82";
+            else if (c == '+')
+                result += "\xe2\x94\x9c";
+            else if (c == '`')
+                result += "\xe2\x94\x94";
+            else if (c == '-')
+                result += "\xe2\x94\x80";
+            else
+                result += c;
+        }
+        return result;
+    }
+}
+
+TEST_CASE("general_tree::write_ascii")
+{
+    SUBCASE("same drawing as the README")
+    {
+        std::ostringstream stream;
+        filesystem_tree().write_ascii(stream);
+        REQUIRE_EQ(
+            stream.str(), box_drawing("/\n"
+                                      "+-- bin\n"
+                                      "+-- etc\n"
+                                      "+-- home\n"
+                                      "|   `-- user\n"
+                                      "|       +-- Documents\n"
+                                      "|       `-- Projects\n"
+                                      "`-- var\n"
+                                      "    `-- log\n")
+        );
+    }
+
+    SUBCASE("depth limit")
+    {
+        std::ostringstream stream;
+        filesystem_tree().write_ascii(stream, 1);
+        REQUIRE_EQ(stream.str(), box_drawing("/\n+-- bin\n+-- etc\n+-- home\n`-- var\n"));
+
+        std::ostringstream root_only;
+        filesystem_tree().write_ascii(root_only, 0);
+        REQUIRE_EQ(root_only.str(), "/\n");
+    }
+
+    SUBCASE("custom formatter and numbers")
+    {
+        general_tree<double> tree(1.5);
+        tree.insert_left_child(tree.root(), 0.25);
+
+        std::ostringstream numbers;
+        tree.write_ascii(numbers);
+        REQUIRE_EQ(numbers.str(), box_drawing("1.5\n`-- 0.25\n"));
+
+        std::ostringstream formatted;
+        tree.write_ascii(formatted, 10, [](general_tree<double>::text_writer& writer, double value) {
+            writer.write("<");
+            writer.write_number(static_cast<int>(value * 100));
+            writer.write('>');
+        });
+        REQUIRE_EQ(formatted.str(), box_drawing("<150>\n`-- <25>\n"));
+    }
+
+    SUBCASE("deep trees")
+    {
+        // the indentation grows with the depth, so the output of a chain is quadratic in its length
+        general_tree<int> tree(0);
+        auto last = tree.root();
+        for (int i = 1; i < 2000; i++)
+            last = tree.insert_left_child(last, i);
+
+        std::ostringstream stream;
+        tree.write_ascii(stream);
+        const std::string output = stream.str();
+        REQUIRE_EQ(std::count(output.begin(), output.end(), '\n'), 2000);
+        REQUIRE(output.ends_with(std::string(1997 * 4, ' ') + box_drawing("`-- 1999\n")));
+    }
+
+    SUBCASE("empty tree")
+    {
+        std::ostringstream stream;
+        general_tree<int>().write_ascii(stream);
+        REQUIRE(stream.str().empty());
+    }
+}
+
+TEST_CASE("general_tree::write_dot")
+{
+    SUBCASE("one vertex per node and one edge per link")
+    {
+        general_tree<std::string> tree("root");
+        auto child = tree.insert_left_child(tree.root(), "say \"hi\"\n");
+        tree.insert_left_child(child, "back\\slash");
+        tree.insert_right_sibling(child, "last");
+
+        std::ostringstream stream;
+        tree.write_dot(stream);
+        REQUIRE_EQ(
+            stream.str(), "digraph tree {\n"
+                          "  n0 [label=\"root\"];\n"
+                          "  n1 [label=\"say \\\"hi\\\"\\n\"];\n"
+                          "  n0 -> n1;\n"
+                          "  n2 [label=\"back\\\\slash\"];\n"
+                          "  n1 -> n2;\n"
+                          "  n3 [label=\"last\"];\n"
+                          "  n0 -> n3;\n"
+                          "}\n"
+        );
+    }
+
+    SUBCASE("depth limit")
+    {
+        std::ostringstream stream;
+        filesystem_tree().write_dot(stream, 1);
+        const std::string output = stream.str();
+        REQUIRE_EQ(std::count(output.begin(), output.end(), '>'), 4);
+        REQUIRE(output.find("user") == std::string::npos);
+    }
+
+    SUBCASE("empty tree")
+    {
+        std::ostringstream stream;
+        general_tree<int>().write_dot(stream);
+        REQUIRE_EQ(stream.str(), "digraph tree {\n}\n");
+    }
+}
@@ -0,0 +1,113 @@
+#include "general-tree.h"
+#include "utils/fixtures/lifecycle-counter.fixture.h"
+#include "utils/helpers/seed-tree.h"
+#include <atomic>
+#include <doctest.h>
+#include <stdexcept>
+#include <string>
+
+TEST_CASE_FIXTURE(LifecycleCounterFixture, "general_tree::transform")
+{
+    const std::size_t gt_size = 3000;
+    general_tree<LifecycleCounter> gt = seed_tree(gt_size);
+    auto to_int = [](const LifecycleCounter& value) { return value.get_int(); };
+
+    SUBCASE("builds a tree with the same shape and mapped values")
+    {
+        general_tree<int> serial = gt.transform<int>(to_int);
+        REQUIRE_EQ(serial.size(), gt_size);
+
+        auto it = serial.begin();
+        bool same = true;
+        for (const LifecycleCounter& value : gt)
+            same = same && *it++ == value.get_int();
+        REQUIRE(same);
+        REQUIRE(it == serial.end());
+
+        for (std::size_t threads : {1, 2, 4, 8})
+        {
+            general_tree<int> parallel = gt.transform<int>(to_int, {threads});
+            REQUIRE_EQ(parallel.size(), gt_size);
+            REQUIRE(parallel == serial);
+        }
+    }
+
+    SUBCASE("the source is not copied")
+    {
+        auto result = gt.transform<std::string>([](const LifecycleCounter& value) { return value.get_string(); });
+        auto parallel = gt.transform<std::string>(
+            [](const LifecycleCounter& value) { return value.get_string(); }, general_tree<LifecycleCounter>::par
+        );
+        REQUIRE(result == parallel);
+        REQUIRE_EQ(LifecycleCounter::copy_constructor_calls, 0);
+    }
+
+    SUBCASE("nodes are constructed directly from the result")
+    {
+        general_tree<int> source = gt.transform<int>(to_int);
+        LifecycleCounter::reset();
+        auto result = source.transform<LifecycleCounter>([](int value) { return LifecycleCounter("string", value); });
+        REQUIRE_EQ(LifecycleCounter::copy_constructor_calls, 0);
+        REQUIRE_EQ(result.size(), gt_size);
+    }
+
+    SUBCASE("empty tree")
+    {
+        general_tree<LifecycleCounter> empty;
+        REQUIRE(empty.transform<int>(to_int).empty());
+        REQUIRE(empty.transform<int>(to_int, general_tree<LifecycleCounter>::par).empty());
+    }
+
+    SUBCASE("no node is leaked if fn throws")
+    {
+        auto throwing = [](const LifecycleCounter& value) {
+            if (value.get_int() == 2500)
+                throw std::runtime_error("failure");
+            return LifecycleCounter("string", value.get_int());
+        };
+        CHECK_THROWS_AS(gt.transform<LifecycleCounter>(throwing), std::runtime_error);
+        CHECK_THROWS_AS(gt.transform<LifecycleCounter>(throwing, {4}), std::runtime_error);
+        REQUIRE_EQ(
+            LifecycleCounter::destructor_calls,
+            LifecycleCounter::parameterized_constructor_calls + LifecycleCounter::move_constructor_calls
+        );
+    }
+}
+
+TEST_CASE_FIXTURE(LifecycleCounterFixture, "general_tree::for_each_value")
+{
+    const std::size_t gt_size = 3000;
+    general_tree<LifecycleCounter> gt = seed_tree(gt_size);
+
+    SUBCASE("mutates every value in place")
+    {
+        general_tree<int> tree = gt.transform<int>([](const LifecycleCounter& value) { return value.get_int(); });
+        tree.for_each_value([](int& value) { value *= 2; });
+        std::size_t sum = 0;
+        for (int value : tree)
+            sum += value;
+        REQUIRE_EQ(sum, gt_size * (gt_size - 1));
+    }
+
+    SUBCASE("parallel")
+    {
+        for (std::size_t threads : {1, 2, 4, 8})
+        {
+            general_tree<int> tree = gt.transform<int>([](const LifecycleCounter& value) { return value.get_int(); });
+            tree.for_each_value([](int& value) { value += 1; }, {threads});
+            std::size_t sum = 0;
+            for (int value : tree)
+                sum += value;
+            REQUIRE_EQ(sum, gt_size * (gt_size + 1) / 2);
+        }
+    }
+
+    SUBCASE("empty tree")
+    {
+        general_tree<int> empty;
+        std::atomic<int> calls = 0;
+        empty.for_each_value([&](int&) { ++calls; });
+        empty.for_each_value([&](int&) { ++calls; }, general_tree<int>::par);
+        REQUIRE_EQ(calls.load(), 0);
+    }
+}
@@ -0,0 +1,136 @@
+#include "general-tree.h"
+#include <algorithm>
+#include <doctest.h>
+#include <ranges>
+#include <stdexcept>
+#include <vector>
+
+namespace
+{
+    template <typename View>
+    std::vector<int> values_of(View view)
+    {
+        std::vector<int> values;
+        for (auto n : view)
+            values.push_back(n.data());
+        return values;
+    }
+}
+
+static_assert(std::ranges::view<general_tree<int>::children_view>);
+static_assert(std::ranges::forward_range<general_tree<int>::ancestors_view>);
+static_assert(std::ranges::forward_range<general_tree<int>::level_view>);
+
+TEST_CASE("general_tree views")
+{
+    /*
+            1
+          / | \
+         2  3  4
+        / \     \
+       5   6     7
+           |
+           8
+    */
+    general_tree<int> mytree;
+    mytree.create_root(1);
+    auto n2 = mytree.insert_left_child(mytree.root(), 2);
+    auto n3 = mytree.insert_right_sibling(n2, 3);
+    auto n4 = mytree.insert_right_sibling(n3, 4);
+    auto n5 = mytree.insert_left_child(n2, 5);
+    auto n6 = mytree.insert_right_sibling(n5, 6);
+    mytree.insert_left_child(n4, 7);
+    auto n8 = mytree.insert_left_child(n6, 8);
+
+    SUBCASE("children")
+    {
+        const std::vector<int> expected_result = {2, 3, 4};
+        REQUIRE_EQ(expected_result, values_of(general_tree<int>::children(mytree.root())));
+        REQUIRE(general_tree<int>::children(n3).empty());
+    }
+
+    SUBCASE("ancestors")
+    {
+        const std::vector<int> expected_result = {6, 2, 1};
+        REQUIRE_EQ(expected_result, values_of(general_tree<int>::ancestors(n8)));
+        REQUIRE(general_tree<int>::ancestors(mytree.root()).empty());
+    }
+
+    SUBCASE("siblings")
+    {
+        const std::vector<int> expected_middle = {2, 4};
+        const std::vector<int> expected_first = {3, 4};
+        const std::vector<int> expected_last = {2, 3};
+        REQUIRE_EQ(expected_middle, values_of(general_tree<int>::siblings(n3)));
+        REQUIRE_EQ(expected_first, values_of(general_tree<int>::siblings(n2)));
+        REQUIRE_EQ(expected_last, values_of(general_tree<int>::siblings(n4)));
+        REQUIRE(general_tree<int>::siblings(n8).empty());
+        REQUIRE(general_tree<int>::siblings(mytree.root()).empty());
+    }
+
+    SUBCASE("leaves")
+    {
+        const std::vector<int> expected_result = {5, 8, 3, 7};
+        const std::vector<int> expected_subtree = {5, 8};
+        const std::vector<int> expected_single = {3};
+        REQUIRE_EQ(expected_result, values_of(general_tree<int>::leaves(mytree.root())));
+        REQUIRE_EQ(expected_subtree, values_of(general_tree<int>::leaves(n2)));
+        REQUIRE_EQ(expected_single, values_of(general_tree<int>::leaves(n3)));
+    }
+
+    SUBCASE("nodes at depth")
+    {
+        const std::vector<int> expected_depth0 = {1};
+        const std::vector<int> expected_depth1 = {2, 3, 4};
+        const std::vector<int> expected_depth2 = {5, 6, 7};
+        const std::vector<int> expected_depth3 = {8};
+        REQUIRE_EQ(expected_depth0, values_of(general_tree<int>::nodes_at_depth(mytree.root(), 0)));
+        REQUIRE_EQ(expected_depth1, values_of(general_tree<int>::nodes_at_depth(mytree.root(), 1)));
+        REQUIRE_EQ(expected_depth2, values_of(general_tree<int>::nodes_at_depth(mytree.root(), 2)));
+        REQUIRE_EQ(expected_depth3, values_of(general_tree<int>::nodes_at_depth(mytree.root(), 3)));
+        REQUIRE(general_tree<int>::nodes_at_depth(mytree.root(), 4).empty());
+    }
+
+    SUBCASE("nodes at depth relative to a subtree")
+    {
+        const std::vector<int> expected_result = {5, 6};
+        REQUIRE_EQ(expected_result, values_of(general_tree<int>::nodes_at_depth(n2, 1)));
+    }
+
+    SUBCASE("composes with standard range adaptors")
+    {
+        auto even_leaves = general_tree<int>::leaves(mytree.root()) |
+                           std::views::transform([](auto n) { return n.data(); }) |
+                           std::views::filter([](int v) { return v % 2 == 0; });
+
+        const std::vector<int> expected_result = {8};
+        std::vector<int> result;
+        std::ranges::copy(even_leaves, std::back_inserter(result));
+        REQUIRE_EQ(expected_result, result);
+    }
+
+    SUBCASE("data can be modified through the yielded nodes")
+    {
+        for (auto child : general_tree<int>::children(mytree.root()))
+            child.data() *= 10;
+
+        const std::vector<int> expected_result = {20, 30, 40};
+        REQUIRE_EQ(expected_result, values_of(general_tree<int>::children(mytree.root())));
+    }
+
+    SUBCASE("works with the root of a const tree")
+    {
+        const general_tree<int>& const_tree = mytree;
+        REQUIRE_EQ(std::ranges::distance(general_tree<int>::children(const_tree.root())), 3);
+    }
+
+    SUBCASE("throw invalid argument if node is null")
+    {
+        general_tree<int> empty;
+        CHECK_THROWS_AS(general_tree<int>::children(empty.root()), std::invalid_argument);
+        CHECK_THROWS_AS(general_tree<int>::ancestors(empty.root()), std::invalid_argument);
+        CHECK_THROWS_AS(general_tree<int>::siblings(empty.root()), std::invalid_argument);
+        CHECK_THROWS_AS(general_tree<int>::leaves(empty.root()), std::invalid_argument);
+        CHECK_THROWS_AS(general_tree<int>::nodes_at_depth(empty.root(), 1), std::invalid_argument);
+    }
+}
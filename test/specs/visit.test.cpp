@@ -0,0 +1,161 @@
+#include "general-tree.h"
+#include <doctest.h>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+    struct recording_visitor
+    {
+        std::vector<std::string> events;
+
+        void on_enter(general_tree<int>::node n)
+        {
+            events.push_back("enter " + std::to_string(n.data()));
+        }
+
+        void on_leave(general_tree<int>::node n)
+        {
+            events.push_back("leave " + std::to_string(n.data()));
+        }
+    };
+
+    struct enter_only_visitor
+    {
+        std::vector<int> entered;
+
+        void on_enter(general_tree<int>::node n)
+        {
+            entered.push_back(n.data());
+        }
+    };
+
+    struct leave_only_visitor
+    {
+        std::vector<int> left;
+
+        void on_leave(general_tree<int>::node n)
+        {
+            left.push_back(n.data());
+        }
+    };
+
+    struct pruning_visitor
+    {
+        std::vector<int> entered;
+        std::vector<int> left;
+
+        bool on_enter(general_tree<int>::node n)
+        {
+            entered.push_back(n.data());
+            // skip the children of 2
+            return n.data() != 2;
+        }
+
+        void on_leave(general_tree<int>::node n)
+        {
+            left.push_back(n.data());
+        }
+    };
+}
+
+TEST_CASE("general_tree::visit")
+{
+    /*
+        1
+       / \
+      2   3
+     / \   \
+    4   5   6
+    */
+    general_tree<int> mytree;
+    mytree.create_root(1);
+    auto n2 = mytree.insert_left_child(mytree.root(), 2);
+    auto n3 = mytree.insert_right_sibling(n2, 3);
+    auto n4 = mytree.insert_left_child(n2, 4);
+    mytree.insert_right_sibling(n4, 5);
+    mytree.insert_left_child(n3, 6);
+
+    SUBCASE("calls on_enter and on_leave in depth-first order")
+    {
+        const std::vector<std::string> expected_result = {
+            "enter 1", "enter 2", "enter 4", "leave 4", "enter 5", "leave 5",
+            "leave 2", "enter 3", "enter 6", "leave 6", "leave 3", "leave 1",
+        };
+
+        recording_visitor visitor;
+        mytree.visit(mytree.root(), visitor);
+        REQUIRE_EQ(expected_result, visitor.events);
+    }
+
+    SUBCASE("on_enter only produces preorder")
+    {
+        const std::vector<int> expected_result = {1, 2, 4, 5, 3, 6};
+
+        enter_only_visitor visitor;
+        mytree.visit(mytree.root(), visitor);
+        REQUIRE_EQ(expected_result, visitor.entered);
+    }
+
+    SUBCASE("on_leave only produces postorder")
+    {
+        const std::vector<int> expected_result = {4, 5, 2, 6, 3, 1};
+
+        leave_only_visitor visitor;
+        mytree.visit(mytree.root(), visitor);
+        REQUIRE_EQ(expected_result, visitor.left);
+    }
+
+    SUBCASE("returning false from on_enter skips the children")
+    {
+        const std::vector<int> expected_entered = {1, 2, 3, 6};
+        const std::vector<int> expected_left = {2, 6, 3, 1};
+
+        pruning_visitor visitor;
+        mytree.visit(mytree.root(), visitor);
+        REQUIRE_EQ(expected_entered, visitor.entered);
+        REQUIRE_EQ(expected_left, visitor.left);
+    }
+
+    SUBCASE("does not visit the right siblings of the start node")
+    {
+        recording_visitor visitor;
+        mytree.visit(n2, visitor);
+        const std::vector<std::string> expected_result = {
+            "enter 2", "enter 4", "leave 4", "enter 5", "leave 5", "leave 2",
+        };
+        REQUIRE_EQ(expected_result, visitor.events);
+    }
+
+    SUBCASE("single leaf node")
+    {
+        const std::vector<std::string> expected_result = {"enter 4", "leave 4"};
+
+        recording_visitor visitor;
+        mytree.visit(n4, visitor);
+        REQUIRE_EQ(expected_result, visitor.events);
+    }
+
+    SUBCASE("works on const trees")
+    {
+        const general_tree<int>& const_tree = mytree;
+        enter_only_visitor visitor;
+        const_tree.visit(const_tree.root(), visitor);
+        REQUIRE_EQ(visitor.entered.size(), 6);
+    }
+
+    SUBCASE("visitor without callbacks is accepted")
+    {
+        struct empty_visitor
+        {
+        };
+        REQUIRE_NOTHROW(mytree.visit(mytree.root(), empty_visitor{}));
+    }
+
+    SUBCASE("throw invalid argument if node is null")
+    {
+        general_tree<int> empty;
+        CHECK_THROWS_AS(empty.visit(empty.root(), enter_only_visitor{}), std::invalid_argument);
+    }
+}
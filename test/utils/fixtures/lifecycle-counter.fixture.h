@@ -1,5 +1,6 @@
 #pragma once
 #include "general-tree.h"
+#include <atomic>
 #include <cassert>
 #include <string>
 #include <utility>
@@ -11,12 +12,12 @@ private:
     int m_int = 0;
 
 public:
-    static inline unsigned parameterized_constructor_calls;
-    static inline unsigned copy_constructor_calls;
-    static inline unsigned move_constructor_calls;
-    static inline unsigned destructor_calls;
-    static inline unsigned copy_assignment_calls;
-    static inline unsigned move_assignment_calls;
+    static inline std::atomic<unsigned> parameterized_constructor_calls;
+    static inline std::atomic<unsigned> copy_constructor_calls;
+    static inline std::atomic<unsigned> move_constructor_calls;
+    static inline std::atomic<unsigned> destructor_calls;
+    static inline std::atomic<unsigned> copy_assignment_calls;
+    static inline std::atomic<unsigned> move_assignment_calls;
 
     static void reset() noexcept
     {
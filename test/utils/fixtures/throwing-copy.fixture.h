@@ -0,0 +1,33 @@
+#pragma once
+#include <atomic>
+#include <stdexcept>
+
+// value whose copy constructor throws once copies_left is exhausted; alive counts the live instances
+struct ThrowingCopy
+{
+    static inline std::atomic<int> copies_left = 0;
+    static inline std::atomic<int> alive = 0;
+    int value;
+
+    ThrowingCopy(int v) : value(v)
+    {
+        ++alive;
+    }
+
+    ThrowingCopy(const ThrowingCopy& other) : value(other.value)
+    {
+        if (--copies_left < 0)
+            throw std::runtime_error("copy failure");
+        ++alive;
+    }
+
+    ~ThrowingCopy()
+    {
+        --alive;
+    }
+
+    bool operator==(const ThrowingCopy& other) const
+    {
+        return value == other.value;
+    }
+};
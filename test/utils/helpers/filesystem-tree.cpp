@@ -0,0 +1,15 @@
+#include "filesystem-tree.h"
+
+general_tree<std::string> filesystem_tree()
+{
+    general_tree<std::string> tree("/");
+    auto bin = tree.insert_left_child(tree.root(), "bin");
+    auto etc = tree.insert_right_sibling(bin, "etc");
+    auto home = tree.insert_right_sibling(etc, "home");
+    auto var = tree.insert_right_sibling(home, "var");
+    auto user = tree.insert_left_child(home, "user");
+    auto docs = tree.insert_left_child(user, "Documents");
+    tree.insert_right_sibling(docs, "Projects");
+    tree.insert_left_child(var, "log");
+    return tree;
+}
@@ -0,0 +1,6 @@
+#pragma once
+#include "general-tree.h"
+#include <string>
+
+// the filesystem example of the README: "/" with bin, etc, home/user/{Documents, Projects} and var/log
+general_tree<std::string> filesystem_tree();